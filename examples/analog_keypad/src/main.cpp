@@ -0,0 +1,84 @@
+/*
+ * A 4x4 keypad wired as a resistor ladder into A0: a 10k pull-up to 5V, and
+ * every key grounds one tap of a chain of 1k resistors, so the keys read from
+ * 0 (key 1) up to about 614 (key D) and the released keypad reads 1023.
+ *
+ * Hold '#' while resetting the board to calibrate: the sketch asks for every
+ * key in turn and prints the measured levels, to be pasted into LEVELS below.
+ */
+#include <Arduino.h>
+#include <rusty_keypad.h>
+#include <rusty_analog_keypad.h>
+
+const char *const MAP[4 * 4] = {
+    "1", "2", "3", "A",
+    "4", "5", "6", "B",
+    "7", "8", "9", "C",
+    "*", "0", "#", "D"};
+
+uint16_t LEVELS[4 * 4] = {
+    0, 93, 171, 236,
+    292, 341, 384, 421,
+    455, 485, 512, 536,
+    558, 578, 597, 614};
+
+void calibrate()
+{
+  Serial.println("Calibration");
+  for (RustyKeyIndex i = 0; i < 16; i++)
+  {
+    Serial.print("Hold ");
+    Serial.println(MAP[i]);
+    while (RustyAnalogKeypad::getKey(RustyAnalogKeypad::read()) == RKP_NO_KEY_INDEX)
+    {
+      delay(10);
+    }
+    delay(100);
+    while (!RustyAnalogKeypad::calibrateKey(i))
+    {
+      delay(10);
+    }
+    Serial.println("Release");
+    while (RustyAnalogKeypad::getKey(RustyAnalogKeypad::read()) != RKP_NO_KEY_INDEX)
+    {
+      delay(10);
+    }
+    delay(100);
+  }
+  RustyAnalogKeypad::calibrateIdle();
+  Serial.print("uint16_t LEVELS[4 * 4] = {");
+  for (uint8_t i = 0; i < 16; i++)
+  {
+    Serial.print(RustyAnalogKeypad::getLevels()[i]);
+    Serial.print(i < 15 ? ", " : "};\n");
+  }
+}
+
+void onKeyUp(char key)
+{
+  Serial.print("Key: ");
+  Serial.println(String(key));
+}
+
+void setup()
+{
+  Serial.begin(9600);
+
+  RustyAnalogKeypad::keyboardSetup(MAP, 4, 4);
+  if (!RustyAnalogKeypad::begin(A0, LEVELS, 1023))
+  {
+    Serial.println("The levels are too close, calibrate the keypad.");
+  }
+  if (RustyAnalogKeypad::getKey(RustyAnalogKeypad::read()) == 14)
+  {
+    calibrate();
+  }
+  RustyKeypad::addKeyUpListener(onKeyUp);
+  RustyKeypad::setType(RKP_INTEGER);
+  RustyKeypad::enable();
+}
+
+void loop()
+{
+  RustyKeypad::scan();
+}
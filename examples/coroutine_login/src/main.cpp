@@ -0,0 +1,63 @@
+/*
+ * A login flow written as a coroutine: asks for a user ID, then for a PIN, and
+ * waits for a confirmation key, without a listener or a state variable.
+ *
+ * The coroutine API needs a C++20 compiler, for example an ESP32 with
+ *
+ *     build_unflags = -std=gnu++11
+ *     build_flags = -std=gnu++2a
+ *
+ * in platformio.ini. Each co_await returns to loop(); the keypad keeps working
+ * and scan() resumes the coroutine when its key, line or time has come.
+ */
+#include <Arduino.h>
+#include <rusty_keypad.h>
+#include <rusty_coroutine.h>
+
+RustyTask login()
+{
+  Serial.println("USER ID:");
+  RustyLine id = co_await RustyAwait::readLine(10000);
+  if (!id.entered)
+  {
+    Serial.println("TIMEOUT");
+    co_return;
+  }
+
+  RustyKeypad::setPasswordMask(true);
+  Serial.println("PIN:");
+  RustyLine pin = co_await RustyAwait::readLine(10000);
+  RustyKeypad::setPasswordMask(false);
+  if (!pin.entered)
+  {
+    Serial.println("TIMEOUT");
+    co_return;
+  }
+
+  Serial.print("LOGIN AS ");
+  Serial.print(id.text);
+  Serial.println("? 1 = YES");
+  char confirm = co_await RustyAwait::nextKey(5000);
+  Serial.println(confirm == '1' ? "WELCOME" : "CANCELLED");
+
+  // Let the message stand for a while before asking again.
+  co_await RustyAwait::delay(2000);
+  login();
+}
+
+void setup()
+{
+  Serial.begin(115200);
+
+  RustyKeypad::setEnterKey('#');
+  RustyKeypad::useDeleteKey('*');
+  RustyKeypad::setType(RKP_INTEGER);
+  RustyKeypad::enable();
+
+  login();
+}
+
+void loop()
+{
+  RustyKeypad::scan();
+}
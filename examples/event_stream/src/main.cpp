@@ -0,0 +1,29 @@
+/*
+ * A remote keypad head: sends the keypad events to a host PC as binary frames
+ * instead of printing text.
+ *
+ * Nothing else may be printed on Serial, the output has to stay a clean binary
+ * stream. On the PC, decode the frames as they arrive with
+ *
+ *     python3 extras/tools/rusty_stream.py --port /dev/ttyUSB0 --baud 9600
+ */
+#include <Arduino.h>
+#include <rusty_keypad.h>
+#include <rusty_event_stream.h>
+
+void setup()
+{
+  Serial.begin(9600);
+
+  RustyKeypad::setEnterKey('#');
+  RustyKeypad::useDeleteKey('*');
+  RustyKeypad::setType(RKP_INTEGER);
+  // Collect the events for up to 50 ms, so a burst of keys costs a single frame.
+  RustyEventStream::begin(Serial, 50);
+  RustyKeypad::enable();
+}
+
+void loop()
+{
+  RustyKeypad::scan();
+}
@@ -0,0 +1,46 @@
+/*
+ * Records what the keypad does and sends the record over Serial on request.
+ *
+ * The trace has to be enabled for the library as well, so define it as a build flag,
+ * e.g. in platformio.ini:
+ *
+ *     build_flags = -DRUSTY_KEYPAD_TRACE -DRUSTY_KEYPAD_TRACE_SIZE=128
+ *
+ * Send 'd' to dump the trace and 'c' to clear it. Capture the output and decode it with
+ *
+ *     python3 extras/tools/rusty_trace.py --port /dev/ttyUSB0 --cols 3
+ */
+#include <Arduino.h>
+#include <rusty_keypad.h>
+
+void textChange(RustyText text)
+{
+  Serial.println(text);
+}
+
+void setup()
+{
+  Serial.begin(115200);
+
+  RustyKeypad::addTextChangeListener(textChange);
+  RustyKeypad::setType(RKP_INTEGER);
+  RustyKeypad::enable();
+}
+
+void loop()
+{
+  RustyKeypad::scan();
+
+  if (Serial.available() > 0)
+  {
+    char command = Serial.read();
+    if (command == 'd')
+    {
+      RustyTrace::dump(Serial);
+    }
+    else if (command == 'c')
+    {
+      RustyTrace::clear();
+    }
+  }
+}
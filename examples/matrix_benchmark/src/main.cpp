@@ -0,0 +1,68 @@
+/*
+ * Measures the time of an idle scan for several matrix sizes.
+ *
+ * Build it for a board with enough pins (Arduino Mega, ESP32) and raise the
+ * matrix size for the library, e.g. in platformio.ini:
+ *
+ *     build_flags = -DMAX_KEYPAD_MATRIX_SIZE=16
+ *
+ * An idle scan drives every row twice and reads every column once, so the time
+ * grows with the number of rows and columns and not with the number of keys:
+ * 16x4 takes longer than 8x8 although both have 64 keys, and 16x16 costs about
+ * as much as 16x8 plus eight column reads.
+ */
+#include <Arduino.h>
+#include <rusty_keypad.h>
+
+#define BENCHMARK_SCANS 1000
+
+static const uint8_t rows[16] = {22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37};
+static const uint8_t cols[16] = {38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53};
+static const char *keys[16 * 16];
+static char names[16 * 16][4];
+
+void benchmark(uint8_t row, uint8_t col)
+{
+  RustyKeypad::keyboardSetup(keys, rows, cols, row, col);
+  RustyKeypad::scan();
+
+  unsigned long start = micros();
+  for (uint16_t i = 0; i < BENCHMARK_SCANS; i++)
+  {
+    RustyKeypad::scan();
+  }
+  unsigned long elapsed = micros() - start;
+
+  Serial.print(row);
+  Serial.print("x");
+  Serial.print(col);
+  Serial.print(" (");
+  Serial.print(row * col);
+  Serial.print(" keys): ");
+  Serial.print(elapsed / BENCHMARK_SCANS);
+  Serial.println(" us per scan");
+}
+
+void setup()
+{
+  Serial.begin(9600);
+
+  for (uint16_t i = 0; i < 16 * 16; i++)
+  {
+    snprintf(names[i], sizeof(names[i]), "%u", i);
+    keys[i] = names[i];
+  }
+  RustyKeypad::setIdleTimeout(0);
+  RustyKeypad::enable();
+
+  benchmark(4, 4);
+  benchmark(4, 16);
+  benchmark(16, 4);
+  benchmark(8, 8);
+  benchmark(16, 8);
+  benchmark(16, 16);
+}
+
+void loop()
+{
+}
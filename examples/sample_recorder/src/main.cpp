@@ -0,0 +1,44 @@
+/*
+ * Records the raw key samples over Serial, so that a problem seen on the device
+ * can be replayed on a PC with extras/replay.
+ *
+ * Capture the serial output into a file, e.g.
+ *
+ *     stty -F /dev/ttyUSB0 115200 raw && cat /dev/ttyUSB0 > recording.bin
+ *
+ * and send 's' to end the recording. Nothing else may be printed on Serial while
+ * recording, the output has to stay a clean binary stream.
+ */
+#include <Arduino.h>
+#include <rusty_keypad.h>
+#include <rusty_recorder.h>
+
+const char *const keys[4 * 3] = {
+    "1", "2ABC", "3DEF",
+    "4GHI", "5JKL", "6MNO",
+    "7PQRS", "8TUV", "9WXYZ",
+    "*", "0 ", "#"};
+const uint8_t row_pins[4] = {2, 3, 4, 5};
+const uint8_t col_pins[3] = {6, 7, 8};
+
+void setup()
+{
+  Serial.begin(115200);
+
+  RustyKeypad::keyboardSetup(keys, row_pins, col_pins, 4, 3);
+  RustyRecorder::start(Serial);
+  RustyKeypad::setEnterKey('#');
+  RustyKeypad::useDeleteKey('*');
+  RustyKeypad::setType(RKP_T9);
+  RustyKeypad::enable();
+}
+
+void loop()
+{
+  RustyKeypad::scan();
+
+  if (Serial.available() > 0 && Serial.read() == 's')
+  {
+    RustyRecorder::stop();
+  }
+}
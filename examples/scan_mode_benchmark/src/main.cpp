@@ -0,0 +1,87 @@
+/*
+ * Measures the time of a scan with keys pressed, for each keypad type.
+ *
+ * setType() chooses a scan routine compiled for the type, so the loop over the
+ * keys doesn't check the type for every key. Build the sketch twice for the same
+ * board (Arduino Mega, ESP32), once as it is and once with the generic routine
+ * that checks the type for every pressed key, e.g. in platformio.ini:
+ *
+ *     build_flags = -DRUSTY_KEYPAD_GENERIC_SCAN
+ *
+ * and compare the two outputs. The key samples come from a short recording
+ * replayed in a loop, so the keys go through presses, holds and releases
+ * without anyone touching the keypad, and the pins are not read at all.
+ */
+#include <Arduino.h>
+#include <rusty_keypad.h>
+#include <rusty_replay.h>
+
+#define BENCHMARK_ROUNDS 20
+
+const char *const keys[4 * 4] = {
+    "1", "2ABC", "3DEF", "A",
+    "4GHI", "5JKL", "6MNO", "B",
+    "7PQRS", "8TUV", "9WXYZ", "C",
+    "*", "0 ", "#", "D"};
+const uint8_t row_pins[4] = {2, 3, 4, 5};
+const uint8_t col_pins[4] = {6, 7, 8, 9};
+
+/*
+ * A recording of a 4x4 keypad: the header, then entries of 60 scans, each with a
+ * new sample of a byte per row.
+ */
+const uint8_t pattern[] = {
+    'R', 'K', 'R', RUSTY_KEYPAD_RECORDING_VERSION, 4, 4, 1, 0, 0, 0, 0,
+    0x79, 0x00, 0x00, 0x00, 0x00, 0x00, // idle
+    0x79, 0x00, 0x02, 0x00, 0x00, 0x00, // '2' held
+    0x79, 0x00, 0x00, 0x00, 0x00, 0x00, // idle
+    0x79, 0x00, 0x00, 0x05, 0x00, 0x00, // '4' and '6' held
+    0x79, 0x00, 0x00, 0x00, 0x00, 0x00, // idle
+    0x79, 0x00, 0x01, 0x02, 0x04, 0x00, // '1', '5' and '9' held
+    0x79, 0x00, 0x00, 0x00, 0x00, 0x00  // idle
+};
+
+void benchmark(KeypadTypes type, const char *name)
+{
+  RustyKeypad::setType(type);
+  uint32_t scans = 0;
+  unsigned long start = micros();
+  for (uint8_t i = 0; i < BENCHMARK_ROUNDS; i++)
+  {
+    RustyReplay::begin(pattern, sizeof(pattern));
+    while (RustyReplay::next())
+    {
+      RustyKeypad::scan();
+      scans++;
+    }
+  }
+  unsigned long elapsed = micros() - start;
+
+  Serial.print(name);
+  Serial.print(": ");
+  Serial.print((float)elapsed / scans);
+  Serial.println(" us per scan");
+}
+
+void setup()
+{
+  Serial.begin(9600);
+
+  RustyKeypad::keyboardSetup(keys, row_pins, col_pins, 4, 4);
+  RustyKeypad::setIdleTimeout(0);
+  RustyKeypad::enable();
+
+#if defined(RUSTY_KEYPAD_GENERIC_SCAN)
+  Serial.println("generic scan routine");
+#else
+  Serial.println("specialized scan routines");
+#endif
+  benchmark(RKP_INTEGER, "RKP_INTEGER");
+  benchmark(RKP_FLOAT, "RKP_FLOAT");
+  benchmark(RKP_HEX, "RKP_HEX");
+  benchmark(RKP_T9, "RKP_T9");
+}
+
+void loop()
+{
+}
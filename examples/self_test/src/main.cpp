@@ -0,0 +1,44 @@
+/*
+ * Tests the key matrix in the background and prints every fault found on it:
+ * keys that stay pressed, shorted rows or columns, a column held low, and lines
+ * that never see a press while the others do.
+ *
+ * Try it by pressing and holding a key for a minute, or by joining two row
+ * pins with a wire while no key is pressed.
+ */
+#include <Arduino.h>
+#include <rusty_keypad.h>
+#include <rusty_self_test.h>
+
+const char *FAULT_NAMES[] = {"stuck key", "row short", "column short", "column active", "open row", "open column"};
+
+void onFault(uint8_t type, uint8_t a, uint8_t b)
+{
+  Serial.print("Fault: ");
+  Serial.print(FAULT_NAMES[type]);
+  Serial.print(" ");
+  Serial.print(a);
+  if (type <= RKP_FAULT_COLUMN_SHORT)
+  {
+    Serial.print(" ");
+    Serial.print(b);
+  }
+  Serial.println();
+}
+
+void setup()
+{
+  Serial.begin(9600);
+
+  RustyKeypad::setType(RKP_INTEGER);
+  RustyKeypad::addFaultListener(onFault);
+  // A key pressed for a whole minute is reported as stuck.
+  RustySelfTest::setStuckKeyTimeout(60000);
+  RustySelfTest::begin();
+  RustyKeypad::enable();
+}
+
+void loop()
+{
+  RustyKeypad::scan();
+}
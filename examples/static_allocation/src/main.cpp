@@ -0,0 +1,38 @@
+/*
+ * Builds the keypad without the heap and prints its RAM footprint.
+ *
+ * The mode has to be selected for the library as well, so define it as a build flag,
+ * e.g. in platformio.ini:
+ *
+ *     build_flags = -DRUSTY_KEYPAD_STATIC_ALLOCATION -DRUSTY_KEYPAD_RAM_BUDGET=600
+ */
+#include <Arduino.h>
+#include <rusty_keypad.h>
+
+void textChange(RustyText text)
+{
+  Serial.println(text);
+}
+
+void setup()
+{
+  Serial.begin(9600);
+
+  Serial.print("keys: ");
+  Serial.println((unsigned long)RustyKeypadFootprint::key_bytes);
+  Serial.print("text: ");
+  Serial.println((unsigned long)RustyKeypadFootprint::text_bytes);
+  Serial.print("static: ");
+  Serial.println((unsigned long)RustyKeypadFootprint::static_bytes);
+  Serial.print("heap: ");
+  Serial.println((unsigned long)RustyKeypadFootprint::heap_bytes);
+
+  RustyKeypad::addTextChangeListener(textChange);
+  RustyKeypad::setType(RKP_INTEGER);
+  RustyKeypad::enable();
+}
+
+void loop()
+{
+  RustyKeypad::scan();
+}
@@ -0,0 +1,126 @@
+/*
+ * Runs RustyAnalogKeypad on a PC against a simulated resistor ladder.
+ *
+ * Build it from the root of the repository:
+ *
+ *     g++ -std=c++11 -O2 -pthread -Iextras/replay/host -Isrc $(find src -name '*.cpp') \
+ *         extras/replay/host/Arduino.cpp extras/replay/analog_ladder.cpp -o analog_ladder
+ *
+ * The simulated 4x4 pad pulls the pin up with 10k, and each key grounds one
+ * tap of a chain of 1k resistors. The resistors are off by up to 5%, the ADC
+ * readings are noisy, and the contacts bounce between open and closed for
+ * 12 readings when they are pressed and released. The keypad starts with the
+ * levels of the nominal resistor values, every key is calibrated as a user
+ * would do it, and then every key is typed once. The program prints the
+ * listener calls and exits with 1 if a key was missed or misread.
+ */
+#include <Arduino.h>
+#include <rusty_keypad.h>
+#include <rusty_analog_keypad.h>
+#include <stdio.h>
+#include <random>
+
+static const char *const keys[4 * 4] = {
+    "1", "2", "3", "A",
+    "4", "5", "6", "B",
+    "7", "8", "9", "C",
+    "*", "0", "#", "D"};
+
+static const double PULL_UP = 10000.0;
+static const double STEP = 1000.0;
+
+static std::mt19937 noise(1);
+static double actual[16];
+static int held_key = -1;
+static int bounce_left = 0;
+static int bounce_key = -1;
+static std::string typed;
+
+static int adcLevel(const double *ladder, int key)
+{
+    if (key < 0)
+    {
+        return 1023;
+    }
+    return (int)(1023.0 * ladder[key] / (PULL_UP + ladder[key]) + 0.5);
+}
+
+static int simulatedAdc(uint8_t)
+{
+    int value = adcLevel(actual, held_key);
+    if (bounce_left > 0)
+    {
+        bounce_left--;
+        value = (noise() % 2 ? adcLevel(actual, bounce_key) : 1023);
+    }
+    value += (int)(noise() % 5) - 2;
+    return (value < 0 ? 0 : (value > 1023 ? 1023 : value));
+}
+
+static void onKeyUp(char key)
+{
+    printf("%lu up '%c'\n", millis(), key);
+    typed += key;
+}
+
+static void hold(int key, unsigned long duration)
+{
+    bounce_key = (key >= 0 ? key : held_key);
+    held_key = key;
+    bounce_left = 12;
+    for (unsigned long end = millis() + duration; millis() < end;)
+    {
+        delay(1);
+        RustyKeypad::scan();
+    }
+}
+
+int main()
+{
+    double nominal[16];
+    std::uniform_real_distribution<double> tolerance(0.95, 1.05);
+    for (int i = 0; i < 16; i++)
+    {
+        nominal[i] = STEP * i;
+        actual[i] = (i == 0 ? 0.0 : actual[i - 1] + STEP * tolerance(noise));
+    }
+    uint16_t levels[16];
+    for (int i = 0; i < 16; i++)
+    {
+        levels[i] = (uint16_t)adcLevel(nominal, i);
+    }
+    setAnalogSource(simulatedAdc);
+
+    RustyAnalogKeypad::keyboardSetup(keys, 4, 4);
+    RustyKeypad::addKeyUpListener(onKeyUp);
+    RustyKeypad::setType(RKP_INTEGER);
+    if (!RustyAnalogKeypad::begin(0, levels, 1023))
+    {
+        fprintf(stderr, "the nominal levels are too close\n");
+        return 1;
+    }
+
+    for (RustyKeyIndex i = 0; i < 16; i++)
+    {
+        held_key = i;
+        if (!RustyAnalogKeypad::calibrateKey(i))
+        {
+            fprintf(stderr, "key %s failed to calibrate\n", keys[i]);
+            return 1;
+        }
+        printf("key %-2s nominal %4u calibrated %4u\n", keys[i], levels[i], RustyAnalogKeypad::getLevels()[i]);
+    }
+    held_key = -1;
+    RustyAnalogKeypad::calibrateIdle();
+
+    RustyKeypad::enable();
+    std::string expected;
+    for (int i = 0; i < 16; i++)
+    {
+        hold(i, 80);
+        hold(-1, 120);
+        expected += keys[i][0];
+    }
+    printf("typed \"%s\", expected \"%s\"\n", typed.c_str(), expected.c_str());
+    return (typed == expected ? 0 : 1);
+}
@@ -0,0 +1,71 @@
+#include <Arduino.h>
+
+static unsigned long clock_ms = 0;
+static int (*analog_source)(uint8_t) = nullptr;
+static int (*digital_source)(uint8_t) = nullptr;
+static uint8_t pin_modes[256];
+static uint8_t pin_levels[256];
+
+void setClock(unsigned long ms)
+{
+    clock_ms = ms;
+}
+
+unsigned long millis()
+{
+    return clock_ms;
+}
+
+unsigned long micros()
+{
+    return clock_ms * 1000UL;
+}
+
+void setAnalogSource(int (*source)(uint8_t pin))
+{
+    analog_source = source;
+}
+
+void delay(unsigned long ms)
+{
+    clock_ms += ms;
+}
+
+void setDigitalSource(int (*source)(uint8_t pin))
+{
+    digital_source = source;
+}
+
+uint8_t getPinMode(uint8_t pin)
+{
+    return pin_modes[pin];
+}
+
+uint8_t getPinLevel(uint8_t pin)
+{
+    return pin_levels[pin];
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    pin_modes[pin] = mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    pin_levels[pin] = value;
+}
+
+int digitalRead(uint8_t pin)
+{
+    return (digital_source != nullptr ? digital_source(pin) : HIGH);
+}
+
+int analogRead(uint8_t pin)
+{
+    return (analog_source != nullptr ? analog_source(pin) : 1023);
+}
+
+void tone(uint8_t, unsigned int, unsigned long) {}
+
+void noTone(uint8_t) {}
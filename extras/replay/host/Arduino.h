@@ -0,0 +1,154 @@
+/*
+ * A minimal Arduino API for building RustyKeypad on a PC.
+ *
+ * It provides what the library uses and nothing more. The pins are not
+ * connected to anything, RustyReplay supplies the matrix samples, and the
+ * clock only moves when setClock() is called, so a replay runs as fast as the
+ * PC can scan. analogRead() returns what the function set with
+ * setAnalogSource() returns, which simulates the ADC. digitalRead() works the
+ * same way with setDigitalSource(), and getPinMode() and getPinLevel() return
+ * what the library last set, so the host tests can model a key matrix.
+ */
+#ifndef RUSTY_REPLAY_HOST_ARDUINO_H
+#define RUSTY_REPLAY_HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+#define HIGH 0x1
+#define LOW 0x0
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(a) (*(const uint8_t *)(a))
+#define pgm_read_word(a) (*(const uint16_t *)(a))
+#define pgm_read_dword(a) (*(const uint32_t *)(a))
+#define pgm_read_ptr(a) (*(void *const *)(a))
+#define memcpy_P memcpy
+#define strlen_P strlen
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+void setClock(unsigned long ms);
+void setAnalogSource(int (*source)(uint8_t pin));
+void setDigitalSource(int (*source)(uint8_t pin));
+uint8_t getPinMode(uint8_t pin);
+uint8_t getPinLevel(uint8_t pin);
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration = 0);
+void noTone(uint8_t pin);
+
+class String
+{
+public:
+    String() {}
+    String(const char *text) : value(text != nullptr ? text : "") {}
+    explicit String(char c) : value(1, c) {}
+    String(int number) : value(std::to_string(number)) {}
+    String(unsigned int number) : value(std::to_string(number)) {}
+    String(long number) : value(std::to_string(number)) {}
+    String(unsigned long number) : value(std::to_string(number)) {}
+    unsigned int length() const { return (unsigned int)value.size(); }
+    const char *c_str() const { return value.c_str(); }
+    bool reserve(unsigned int size)
+    {
+        value.reserve(size);
+        return true;
+    }
+    void remove(unsigned int index)
+    {
+        if (index < value.size())
+            value.erase(index);
+    }
+    void remove(unsigned int index, unsigned int count)
+    {
+        if (index < value.size())
+            value.erase(index, count);
+    }
+    bool concat(const char *text, unsigned int count)
+    {
+        value.append(text, count);
+        return true;
+    }
+    bool concat(const char *text)
+    {
+        value.append(text);
+        return true;
+    }
+    bool concat(char c)
+    {
+        value.push_back(c);
+        return true;
+    }
+    bool concat(const String &text)
+    {
+        value.append(text.value);
+        return true;
+    }
+    String &operator+=(const String &text)
+    {
+        value += text.value;
+        return *this;
+    }
+    String &operator+=(const char *text)
+    {
+        value += text;
+        return *this;
+    }
+    String &operator+=(char c)
+    {
+        value += c;
+        return *this;
+    }
+    char charAt(unsigned int index) const { return index < value.size() ? value[index] : '\0'; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    bool operator==(const String &text) const { return value == text.value; }
+    bool operator==(const char *text) const { return value == text; }
+    bool operator!=(const String &text) const { return value != text.value; }
+    long toInt() const { return atol(value.c_str()); }
+    float toFloat() const { return (float)atof(value.c_str()); }
+
+private:
+    std::string value;
+};
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t b) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size)
+    {
+        for (size_t i = 0; i < size; i++)
+            write(buffer[i]);
+        return size;
+    }
+    size_t print(const char *text) { return write((const uint8_t *)text, strlen(text)); }
+    size_t print(const String &text) { return print(text.c_str()); }
+    size_t println(const char *text) { return print(text) + print("\n"); }
+    size_t println(const String &text) { return println(text.c_str()); }
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual void flush() {}
+};
+
+#endif
@@ -0,0 +1,121 @@
+/*
+ * Replays a recording of RustyRecorder on a PC and prints every listener call.
+ *
+ * Build it from the root of the repository:
+ *
+ *     g++ -std=c++11 -O2 -pthread -Iextras/replay/host -Isrc $(find src -name '*.cpp') \
+ *         extras/replay/host/Arduino.cpp extras/replay/replay_main.cpp -o rusty_replay
+ *
+ * and run it with the recording:
+ *
+ *     ./rusty_replay recording.bin
+ *
+ * setupKeypad() has to set the keypad up exactly like the sketch that made the
+ * recording: the same layout, type, special keys and durations. The build flags
+ * of the firmware, such as MAX_KEYPAD_MATRIX_SIZE, have to be passed to g++ as
+ * well. Then the keys go through the same states as on the device, and the
+ * output can be compared line by line between two versions of the library.
+ */
+#include <Arduino.h>
+#include <rusty_keypad.h>
+#include <rusty_replay.h>
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+
+static const char *const keys[4 * 3] = {
+    "1", "2ABC", "3DEF",
+    "4GHI", "5JKL", "6MNO",
+    "7PQRS", "8TUV", "9WXYZ",
+    "*", "0 ", "#"};
+static const uint8_t row_pins[4] = {2, 3, 4, 5};
+static const uint8_t col_pins[3] = {6, 7, 8};
+
+static void onTextChange(RustyText text)
+{
+    printf("%lu text \"%s\"\n", millis(), rustyTextChars(text));
+}
+
+static void onKeyDown(char key)
+{
+    printf("%lu down '%c'\n", millis(), key);
+}
+
+static void onKeyUp(char key)
+{
+    printf("%lu up '%c'\n", millis(), key);
+}
+
+static void onLongPress(char key)
+{
+    printf("%lu long '%c'\n", millis(), key);
+}
+
+static void onEnter(RustyText text)
+{
+    printf("%lu enter \"%s\"\n", millis(), rustyTextChars(text));
+}
+
+static void onDelete(char key)
+{
+    printf("%lu delete '%c'\n", millis(), key);
+}
+
+static void setupKeypad()
+{
+    RustyKeypad::keyboardSetup(keys, row_pins, col_pins, 4, 3);
+    RustyKeypad::addTextChangeListener(onTextChange);
+    RustyKeypad::addKeyDownListener(onKeyDown);
+    RustyKeypad::addKeyUpListener(onKeyUp);
+    RustyKeypad::addLongPressListener(onLongPress);
+    RustyKeypad::addEnterActionListener(onEnter);
+    RustyKeypad::addDeleteActionListener(onDelete);
+    RustyKeypad::setEnterKey('#');
+    RustyKeypad::useDeleteKey('*');
+    RustyKeypad::setType(RKP_T9);
+    RustyKeypad::enable();
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "usage: %s recording.bin\n", argv[0]);
+        return 2;
+    }
+    FILE *file = fopen(argv[1], "rb");
+    if (file == nullptr)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+    std::vector<uint8_t> recording;
+    uint8_t buffer[4096];
+    size_t size;
+    while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        recording.insert(recording.end(), buffer, buffer + size);
+    }
+    fclose(file);
+
+    if (!RustyReplay::begin(recording.data(), recording.size()))
+    {
+        fprintf(stderr, "%s: not a RustyRecorder recording\n", argv[1]);
+        return 1;
+    }
+    unsigned long start = RustyReplay::getTime();
+    setClock(start);
+    setupKeypad();
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    while (RustyReplay::next())
+    {
+        setClock(RustyReplay::getTime());
+        RustyKeypad::scan();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    double recorded = (millis() - start) / 1000.0;
+    fprintf(stderr, "%lu scans, %.1f s recorded, replayed in %.3f s (%.0fx)\n",
+            (unsigned long)RustyReplay::getScanCount(), recorded, elapsed, (elapsed > 0 ? recorded / elapsed : 0));
+    return 0;
+}
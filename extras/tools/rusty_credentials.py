@@ -0,0 +1,144 @@
+#!/usr/bin/env python3
+"""
+Credential table generator for RustyKeypad.
+
+Reads "id:pin" lines and writes a C++ header with a RustyCredentialTable
+that lives in flash. Only the salted hashes end up in the firmware.
+
+Usage:
+    python3 rusty_credentials.py --name door_credentials --salt 0x5EED1234 pins.txt > door_credentials.h
+
+Lines that are empty or start with '#' are ignored. The id must fit in
+16 bits and must not be 65535 (RKP_CREDENTIAL_NONE).
+
+Every PIN is placed within --probes slots of its first slot, the number of
+slots the keypad reads per lookup (RUSTY_KEYPAD_CREDENTIAL_PROBES); the
+table grows until it does.
+"""
+
+import argparse
+import secrets
+import sys
+
+FNV_OFFSET = 2166136261
+FNV_PRIME = 16777619
+MASK32 = 0xFFFFFFFF
+CREDENTIAL_NONE = 0xFFFF
+PROBES = 4
+
+
+def step(state, byte):
+    return ((state ^ byte) * FNV_PRIME) & MASK32
+
+
+def seed(salt):
+    state = FNV_OFFSET
+    for i in range(4):
+        state = step(state, (salt >> (8 * i)) & 0xFF)
+    return state
+
+
+def finish(state):
+    state ^= state >> 16
+    state = (state * 0x85EBCA6B) & MASK32
+    state ^= state >> 13
+    state = (state * 0xC2B2AE35) & MASK32
+    state ^= state >> 16
+    return state or 1
+
+
+def credential_hash(salt, pin):
+    state = seed(salt)
+    for byte in pin.encode("utf-8"):
+        state = step(state, byte)
+    return finish(state)
+
+
+def read_credentials(stream):
+    credentials = []
+    for number, line in enumerate(stream, 1):
+        line = line.strip()
+        if not line or line.startswith("#"):
+            continue
+        ident, sep, pin = line.partition(":")
+        if not sep or not pin:
+            sys.exit("line %d: expected 'id:pin'" % number)
+        ident = int(ident, 0)
+        if not 0 <= ident < CREDENTIAL_NONE:
+            sys.exit("line %d: id out of range" % number)
+        credentials.append((ident, pin))
+    return credentials
+
+
+def fill_table(salt, credentials, slot_count, probes):
+    """Returns the slots, or None if a PIN lands more than `probes` slots from its first slot."""
+    hashes = [0] * slot_count
+    ids = [CREDENTIAL_NONE] * slot_count
+    for ident, pin in credentials:
+        value = credential_hash(salt, pin)
+        slot = value & (slot_count - 1)
+        for _ in range(probes):
+            if hashes[slot] == 0:
+                break
+            if hashes[slot] == value:
+                sys.exit("id %d: PIN hash collides with id %d, use another salt" % (ident, ids[slot]))
+            slot = (slot + 1) & (slot_count - 1)
+        else:
+            return None
+        hashes[slot] = value
+        ids[slot] = ident
+    return hashes, ids
+
+
+def build_table(salt, credentials, probes=PROBES):
+    slot_count = 2
+    while slot_count < 2 * len(credentials):
+        slot_count *= 2
+    while True:
+        table = fill_table(salt, credentials, slot_count, probes)
+        if table is not None:
+            return table
+        if slot_count >= 0x8000:
+            sys.exit("no table of up to 32768 slots keeps every PIN within %d probes, use another salt" % probes)
+        slot_count *= 2
+
+
+def format_array(values, width):
+    lines = []
+    for i in range(0, len(values), 8):
+        lines.append("    " + ", ".join("0x%0*X" % (width, v) for v in values[i:i + 8]) + ",")
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", nargs="?", type=argparse.FileType("r"), default=sys.stdin)
+    parser.add_argument("--name", default="credentials", help="name of the generated table")
+    parser.add_argument("--salt", type=lambda v: int(v, 0), default=None, help="32-bit salt, random if omitted")
+    parser.add_argument("--probes", type=int, default=PROBES,
+                        help="slots read per lookup, at most RUSTY_KEYPAD_CREDENTIAL_PROBES (default %d)" % PROBES)
+    args = parser.parse_args()
+    if args.probes < 1:
+        parser.error("--probes must be at least 1")
+
+    salt = args.salt if args.salt is not None else secrets.randbits(32)
+    hashes, ids = build_table(salt, read_credentials(args.input), args.probes)
+
+    print("// Generated by extras/tools/rusty_credentials.py, do not edit.")
+    print("#pragma once")
+    print("#include <rusty_keypad.h>")
+    print()
+    print("static const uint32_t %s_hashes[%d] PROGMEM = {" % (args.name, len(hashes)))
+    print(format_array(hashes, 8))
+    print("};")
+    print()
+    print("static const uint16_t %s_ids[%d] PROGMEM = {" % (args.name, len(ids)))
+    print(format_array(ids, 4))
+    print("};")
+    print()
+    print("static const RustyCredentialTable %s = {0x%08XUL, %d, %s_hashes, %s_ids};"
+          % (args.name, salt, len(hashes), args.name, args.name))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""
+Event stream decoder for RustyKeypad.
+
+Reads the frames written by RustyEventStream and prints one line per event,
+with the time in milliseconds since the first frame.
+
+Usage:
+    python3 rusty_stream.py capture.bin
+    python3 rusty_stream.py --port /dev/ttyUSB0 --baud 9600
+
+Bytes between frames are skipped, and frames with a bad CRC are reported and
+dropped. A jump in the sequence numbers is reported as lost frames. --port
+needs pyserial and decodes the frames as they arrive until interrupted.
+"""
+
+import argparse
+import struct
+import sys
+
+SYNC = 0x7E
+HEADER = struct.Struct("<BBH")
+
+NOTIFICATIONS = [
+    "TEXT_CHANGE", "KEY_DOWN", "KEY_UP", "LONG_PRESS", "MULTIPLE_KEYS",
+    "ENTER", "DELETE", "CURSOR_MOVE", "CREDENTIAL", "IDLE", "FAULT",
+]
+
+TEXT_CHANGES = ["insert", "delete", "clear", "conceal", "preview"]
+
+FAULTS = ["stuck key", "row short", "column short", "column active", "open row", "open column"]
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def char(value):
+    return "'%c'" % value if 32 <= value < 127 else "0x%02x" % value
+
+
+def describe(kind, data):
+    name = NOTIFICATIONS[kind] if kind < len(NOTIFICATIONS) else "#%d" % kind
+    if name == "TEXT_CHANGE" and len(data) == 3:
+        changes = ",".join(n for i, n in enumerate(TEXT_CHANGES) if data[0] & (1 << i)) or "-"
+        return "%-13s %s length %d last %s" % (name, changes, data[1], char(data[2]))
+    if name == "MULTIPLE_KEYS" and len(data) == 3:
+        return "%-13s %d keys %s" % (name, data[0], " ".join(char(c) for c in data[1:1 + min(data[0], 2)]))
+    if name == "ENTER" and len(data) == 1:
+        return "%-13s length %d" % (name, data[0])
+    if name == "CREDENTIAL" and len(data) == 2:
+        return "%-13s %d" % (name, data[0] | data[1] << 8)
+    if name == "FAULT" and len(data) == 3:
+        fault = FAULTS[data[0]] if data[0] < len(FAULTS) else "#%d" % data[0]
+        return "%-13s %s %d %d" % (name, fault, data[1], data[2])
+    if name in ("CURSOR_MOVE", "IDLE") and len(data) == 1:
+        return "%-13s %d" % (name, data[0])
+    if len(data) == 1:
+        return "%-13s %s" % (name, char(data[0]))
+    return "%-13s %s" % (name, data.hex())
+
+
+class Decoder:
+    """Finds the frames in a byte stream and yields their lines."""
+
+    def __init__(self):
+        self.buffer = bytearray()
+        self.sequence = None
+        self.last_time = 0
+        self.time = 0
+
+    def feed(self, data):
+        self.buffer += data
+        while True:
+            start = self.buffer.find(SYNC)
+            if start < 0:
+                self.buffer.clear()
+                return
+            del self.buffer[:start]
+            if len(self.buffer) < 1 + HEADER.size:
+                return
+            length, sequence, time = HEADER.unpack_from(self.buffer, 1)
+            size = 1 + HEADER.size + length + 2
+            if len(self.buffer) < size:
+                return
+            body = bytes(self.buffer[1:size - 2])
+            crc = self.buffer[size - 2] | self.buffer[size - 1] << 8
+            if crc16(body) != crc:
+                yield "# bad CRC, skipping a byte"
+                del self.buffer[:1]
+                continue
+            del self.buffer[:size]
+            yield from self.frame(sequence, time, body[HEADER.size:])
+
+    def frame(self, sequence, time, records):
+        if self.sequence is None:
+            self.last_time = time
+        elif sequence != (self.sequence + 1) & 0xFF:
+            yield "# %d frames lost" % ((sequence - self.sequence - 1) & 0xFF)
+        self.sequence = sequence
+        self.time += (time - self.last_time) & 0xFFFF
+        self.last_time = time
+        offset = 0
+        while offset < len(records):
+            kind = records[offset] & 0x0F
+            size = records[offset] >> 4
+            data = records[offset + 1:offset + 1 + size]
+            offset += 1 + size
+            yield "%10d  #%-3d %s" % (self.time, sequence, describe(kind, data))
+
+
+def read_port(port, baud, decoder):
+    import serial
+
+    with serial.Serial(port, baud, timeout=1) as link:
+        while True:
+            for line in decoder.feed(link.read(256)):
+                print(line, flush=True)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", nargs="?", type=argparse.FileType("rb"), default=sys.stdin.buffer)
+    parser.add_argument("--port", help="serial port to read the frames from")
+    parser.add_argument("--baud", type=int, default=115200, help="baud rate of --port")
+    args = parser.parse_args()
+
+    decoder = Decoder()
+    if args.port:
+        try:
+            read_port(args.port, args.baud, decoder)
+        except KeyboardInterrupt:
+            pass
+        return
+    for line in decoder.feed(args.input.read()):
+        print(line)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+"""
+Trace decoder for RustyKeypad.
+
+Reads the binary dump written by RustyTrace::dump() and prints one line per
+record, with the time in milliseconds since the start of the device.
+
+Usage:
+    python3 rusty_trace.py --cols 4 trace.bin
+    python3 rusty_trace.py --port /dev/ttyUSB0 --cols 4
+
+Anything before the "RKT" header is skipped, so a capture of the serial
+console that also holds text output can be decoded as it is. With --cols the
+key indexes are shown as row and column of the matrix. --port needs pyserial
+and reads a single dump from the port.
+"""
+
+import argparse
+import struct
+import sys
+
+MAGIC = b"RKT"
+VERSION = 1
+HEADER = struct.Struct("<3sBHHII")
+RECORD = struct.Struct("<HBB")
+
+KINDS = ["gap", "event", "edge", "filtered", "listener"]
+
+EVENTS = [
+    "IDLE", "KEY_DOWN", "KEY_UP", "LONG_PRESS", "WAIT", "PRESS_DELETE",
+    "RELEASE_DELETE", "CLEAR_SCREEN", "PRESS_ENTER", "RELEASE_ENTER", "T9_NEXT_CHAR",
+]
+
+NOTIFICATIONS = [
+    "TEXT_CHANGE", "KEY_DOWN", "KEY_UP", "LONG_PRESS", "MULTIPLE_KEYS",
+    "ENTER", "DELETE", "CURSOR_MOVE", "CREDENTIAL", "IDLE", "FAULT",
+]
+
+KEY_NOTIFICATIONS = {"KEY_DOWN", "KEY_UP", "LONG_PRESS", "DELETE"}
+
+
+def name(names, index):
+    return names[index] if index < len(names) else "#%d" % index
+
+
+def parse(data):
+    start = data.find(MAGIC)
+    if start < 0:
+        sys.exit("no trace header found")
+    if len(data) - start < HEADER.size:
+        sys.exit("truncated trace header")
+    _, version, count, capacity, lost, last_ts = HEADER.unpack_from(data, start)
+    if version != VERSION:
+        sys.exit("unsupported trace version %d" % version)
+    offset = start + HEADER.size
+    if len(data) - offset < count * RECORD.size:
+        sys.exit("truncated trace, expected %d records" % count)
+    records = [RECORD.unpack_from(data, offset + i * RECORD.size) for i in range(count)]
+    return capacity, lost, last_ts, records
+
+
+def timestamps(last_ts, records):
+    """Walks back from the newest record, whose time is stored in the header."""
+    times = [0] * len(records)
+    now = last_ts
+    for i in range(len(records) - 1, -1, -1):
+        delta, kind_code, _ = records[i]
+        times[i] = now & 0xFFFFFFFF
+        now -= (delta << 16) if kind_code >> 4 == 0 else delta
+    return times
+
+
+def describe(record, cols):
+    _, kind_code, key = record
+    kind = kind_code >> 4
+    code = kind_code & 0x0F
+    if kind == 1:
+        detail = name(EVENTS, code)
+    elif kind in (2, 3):
+        detail = "pressed" if code else "released"
+    elif kind == 4:
+        notification = name(NOTIFICATIONS, code)
+        if notification in KEY_NOTIFICATIONS and 32 <= key < 127:
+            return "%-9s %s '%c'" % (name(KINDS, kind), notification, key)
+        return "%-9s %s %d" % (name(KINDS, kind), notification, key)
+    else:
+        detail = "kind %d code %d" % (kind, code)
+    where = "key %d" % key
+    if cols:
+        where = "key %d (%d,%d)" % (key, key // cols, key % cols)
+    return "%-9s %-15s %s" % (name(KINDS, kind), where, detail)
+
+
+def read_port(port, baud):
+    import serial
+
+    with serial.Serial(port, baud, timeout=2) as link:
+        data = b""
+        while True:
+            chunk = link.read(4096)
+            if not chunk:
+                return data
+            data += chunk
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", nargs="?", type=argparse.FileType("rb"), default=sys.stdin.buffer)
+    parser.add_argument("--cols", type=int, default=0, help="number of columns of the matrix")
+    parser.add_argument("--port", help="serial port to read the dump from")
+    parser.add_argument("--baud", type=int, default=115200, help="baud rate of --port")
+    args = parser.parse_args()
+
+    data = read_port(args.port, args.baud) if args.port else args.input.read()
+    capacity, lost, last_ts, records = parse(data)
+    print("# %d of %d records, %d overwritten" % (len(records), capacity, lost))
+    times = timestamps(last_ts, records)
+    for time, record in zip(times, records):
+        if record[1] >> 4 == 0:
+            continue
+        print("%10d  %s" % (time, describe(record, args.cols)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,6 @@
+# PlatformIO extra script of the native_tsan environment (platformio.example):
+# build_flags only reach the compiler, the ThreadSanitizer runtime has to be
+# linked as well.
+Import("env")
+
+env.Append(LINKFLAGS=["-fsanitize=thread"])
@@ -1,51 +1,116 @@
 #include <base_keypad.h>
+#include <limits.h>
 /*INITIAL VALUES*/
 
+static const long powersOfTen[] = {1L, 10L, 100L, 1000L, 10000L, 100000L, 1000000L, 10000000L, 100000000L, 1000000000L};
+
 uint8_t BaseRustyKeypad::pins_mode{INPUT_PULLUP};
 uint8_t BaseRustyKeypad::row_size{4};
 uint8_t BaseRustyKeypad::col_size{3};
 uint8_t BaseRustyKeypad::max_text_length{20};
-uint8_t BaseRustyKeypad::buzzer_pin{0};
-uint8_t BaseRustyKeypad::buzzer_beep_count{0};
-unsigned int BaseRustyKeypad::keypad_data_cursor{0};
 char BaseRustyKeypad::float_char{'*'};
 char BaseRustyKeypad::delete_key{'*'};
 char BaseRustyKeypad::enter_key{'#'};
+char BaseRustyKeypad::cursor_left_key{'A'};
+char BaseRustyKeypad::cursor_right_key{'B'};
 KeypadTypes BaseRustyKeypad::keypad_type{KeypadTypes::RKP_INTEGER};
 bool BaseRustyKeypad::enabled{false};
 bool BaseRustyKeypad::interrupted{false};
+bool BaseRustyKeypad::wakeup_armed{false};
+bool BaseRustyKeypad::idle_state{false};
 bool BaseRustyKeypad::has_delete_key{true};
 bool BaseRustyKeypad::has_enter_key{false};
+bool BaseRustyKeypad::has_cursor_keys{false};
+bool BaseRustyKeypad::credential_state_valid{false};
+bool BaseRustyKeypad::number_has_separator{false};
+bool BaseRustyKeypad::number_overflow{false};
+bool BaseRustyKeypad::number_truncated{false};
+uint8_t BaseRustyKeypad::number_decimals{0};
+long BaseRustyKeypad::number_value{0};
+uint32_t BaseRustyKeypad::credential_state{0};
+const RustyCredentialTable *BaseRustyKeypad::credential_table{nullptr};
+const RustyInputMask *BaseRustyKeypad::input_mask{nullptr};
+uint16_t BaseRustyKeypad::mask_field_values[RUSTY_KEYPAD_MAX_MASK_FIELDS]{};
 bool BaseRustyKeypad::use_stored_text{true};
 bool BaseRustyKeypad::use_password_mask{false};
-bool BaseRustyKeypad::use_buzzer{false};
-bool BaseRustyKeypad::buzzer_state{false};
-const char *BaseRustyKeypad::keypadFactoryMap[MAX_KEYPAD_MATRIX_SIZE][MAX_KEYPAD_MATRIX_SIZE] = {
-    {"1.,?!'\"-()@/:_", "2ABCabc", "3DEFdef"},
-    {"4GHIghiİ", "5JKLjkl", "6MNOmnoÖö"},
-    {"7PQRSpqrsŞş", "8TUVtuvÜü", "9WXYZwxyz"},
-    {"*", "0 +", "#"},
+char BaseRustyKeypad::keypad_mask[RUSTY_KEYPAD_MAX_TEXT_LENGTH + 1]{""};
+uint8_t BaseRustyKeypad::mask_reveal_index{RUSTY_KEYPAD_MAX_TEXT_LENGTH};
+static const char factory_key_1[] PROGMEM = "1.,?!'\"-()@/:_";
+static const char factory_key_2[] PROGMEM = "2ABCabc";
+static const char factory_key_3[] PROGMEM = "3DEFdef";
+static const char factory_key_4[] PROGMEM = "4GHIghiİ";
+static const char factory_key_5[] PROGMEM = "5JKLjkl";
+static const char factory_key_6[] PROGMEM = "6MNOmnoÖö";
+static const char factory_key_7[] PROGMEM = "7PQRSpqrsŞş";
+static const char factory_key_8[] PROGMEM = "8TUVtuvÜü";
+static const char factory_key_9[] PROGMEM = "9WXYZwxyz";
+static const char factory_key_star[] PROGMEM = "*";
+static const char factory_key_0[] PROGMEM = "0 +";
+static const char factory_key_hash[] PROGMEM = "#";
+
+const char *const BaseRustyKeypad::keypadFactoryMap[MAX_KEYPAD_MATRIX_SIZE][MAX_KEYPAD_MATRIX_SIZE] PROGMEM = {
+    {factory_key_1, factory_key_2, factory_key_3},
+    {factory_key_4, factory_key_5, factory_key_6},
+    {factory_key_7, factory_key_8, factory_key_9},
+    {factory_key_star, factory_key_0, factory_key_hash},
 };
 RustyKey *BaseRustyKeypad::waitKey{nullptr};
 
-String BaseRustyKeypad::keypad_data{""};
+RustyTextBuffer BaseRustyKeypad::keypad_data;
 unsigned long BaseRustyKeypad::keydown_timeout{1500};
 unsigned long BaseRustyKeypad::long_press_duration{5000};
 unsigned long BaseRustyKeypad::idle_timeout{30000};
 unsigned long BaseRustyKeypad::last_activity_ts{0};
+unsigned long BaseRustyKeypad::idle_scan_interval{RUSTY_KEYPAD_IDLE_SCAN_MIN_MILLIS};
+unsigned long BaseRustyKeypad::idle_scan_ts{0};
+unsigned long BaseRustyKeypad::idle_step_ts{0};
 unsigned long BaseRustyKeypad::t9_duration{600};
-unsigned long BaseRustyKeypad::last_buzzer_activate_ts{0};
 unsigned long BaseRustyKeypad::buzzer_beep_duration{50};
+unsigned long BaseRustyKeypad::mask_reveal_duration{0};
+unsigned long BaseRustyKeypad::mask_reveal_ts{0};
 RustyKeyList *BaseRustyKeypad::KeyList{nullptr};
+RustyDeadlineQueue BaseRustyKeypad::deadlines;
+RustyKeyNode *BaseRustyKeypad::row_heads[MAX_KEYPAD_MATRIX_SIZE]{};
+RustyRowBits BaseRustyKeypad::key_bits[MAX_KEYPAD_MATRIX_SIZE]{};
+RustyRowBits BaseRustyKeypad::busy_rows{0};
+RustyRowBits BaseRustyKeypad::pressed_bits[MAX_KEYPAD_MATRIX_SIZE]{};
+#if RUSTY_KEYPAD_CODE_TABLE
+RustyKeyIndex BaseRustyKeypad::code_table[256]{};
+#endif
+#if defined(RUSTY_KEYPAD_STATIC_ALLOCATION)
+static RustyKeyList static_key_list;
+uint8_t BaseRustyKeypad::row_out_pins[MAX_KEYPAD_MATRIX_SIZE]{};
+uint8_t BaseRustyKeypad::col_in_pins[MAX_KEYPAD_MATRIX_SIZE]{};
+char BaseRustyKeypad::keypad_text[RUSTY_KEYPAD_MAX_TEXT_LENGTH + 1]{""};
+char BaseRustyKeypad::preview_text[RUSTY_KEYPAD_MAX_TEXT_LENGTH + 2]{""};
+#else
 uint8_t *BaseRustyKeypad::row_out_pins{nullptr};
+uint8_t *BaseRustyKeypad::col_in_pins{nullptr};
+#endif
 void (*BaseRustyKeypad::keyDownListener)(char){0};
 
 void (*BaseRustyKeypad::keyUpListener)(char){0};
 void (*BaseRustyKeypad::longPressListener)(char){0};
-void (*BaseRustyKeypad::onEnterListener)(String){0};
+void (*BaseRustyKeypad::onEnterListener)(RustyText){0};
 void (*BaseRustyKeypad::onDeleteListener)(char){0};
-void (*BaseRustyKeypad::multipleKeyListener)(String){0};
-void (*BaseRustyKeypad::textChangeListener)(String){0};
+void (*BaseRustyKeypad::cursorMoveListener)(uint8_t){0};
+void (*BaseRustyKeypad::credentialListener)(uint16_t){0};
+void (*BaseRustyKeypad::idleListener)(bool){0};
+void (*BaseRustyKeypad::faultListener)(uint8_t, uint8_t, uint8_t){0};
+bool (*BaseRustyKeypad::notificationSink)(const RustyKeypadNotification &){0};
+void (*BaseRustyKeypad::notificationObserver)(uint8_t, char, uint16_t, const char *){0};
+void (*BaseRustyKeypad::notificationStream)(uint8_t, char, uint16_t, const char *){0};
+void (*BaseRustyKeypad::streamUpdate)(){0};
+void (*BaseRustyKeypad::selfTestStep)(){0};
+void (*BaseRustyKeypad::scanObserver)(){0};
+void (*BaseRustyKeypad::sampleSource)(RustyRowBits *, uint8_t){0};
+void (*BaseRustyKeypad::sampleObserver)(const RustyRowBits *, uint8_t){0};
+void (*BaseRustyKeypad::multipleKeyListener)(RustyText){0};
+void (*BaseRustyKeypad::textChangeListener)(RustyText){0};
+void (*BaseRustyKeypad::textChangesListener)(RustyText, uint8_t){0};
+uint8_t BaseRustyKeypad::text_changes{0};
+char BaseRustyKeypad::text_preview_key{'\0'};
+bool BaseRustyKeypad::text_deferred{false};
 
 void BaseRustyKeypad::keyboardSetup(const char *map[MAX_KEYPAD_MATRIX_SIZE][MAX_KEYPAD_MATRIX_SIZE],
                                     const uint8_t row_pins[MAX_KEYPAD_MATRIX_SIZE],
@@ -54,30 +119,139 @@ void BaseRustyKeypad::keyboardSetup(const char *map[MAX_KEYPAD_MATRIX_SIZE][MAX_
                                     uint8_t col,
                                     uint8_t mode)
 {
+    setupMatrix(&map[0][0], MAX_KEYPAD_MATRIX_SIZE, row_pins, col_pins, row, col, mode, false);
+}
+
+void BaseRustyKeypad::keyboardSetup_P(const char *const map[MAX_KEYPAD_MATRIX_SIZE][MAX_KEYPAD_MATRIX_SIZE],
+                                      const uint8_t row_pins[MAX_KEYPAD_MATRIX_SIZE],
+                                      const uint8_t col_pins[MAX_KEYPAD_MATRIX_SIZE],
+                                      uint8_t row,
+                                      uint8_t col,
+                                      uint8_t mode)
+{
+    setupMatrix(&map[0][0], MAX_KEYPAD_MATRIX_SIZE, row_pins, col_pins, row, col, mode, true);
+}
+
+void BaseRustyKeypad::keyboardSetup(const char *const *map,
+                                    const uint8_t *row_pins,
+                                    const uint8_t *col_pins,
+                                    uint8_t row,
+                                    uint8_t col,
+                                    uint8_t mode)
+{
+    setupMatrix(map, col, row_pins, col_pins, row, col, mode, false);
+}
+
+void BaseRustyKeypad::keyboardSetup_P(const char *const *map,
+                                      const uint8_t *row_pins,
+                                      const uint8_t *col_pins,
+                                      uint8_t row,
+                                      uint8_t col,
+                                      uint8_t mode)
+{
+    setupMatrix(map, col, row_pins, col_pins, row, col, mode, true);
+}
+
+void BaseRustyKeypad::setupMatrix(const char *const *map,
+                                  uint8_t stride,
+                                  const uint8_t *row_pins,
+                                  const uint8_t *col_pins,
+                                  uint8_t row,
+                                  uint8_t col,
+                                  uint8_t mode,
+                                  bool in_flash)
+{
+    if (row > MAX_KEYPAD_MATRIX_SIZE)
+    {
+        row = MAX_KEYPAD_MATRIX_SIZE;
+    }
+    if (col > MAX_KEYPAD_MATRIX_SIZE)
+    {
+        col = MAX_KEYPAD_MATRIX_SIZE;
+    }
 
     last_activity_ts = millis();
     if (KeyList != nullptr)
     {
+        setRowsPassive();
         KeyList->clear();
     }
     else
     {
+#if defined(RUSTY_KEYPAD_STATIC_ALLOCATION)
+        KeyList = &static_key_list;
+#else
         KeyList = new RustyKeyList();
+#endif
     }
 
-    resizeRowPins(row);
+#if !defined(RUSTY_KEYPAD_STATIC_ALLOCATION)
+    resizePins(row, col);
+#endif
+    for (uint8_t j = 0; j < col; ++j)
+    {
+        col_in_pins[j] = col_pins[j];
+    }
+    busy_rows = 0;
+#if RUSTY_KEYPAD_CODE_TABLE
+    memset(code_table, 0xFF, sizeof(code_table));
+#endif
     for (uint8_t i = 0; i < row; ++i)
     {
         row_out_pins[i] = row_pins[i];
+        key_bits[i] = 0;
+        pressed_bits[i] = 0;
+        row_heads[i] = nullptr;
         for (uint8_t j = 0; j < col; ++j)
         {
-            KeyList->append(map[i][j], row_pins[i], col_pins[j]);
+            const char *const *entry = &map[i * stride + j];
+            const char *key = (in_flash ? (const char *)pgm_read_ptr(entry) : *entry);
+            RustyKeyIndex index = (RustyKeyIndex)(i * col + j);
+            RustyKeyNode *node = KeyList->append(key, in_flash, index);
+            if (row_heads[i] == nullptr)
+            {
+                row_heads[i] = node;
+            }
+#if RUSTY_KEYPAD_CODE_TABLE
+            if (node != nullptr && code_table[(uint8_t)node->data->getFirstKeyCode()] == RKP_NO_KEY_INDEX)
+            {
+                code_table[(uint8_t)node->data->getFirstKeyCode()] = index;
+            }
+#endif
         }
     }
     row_size = row;
     col_size = col;
     pins_mode = mode;
+    for (uint8_t i = 0; i < row; ++i)
+    {
+        if (row_pins[i] != RKP_NO_PIN)
+        {
+            pinMode(row_pins[i], OUTPUT);
+        }
+    }
+    setRowsPassive();
+    for (uint8_t j = 0; j < col; ++j)
+    {
+        if (col_pins[j] != RKP_NO_PIN)
+        {
+            pinMode(col_pins[j], mode);
+        }
+    }
     reset();
+#if defined(RUSTY_KEYPAD_TRACE)
+    RustyTrace::clear();
+#endif
+}
+
+uint8_t BaseRustyKeypad::getRowCount()
+{
+    return row_size;
+}
+
+uint8_t BaseRustyKeypad::getColCount()
+{
+    return col_size;
 }
 
 void BaseRustyKeypad::reset()
@@ -86,16 +260,22 @@ void BaseRustyKeypad::reset()
     clearScreen();
     interrupted = true;
     waitKey = nullptr;
-    setBuzzerState(false);
+    RustyBuzzer::stop();
 }
 void BaseRustyKeypad::clearScreen()
 {
-    keypad_data = "";
-    keypad_data_cursor = 0;
-    if (textChangeListener != NULL)
+    keypad_data.clear();
+    credential_state_valid = (credential_table != nullptr);
+    if (credential_state_valid)
     {
-        textChangeListener(getKeypadData());
+        credential_state = RustyCredentials::seed(credential_table->salt);
     }
+    rebuildNumber();
+    keypad_mask[0] = '\0';
+    mask_reveal_index = RUSTY_KEYPAD_MAX_TEXT_LENGTH;
+    memset(mask_field_values, 0, sizeof(mask_field_values));
+    insertMaskLiterals();
+    markTextChange(RKP_TEXT_CLEAR);
 }
 
 void BaseRustyKeypad::enable()
@@ -105,6 +285,8 @@ void BaseRustyKeypad::enable()
         enabled = true;
         reset();
         KeyList->enable();
+        memset(pressed_bits, 0, sizeof(pressed_bits));
+        checkIdle(true);
     }
 }
 
@@ -115,6 +297,7 @@ void BaseRustyKeypad::disable()
         enabled = false;
         reset();
         KeyList->disable();
+        memset(pressed_bits, 0, sizeof(pressed_bits));
     }
 }
 
@@ -124,45 +307,211 @@ void BaseRustyKeypad::appendKey(char key)
     {
         return;
     }
-    if (keypad_data.length() == keypad_data_cursor)
+    toNumberChar(key);
+    if (!acceptMaskKey(key))
     {
-        keypad_data = keypad_data + String(key);
+        return;
     }
+    insertChar(key, true);
+    insertMaskLiterals();
+    markTextChange(RKP_TEXT_INSERT);
+}
 
-    keypad_data_cursor++;
-    if (textChangeListener != NULL)
+void BaseRustyKeypad::deleteChar()
+{
+    if (!use_stored_text)
     {
-        textChangeListener(getKeypadData());
+        return;
     }
+    if (input_mask != nullptr)
+    {
+        uint8_t length = keypad_data.length();
+        while (length > 0 && input_mask->isLiteral(length - 1))
+        {
+            length--;
+        }
+        if (length == 0)
+        {
+            return;
+        }
+        while (keypad_data.length() > length)
+        {
+            removeChar();
+        }
+        input_mask->remove(length - 1, mask_field_values[input_mask->getField(length - 1)]);
+    }
+    if (!removeChar())
+    {
+        return;
+    }
+    markTextChange(RKP_TEXT_DELETE);
 }
 
-void BaseRustyKeypad::deleteChar()
+void BaseRustyKeypad::insertChar(char key, bool reveal)
 {
-    if (keypad_data.length() == 0 || !use_stored_text)
+    if (!keypad_data.insert(key))
     {
         return;
     }
-    if (keypad_data_cursor < keypad_data.length())
+    if (keypad_data.cursor() == keypad_data.length())
+    {
+        pushNumberChar(key);
+    }
+    else
+    {
+        rebuildNumber();
+    }
+    if (credential_state_valid && keypad_data.cursor() == keypad_data.length())
+    {
+        credential_state = RustyCredentials::step(credential_state, key);
+    }
+    else
+    {
+        credential_state_valid = false;
+    }
+
+    uint8_t length = keypad_data.length();
+    if (reveal)
+    {
+        concealMask();
+    }
+    keypad_mask[length - 1] = '*';
+    keypad_mask[length] = '\0';
+    if (reveal && mask_reveal_duration > 0)
+    {
+        mask_reveal_index = keypad_data.cursor() - 1;
+        mask_reveal_ts = millis();
+        keypad_mask[mask_reveal_index] = key;
+    }
+}
+
+bool BaseRustyKeypad::removeChar()
+{
+    uint8_t cursor = keypad_data.cursor();
+    if (cursor == 0)
+    {
+        return false;
+    }
+    char removed = keypad_data.charAt(cursor - 1);
+    keypad_data.erase();
+    if (cursor == keypad_data.length() + 1)
+    {
+        popNumberChar(removed);
+    }
+    else
+    {
+        rebuildNumber();
+    }
+
+    credential_state_valid = false;
+    concealMask();
+    keypad_mask[keypad_data.length()] = '\0';
+    return true;
+}
+
+void BaseRustyKeypad::setInputMask(const RustyInputMask *mask)
+{
+    input_mask = mask;
+    clearScreen();
+}
+
+bool BaseRustyKeypad::acceptMaskKey(char key)
+{
+    if (input_mask == nullptr)
+    {
+        return true;
+    }
+    uint8_t position = keypad_data.length();
+    if (keypad_data.cursor() != position || position >= input_mask->length() || input_mask->isLiteral(position))
+    {
+        return false;
+    }
+    return input_mask->accept(position, key, mask_field_values[input_mask->getField(position)]);
+}
+
+void BaseRustyKeypad::insertMaskLiterals()
+{
+    if (input_mask == nullptr)
+    {
+        return;
+    }
+    uint8_t position = keypad_data.length();
+    while (position < input_mask->length() && input_mask->isLiteral(position))
+    {
+        insertChar(input_mask->getLiteral(position), false);
+        position++;
+    }
+}
+
+void BaseRustyKeypad::moveCursor(char key)
+{
+    if (input_mask != nullptr)
+    {
+        return;
+    }
+    bool moved = (key == cursor_left_key) ? keypad_data.moveLeft() : keypad_data.moveRight();
+    if (!moved)
+    {
+        return;
+    }
+    if (cursorMoveListener != NULL || notificationStream != NULL)
+    {
+        notifyValue(RKP_NOTIFY_CURSOR_MOVE, keypad_data.cursor());
+    }
+}
+
+RustyText BaseRustyKeypad::getKeypadPreview(char key)
+{
+#if defined(RUSTY_KEYPAD_STATIC_ALLOCATION)
+    return getNotifyText(preview_text, key);
+#else
+    char text[RUSTY_KEYPAD_MAX_TEXT_LENGTH + 2];
+    return RustyText(getNotifyText(text, key));
+#endif
+}
+
+const char *BaseRustyKeypad::getNotifyText(char *buffer, char key)
+{
+    uint8_t length = keypad_data.length();
+    if (key == '\0')
+    {
+        if (use_password_mask)
+        {
+            return keypad_mask;
+        }
+        keypad_data.copyTo(buffer);
+        return buffer;
+    }
+    uint8_t cursor = keypad_data.cursor();
+    if (use_password_mask)
     {
-        keypad_data.remove(keypad_data_cursor, 1);
+        memcpy(buffer, keypad_mask, length);
     }
     else
     {
-        keypad_data.remove(keypad_data.length() - 1);
+        keypad_data.copyTo(buffer);
     }
+    memmove(buffer + cursor + 1, buffer + cursor, length - cursor);
+    buffer[cursor] = key;
+    buffer[length + 1] = '\0';
+    return buffer;
+}
 
-    keypad_data_cursor--;
-    if (textChangeListener != NULL)
+const char *BaseRustyKeypad::getEnterText(char *buffer)
+{
+    if (credential_table == nullptr)
     {
-        textChangeListener(getKeypadData());
+        return getNotifyText(buffer, '\0');
     }
+    concealMask();
+    return keypad_mask;
 }
 
 void BaseRustyKeypad::setFactoryConfig()
 {
     uint8_t rows[MAX_KEYPAD_MATRIX_SIZE] = {2U, 3U, 4U, 5U};
     uint8_t cols[MAX_KEYPAD_MATRIX_SIZE] = {6U, 7U, 8U};
-    keyboardSetup(
+    keyboardSetup_P(
         keypadFactoryMap,
         rows,
         cols,
@@ -171,14 +520,17 @@ void BaseRustyKeypad::setFactoryConfig()
         INPUT_PULLUP);
 }
 
-void BaseRustyKeypad::resizeRowPins(size_t size)
+#if !defined(RUSTY_KEYPAD_STATIC_ALLOCATION)
+void BaseRustyKeypad::resizePins(size_t rows, size_t cols)
 {
     if (row_out_pins != nullptr)
     {
         free(row_out_pins);
     }
-    row_out_pins = static_cast<uint8_t *>(malloc(size * sizeof(uint8_t)));
+    row_out_pins = static_cast<uint8_t *>(malloc((rows + cols) * sizeof(uint8_t)));
+    col_in_pins = row_out_pins + rows;
 }
+#endif
 
 void BaseRustyKeypad::addKeyDownListener(void (*listener)(char))
 {
@@ -195,7 +547,7 @@ void BaseRustyKeypad::addLongPressListener(void (*listener)(char))
     longPressListener = listener;
 }
 
-void BaseRustyKeypad::addEnterActionListener(void (*listener)(String))
+void BaseRustyKeypad::addEnterActionListener(void (*listener)(RustyText))
 {
     onEnterListener = listener;
 }
@@ -205,16 +557,26 @@ void BaseRustyKeypad::addDeleteActionListener(void (*listener)(char))
     onDeleteListener = listener;
 }
 
-void BaseRustyKeypad::addMultipleKeyListener(void (*listener)(String))
+void BaseRustyKeypad::addMultipleKeyListener(void (*listener)(RustyText))
 {
     multipleKeyListener = listener;
 }
 
-void BaseRustyKeypad::addTextChangeListener(void (*listener)(String))
+void BaseRustyKeypad::addTextChangeListener(void (*listener)(RustyText))
 {
     textChangeListener = listener;
 }
 
+void BaseRustyKeypad::addTextChangeListener(void (*listener)(RustyText, uint8_t))
+{
+    textChangesListener = listener;
+}
+
+void BaseRustyKeypad::addCursorMoveListener(void (*listener)(uint8_t))
+{
+    cursorMoveListener = listener;
+}
+
 bool BaseRustyKeypad::isEnabled()
 {
     return enabled;
@@ -223,6 +585,8 @@ bool BaseRustyKeypad::isEnabled()
 void BaseRustyKeypad::setType(KeypadTypes type)
 {
     keypad_type = type;
+    selectScanRoutine();
+    rebuildNumber();
 }
 
 KeypadTypes BaseRustyKeypad::getType()
@@ -268,12 +632,14 @@ char BaseRustyKeypad::getDeleteKey()
 void BaseRustyKeypad::ignoreDeleteKey()
 {
     has_delete_key = false;
+    updateKeyRoles();
 }
 
 void BaseRustyKeypad::useDeleteKey(char key)
 {
     delete_key = key;
     has_delete_key = true;
+    updateKeyRoles();
 }
 
 bool BaseRustyKeypad::hasDeleteKey()
@@ -288,27 +654,207 @@ void BaseRustyKeypad::setStoredText(bool state)
 
 void BaseRustyKeypad::setMaxTextLength(uint8_t len)
 {
-    max_text_length = len;
+    max_text_length = len > RUSTY_KEYPAD_MAX_TEXT_LENGTH ? RUSTY_KEYPAD_MAX_TEXT_LENGTH : len;
 }
 
-String BaseRustyKeypad::getKeypadData()
+RustyText BaseRustyKeypad::getKeypadData()
 {
     if (!use_password_mask || keypad_data.length() == 0)
     {
-        return keypad_data;
+#if defined(RUSTY_KEYPAD_STATIC_ALLOCATION)
+        keypad_data.copyTo(keypad_text);
+        return keypad_text;
+#else
+        return keypad_data.toString();
+#endif
+    }
+    return RustyText(keypad_mask);
+}
+
+const char *BaseRustyKeypad::getPasswordMask()
+{
+    return keypad_mask;
+}
+
+bool BaseRustyKeypad::isKeypadEqual(RustyText text)
+{
+    const char *chars = rustyTextChars(text);
+    return keypad_data.equals(chars, strlen(chars));
+}
+
+bool BaseRustyKeypad::setFloatChar(char key)
+{
+    if (isEnterKey(key))
+    {
+        return false;
     }
+    float_char = key;
+    return true;
+}
 
-    String asterisks = "";
-    for (size_t i = 0; i < keypad_data.length(); i++)
+void BaseRustyKeypad::toNumberChar(char &key)
+{
+    if (keypad_type == RKP_FLOAT && key == float_char)
     {
-        asterisks += '*';
+        key = '.';
     }
-    return asterisks;
 }
 
-bool BaseRustyKeypad::isKeypadEqual(String text)
+int8_t BaseRustyKeypad::digitValue(char key)
 {
-    return keypad_data == text;
+    if (key >= '0' && key <= '9')
+    {
+        return key - '0';
+    }
+    if (keypad_type != RKP_HEX)
+    {
+        return -1;
+    }
+    if (key >= 'A' && key <= 'F')
+    {
+        return key - 'A' + 10;
+    }
+    if (key >= 'a' && key <= 'f')
+    {
+        return key - 'a' + 10;
+    }
+    return -1;
+}
+
+void BaseRustyKeypad::pushNumberChar(char key)
+{
+    if (keypad_type == RKP_T9 || number_overflow)
+    {
+        return;
+    }
+    if (key == '.' && keypad_type == RKP_FLOAT)
+    {
+        number_has_separator = true;
+        return;
+    }
+    int8_t digit = digitValue(key);
+    if (digit < 0 || number_truncated)
+    {
+        return;
+    }
+    long base = (keypad_type == RKP_HEX) ? 16 : 10;
+    bool full = (number_value > (LONG_MAX - digit) / base);
+    if (number_has_separator && (full || number_decimals == 9))
+    {
+        number_truncated = true;
+        return;
+    }
+    if (full)
+    {
+        number_overflow = true;
+        return;
+    }
+    number_value = number_value * base + digit;
+    if (number_has_separator)
+    {
+        number_decimals++;
+    }
+}
+
+void BaseRustyKeypad::popNumberChar(char key)
+{
+    if (keypad_type == RKP_T9)
+    {
+        return;
+    }
+    if (number_overflow || number_truncated || (key == '.' && keypad_type == RKP_FLOAT))
+    {
+        rebuildNumber();
+        return;
+    }
+    if (digitValue(key) < 0)
+    {
+        return;
+    }
+    number_value /= (keypad_type == RKP_HEX) ? 16 : 10;
+    if (number_decimals > 0)
+    {
+        number_decimals--;
+    }
+}
+
+void BaseRustyKeypad::rebuildNumber()
+{
+    number_value = 0;
+    number_decimals = 0;
+    number_has_separator = false;
+    number_overflow = false;
+    number_truncated = false;
+    for (uint8_t i = 0; i < keypad_data.length(); i++)
+    {
+        pushNumberChar(keypad_data.charAt(i));
+    }
+}
+
+long BaseRustyKeypad::getIntegerValue()
+{
+    return number_value / powersOfTen[number_decimals];
+}
+
+long BaseRustyKeypad::getFixedValue(uint8_t decimals)
+{
+    if (decimals > 9)
+    {
+        decimals = 9;
+    }
+    if (decimals <= number_decimals)
+    {
+        return number_value / powersOfTen[number_decimals - decimals];
+    }
+    long scale = powersOfTen[decimals - number_decimals];
+    if (number_value > LONG_MAX / scale)
+    {
+        return LONG_MAX;
+    }
+    return number_value * scale;
+}
+
+bool BaseRustyKeypad::isNumberOverflow()
+{
+    return number_overflow;
+}
+
+void BaseRustyKeypad::setCredentialTable(const RustyCredentialTable *table)
+{
+    credential_table = table;
+    credential_state_valid = false;
+}
+
+void BaseRustyKeypad::addCredentialListener(void (*listener)(uint16_t))
+{
+    credentialListener = listener;
+}
+
+uint16_t BaseRustyKeypad::findCredential()
+{
+    if (credential_table == nullptr)
+    {
+        return RKP_CREDENTIAL_NONE;
+    }
+    if (!credential_state_valid)
+    {
+        credential_state = RustyCredentials::seed(credential_table->salt);
+        for (uint8_t i = 0; i < keypad_data.length(); i++)
+        {
+            credential_state = RustyCredentials::step(credential_state, keypad_data.charAt(i));
+        }
+        credential_state_valid = true;
+    }
+    return RustyCredentials::find(credential_table, RustyCredentials::finish(credential_state));
+}
+
+void BaseRustyKeypad::checkCredential()
+{
+    if (credential_table == nullptr || (credentialListener == NULL && notificationStream == NULL))
+    {
+        return;
+    }
+    notifyValue(RKP_NOTIFY_CREDENTIAL, findCredential());
 }
 
 bool BaseRustyKeypad::hasPasswordMask()
@@ -321,10 +867,47 @@ void BaseRustyKeypad::setPasswordMask(bool state)
     use_password_mask = state;
 }
 
+void BaseRustyKeypad::setPasswordReveal(unsigned long duration)
+{
+    mask_reveal_duration = duration;
+    if (duration == 0)
+    {
+        concealMask();
+    }
+}
+
+bool BaseRustyKeypad::concealMask()
+{
+    if (mask_reveal_index >= RUSTY_KEYPAD_MAX_TEXT_LENGTH)
+    {
+        return false;
+    }
+    if (keypad_mask[mask_reveal_index] != '\0')
+    {
+        keypad_mask[mask_reveal_index] = '*';
+    }
+    mask_reveal_index = RUSTY_KEYPAD_MAX_TEXT_LENGTH;
+    return true;
+}
+
+void BaseRustyKeypad::checkPasswordReveal()
+{
+    if (mask_reveal_index >= RUSTY_KEYPAD_MAX_TEXT_LENGTH || (millis() - mask_reveal_ts) <= mask_reveal_duration)
+    {
+        return;
+    }
+    concealMask();
+    if (use_password_mask)
+    {
+        markTextChange(RKP_TEXT_CONCEAL);
+    }
+}
+
 void BaseRustyKeypad::setEnterKey(char key)
 {
     enter_key = key;
     has_enter_key = true;
+    updateKeyRoles();
 }
 
 bool BaseRustyKeypad::isEnterKey(char key)
@@ -334,6 +917,32 @@ bool BaseRustyKeypad::isEnterKey(char key)
     return key == enter_key;
 }
 
+void BaseRustyKeypad::setCursorKeys(char left, char right)
+{
+    cursor_left_key = left;
+    cursor_right_key = right;
+    has_cursor_keys = true;
+    updateKeyRoles();
+}
+
+void BaseRustyKeypad::ignoreCursorKeys()
+{
+    has_cursor_keys = false;
+    updateKeyRoles();
+}
+
+bool BaseRustyKeypad::isCursorKey(char key)
+{
+    if (!has_cursor_keys)
+        return false;
+    return key == cursor_left_key || key == cursor_right_key;
+}
+
+uint8_t BaseRustyKeypad::getCursor()
+{
+    return keypad_data.cursor();
+}
+
 bool BaseRustyKeypad::hasEnterKey()
 {
     return has_enter_key;
@@ -342,85 +951,553 @@ bool BaseRustyKeypad::hasEnterKey()
 void BaseRustyKeypad::ignoreEnterKey()
 {
     has_enter_key = false;
+    updateKeyRoles();
 }
 
-void BaseRustyKeypad::enableBuzzer(uint8_t pin, unsigned long beep_duration)
+void BaseRustyKeypad::updateKeyRoles()
+{
+    if (KeyList == nullptr)
+    {
+        return;
+    }
+    for (RustyKeyNode *temp = KeyList->getHead(); temp != nullptr; temp = temp->next)
+    {
+        temp->data->updateRole();
+    }
+}
+
+void BaseRustyKeypad::enableBuzzer(uint8_t pin, unsigned long beep_duration, uint16_t frequency)
 {
-    buzzer_pin = pin;
-    pinMode(buzzer_pin, OUTPUT);
-    use_buzzer = true;
-    setBuzzerState(false);
     buzzer_beep_duration = beep_duration;
+    RustyBuzzer::begin(pin, frequency);
 }
 
 void BaseRustyKeypad::disableBuzzer()
 {
-    if (buzzer_state)
+    RustyBuzzer::end();
+}
+
+bool BaseRustyKeypad::beepBuzzer(uint8_t count, unsigned long beep_duration)
+{
+    if (!enabled || !RustyBuzzer::isEnabled())
     {
-        setBuzzerState(false);
+        return false;
     }
-    use_buzzer = false;
+    if (count == 0)
+    {
+        RustyBuzzer::stop();
+        return true;
+    }
+    if (beep_duration > 0)
+    {
+        buzzer_beep_duration = beep_duration;
+    }
+    return RustyBuzzer::beep(count, (uint16_t)buzzer_beep_duration);
+}
+
+bool BaseRustyKeypad::playBuzzerPattern(const RustyToneStep *steps)
+{
+    if (!enabled)
+    {
+        return false;
+    }
+    return RustyBuzzer::play(steps);
 }
 
-void BaseRustyKeypad::setBuzzerState(bool state)
+bool BaseRustyKeypad::playBuzzerPattern_P(const RustyToneStep *steps)
 {
-    if (!use_buzzer)
+    if (!enabled)
+    {
+        return false;
+    }
+    return RustyBuzzer::play_P(steps);
+}
+
+bool BaseRustyKeypad::hasPendingDeadline()
+{
+    return !deadlines.isEmpty();
+}
+
+unsigned long BaseRustyKeypad::getNextDeadline()
+{
+    return deadlines.getNextDeadline();
+}
+
+void BaseRustyKeypad::setIdleTimeout(unsigned long timeout)
+{
+    idle_timeout = timeout;
+}
+
+bool BaseRustyKeypad::isIdle()
+{
+    return idle_state;
+}
+
+void BaseRustyKeypad::addIdleListener(void (*listener)(bool))
+{
+    idleListener = listener;
+}
+
+void BaseRustyKeypad::addFaultListener(void (*listener)(uint8_t type, uint8_t a, uint8_t b))
+{
+    faultListener = listener;
+}
+
+void BaseRustyKeypad::markTextChange(uint8_t change)
+{
+    text_changes |= change;
+    text_preview_key = '\0';
+    if (!text_deferred)
+    {
+        flushTextChange();
+    }
+}
+
+void BaseRustyKeypad::markTextPreview(char key)
+{
+    text_changes |= RKP_TEXT_PREVIEW;
+    text_preview_key = key;
+    if (!text_deferred)
+    {
+        flushTextChange();
+    }
+}
+
+void BaseRustyKeypad::flushTextChange()
+{
+    text_deferred = false;
+    uint8_t changes = text_changes;
+    if (changes == 0)
     {
         return;
     }
+    char preview_key = text_preview_key;
+    text_changes = 0;
+    text_preview_key = '\0';
+    if (textChangeListener == NULL && textChangesListener == NULL && notificationStream == NULL)
+    {
+        return;
+    }
+    char text[RUSTY_KEYPAD_MAX_TEXT_LENGTH + 2];
+    notify(RKP_NOTIFY_TEXT_CHANGE, '\0', changes, getNotifyText(text, preview_key));
+}
+
+void BaseRustyKeypad::dispatchNotification(const RustyKeypadNotification &notification)
+{
+    callListener(notification.type, notification.key, notification.value, notification.text);
+}
+
+void BaseRustyKeypad::notifyText(KeypadNotifyTypes type, const char *text)
+{
+    notify(type, '\0', 0, text);
+}
+
+void BaseRustyKeypad::notifyKey(KeypadNotifyTypes type, char key)
+{
+    notify(type, key, 0, "");
+}
+
+void BaseRustyKeypad::notifyValue(KeypadNotifyTypes type, uint16_t value)
+{
+    notify(type, '\0', value, "");
+}
 
-    digitalWrite(buzzer_pin, (state ? HIGH : LOW));
-    buzzer_state = state;
-    last_buzzer_activate_ts = millis();
-    if (!state && buzzer_beep_count > 0)
+void BaseRustyKeypad::notify(KeypadNotifyTypes type, char key, uint16_t value, const char *text)
+{
+    if (notificationSink == NULL)
     {
-        buzzer_beep_count--;
+        callListener(type, key, value, text);
+        return;
     }
+    RustyKeypadNotification notification;
+    notification.type = type;
+    notification.key = key;
+    notification.value = value;
+    strncpy(notification.text, text, RUSTY_KEYPAD_MAX_TEXT_LENGTH + 1);
+    notification.text[RUSTY_KEYPAD_MAX_TEXT_LENGTH + 1] = '\0';
+    notificationSink(notification);
 }
 
-bool BaseRustyKeypad::isBeepDurationOver()
+void BaseRustyKeypad::callListener(uint8_t type, char key, uint16_t value, const char *text)
 {
-    return ((millis() - last_buzzer_activate_ts) > buzzer_beep_duration);
+#if defined(RUSTY_KEYPAD_TRACE)
+    RustyTrace::record(RKP_TRACE_LISTENER, type, (key != '\0' ? (uint8_t)key : (uint8_t)value));
+#endif
+    if (notificationObserver != NULL)
+    {
+        notificationObserver(type, key, value, text);
+    }
+    if (notificationStream != NULL)
+    {
+        notificationStream(type, key, value, text);
+    }
+    switch (type)
+    {
+    case RKP_NOTIFY_TEXT_CHANGE:
+        if (textChangeListener != NULL)
+            textChangeListener(RustyText(text));
+        if (textChangesListener != NULL)
+            textChangesListener(RustyText(text), (uint8_t)value);
+        break;
+    case RKP_NOTIFY_KEY_DOWN:
+        if (keyDownListener != NULL)
+            keyDownListener(key);
+        break;
+    case RKP_NOTIFY_KEY_UP:
+        if (keyUpListener != NULL)
+            keyUpListener(key);
+        break;
+    case RKP_NOTIFY_LONG_PRESS:
+        if (longPressListener != NULL)
+            longPressListener(key);
+        break;
+    case RKP_NOTIFY_MULTIPLE_KEYS:
+        if (multipleKeyListener != NULL)
+            multipleKeyListener(RustyText(text));
+        break;
+    case RKP_NOTIFY_ENTER:
+        if (onEnterListener != NULL)
+            onEnterListener(RustyText(text));
+        break;
+    case RKP_NOTIFY_DELETE:
+        if (onDeleteListener != NULL)
+            onDeleteListener(key);
+        break;
+    case RKP_NOTIFY_CURSOR_MOVE:
+        if (cursorMoveListener != NULL)
+            cursorMoveListener((uint8_t)value);
+        break;
+    case RKP_NOTIFY_CREDENTIAL:
+        if (credentialListener != NULL)
+            credentialListener(value);
+        break;
+    case RKP_NOTIFY_IDLE:
+        if (idleListener != NULL)
+            idleListener(value != 0);
+        break;
+    case RKP_NOTIFY_FAULT:
+        if (faultListener != NULL)
+            faultListener((uint8_t)key, (uint8_t)value, (uint8_t)(value >> 8));
+        break;
+    default:
+        break;
+    }
 }
 
-bool BaseRustyKeypad::beepBuzzer(uint8_t count, unsigned long beep_duration)
+bool BaseRustyKeypad::isIdleScanSkipped()
 {
-    if (!enabled || !use_buzzer || buzzer_beep_count > 0)
+    if (!idle_state)
     {
         return false;
     }
-    if (count == 0)
+    unsigned long now = millis();
+    if ((now - idle_scan_ts) < idle_scan_interval)
     {
-        setBuzzerState(false);
-        buzzer_beep_count = 0;
         return true;
     }
-    if (beep_duration > 0)
+    idle_scan_ts = now;
+    return false;
+}
+
+void BaseRustyKeypad::checkIdle(bool active)
+{
+    unsigned long now = millis();
+    if (active)
     {
-        buzzer_beep_duration = beep_duration;
+        last_activity_ts = now;
+        if (idle_state)
+        {
+            idle_state = false;
+            if (idleListener != NULL || notificationStream != NULL)
+            {
+                notifyValue(RKP_NOTIFY_IDLE, false);
+            }
+        }
+        return;
     }
-    buzzer_beep_count = count;
-    return true;
+
+    if (idle_state)
+    {
+        if (idle_scan_interval < RUSTY_KEYPAD_IDLE_SCAN_MAX_MILLIS && (now - idle_step_ts) >= RUSTY_KEYPAD_IDLE_STEP_MILLIS)
+        {
+            idle_scan_interval *= 2;
+            if (idle_scan_interval > RUSTY_KEYPAD_IDLE_SCAN_MAX_MILLIS)
+            {
+                idle_scan_interval = RUSTY_KEYPAD_IDLE_SCAN_MAX_MILLIS;
+            }
+            idle_step_ts = now;
+        }
+        return;
+    }
+
+    if (idle_timeout == 0 || (now - last_activity_ts) <= idle_timeout)
+    {
+        return;
+    }
+    idle_state = true;
+    idle_scan_interval = RUSTY_KEYPAD_IDLE_SCAN_MIN_MILLIS;
+    idle_scan_ts = now;
+    idle_step_ts = now;
+    if (idleListener != NULL || notificationStream != NULL)
+    {
+        notifyValue(RKP_NOTIFY_IDLE, true);
+    }
+}
+
+unsigned long BaseRustyKeypad::getSleepDuration()
+{
+    if (!enabled)
+    {
+        return RKP_SLEEP_FOREVER;
+    }
+    if (KeyList == nullptr)
+    {
+        return 0;
+    }
+
+    unsigned long now = millis();
+    unsigned long duration = RKP_SLEEP_FOREVER;
+    RustyKeyNode *temp = KeyList->getHead();
+    while (temp != nullptr)
+    {
+        if (temp->data->isPressed())
+        {
+            duration = RUSTY_KEYPAD_KEY_FILTER_MILLIS;
+        }
+        temp = temp->next;
+    }
+
+    if (!deadlines.isEmpty())
+    {
+        duration = untilTime(now, deadlines.getNextDeadline(), duration);
+    }
+    if (RustyBuzzer::hasPendingUpdate())
+    {
+        duration = untilTime(now, RustyBuzzer::getNextChange(), duration);
+    }
+    if (mask_reveal_index < RUSTY_KEYPAD_MAX_TEXT_LENGTH)
+    {
+        duration = untilTime(now, mask_reveal_ts + mask_reveal_duration + 1, duration);
+    }
+    if (!idle_state && idle_timeout > 0)
+    {
+        duration = untilTime(now, last_activity_ts + idle_timeout + 1, duration);
+    }
+    return duration;
+}
+
+unsigned long BaseRustyKeypad::untilTime(unsigned long now, unsigned long time, unsigned long limit)
+{
+    long remaining = (long)(time - now);
+    if (remaining <= 0)
+    {
+        return 0;
+    }
+    return ((unsigned long)remaining < limit ? (unsigned long)remaining : limit);
+}
+
+bool BaseRustyKeypad::isAnyKeyPressed()
+{
+    if (KeyList == nullptr)
+    {
+        return false;
+    }
+    for (uint8_t row = 0; row < row_size; row++)
+    {
+        if (pressed_bits[row] != 0)
+        {
+            return true;
+        }
+    }
+    return false;
 }
 
-void BaseRustyKeypad::checkBuzzer()
+void BaseRustyKeypad::armWakeup()
 {
-    if (!enabled || !use_buzzer || (buzzer_beep_count == 0 && !buzzer_state))
+    if (!enabled || KeyList == nullptr)
     {
         return;
     }
-    if (buzzer_beep_count == 0)
+    uint8_t active = (pins_mode == INPUT_PULLUP ? LOW : HIGH);
+    for (uint8_t i = 0; i < row_size; i++)
+    {
+        if (row_out_pins[i] != RKP_NO_PIN)
+        {
+            digitalWrite(row_out_pins[i], active);
+        }
+    }
+    wakeup_armed = true;
+}
+
+void BaseRustyKeypad::disarmWakeup()
+{
+    if (!wakeup_armed)
     {
-        setBuzzerState(false);
         return;
     }
-    if (isBeepDurationOver())
+    setRowsPassive();
+    wakeup_armed = false;
+}
+
+void BaseRustyKeypad::setRowsPassive()
+{
+    uint8_t passive = (pins_mode == INPUT_PULLUP ? HIGH : LOW);
+    for (uint8_t i = 0; i < row_size; i++)
     {
-        setBuzzerState(!buzzer_state);
+        if (row_out_pins[i] != RKP_NO_PIN)
+        {
+            digitalWrite(row_out_pins[i], passive);
+        }
     }
 }
 
 bool BaseRustyKeypad::isSpecialKey(char key)
 {
-    return isDeleteKey(key) || isEnterKey(key);
-}
\ No newline at end of file
+    return isDeleteKey(key) || isEnterKey(key) || isCursorKey(key);
+}
+
+RustyRowBits BaseRustyKeypad::sampleMatrix()
+{
+#if defined(RUSTY_KEYPAD_LATENCY)
+    RustyLatency::startSample();
+#endif
+    if (sampleSource != NULL)
+    {
+        sampleSource(key_bits, row_size);
+    }
+    else
+    {
+        readMatrix();
+    }
+    if (sampleObserver != NULL)
+    {
+        sampleObserver(key_bits, row_size);
+    }
+
+    RustyRowBits rows = busy_rows;
+    for (uint8_t i = 0; i < row_size; i++)
+    {
+        if (key_bits[i] != 0)
+        {
+            rows |= (RustyRowBits)(1U << i);
+        }
+    }
+    RustyRowBits wait_row = (waitKey != nullptr ? (RustyRowBits)(1U << (waitKey->getIndex() / col_size)) : 0);
+    return (wait_row != 0 ? (rows & wait_row) : rows);
+}
+
+void BaseRustyKeypad::readMatrix()
+{
+    uint8_t active = (pins_mode == INPUT_PULLUP ? LOW : HIGH);
+    uint8_t passive = (pins_mode == INPUT_PULLUP ? HIGH : LOW);
+    for (uint8_t i = 0; i < row_size; i++)
+    {
+        digitalWrite(row_out_pins[i], active);
+    }
+    RustyRowBits cols = 0;
+    for (uint8_t j = 0; j < col_size; j++)
+    {
+        if (digitalRead(col_in_pins[j]) == active)
+        {
+            cols |= (RustyRowBits)(1U << j);
+        }
+    }
+    for (uint8_t i = 0; i < row_size; i++)
+    {
+        digitalWrite(row_out_pins[i], passive);
+    }
+
+    for (uint8_t i = 0; i < row_size; i++)
+    {
+        key_bits[i] = 0;
+        if (cols == 0)
+        {
+            continue;
+        }
+        digitalWrite(row_out_pins[i], active);
+        for (uint8_t j = 0; j < col_size; j++)
+        {
+            if ((cols & (1U << j)) && digitalRead(col_in_pins[j]) == active)
+            {
+                key_bits[i] |= (RustyRowBits)(1U << j);
+            }
+        }
+        digitalWrite(row_out_pins[i], passive);
+    }
+}
+
+void BaseRustyKeypad::updateRowState(uint8_t row)
+{
+    RustyRowBits pressed = 0;
+    bool busy = false;
+    RustyKeyNode *temp = row_heads[row];
+    for (uint8_t j = 0; j < col_size && temp != nullptr; j++, temp = temp->next)
+    {
+        if (temp->data->isPressed())
+        {
+            pressed |= (RustyRowBits)(1U << j);
+        }
+        busy = (busy || temp->data->isBusy());
+    }
+    pressed_bits[row] = pressed;
+    if (busy)
+    {
+        busy_rows |= (RustyRowBits)(1U << row);
+    }
+    else
+    {
+        busy_rows &= (RustyRowBits)~(1U << row);
+    }
+}
+
+void BaseRustyKeypad::maskSkippedRows(RustyRowBits visited)
+{
+    for (uint8_t row = 0; row < row_size; row++, visited >>= 1)
+    {
+        if (!(visited & 1U))
+        {
+            pressed_bits[row] &= key_bits[row];
+        }
+    }
+}
+
+bool BaseRustyKeypad::isKeyPressed(char key)
+{
+    RustyKeyIndex index = getKeyIndex(key);
+    if (index == RKP_NO_KEY_INDEX)
+    {
+        return false;
+    }
+    return isKeyPressed(index / col_size, index % col_size);
+}
+
+bool BaseRustyKeypad::isKeyPressed(uint8_t row, uint8_t col)
+{
+    if (KeyList == nullptr || row >= row_size || col >= col_size)
+    {
+        return false;
+    }
+    return (pressed_bits[row] >> col) & 1U;
+}
+
+RustyKeyIndex BaseRustyKeypad::getKeyIndex(char key)
+{
+    if (KeyList == nullptr)
+    {
+        return RKP_NO_KEY_INDEX;
+    }
+#if RUSTY_KEYPAD_CODE_TABLE
+    return code_table[(uint8_t)key];
+#else
+    RustyKeyNode *temp = KeyList->getHead();
+    while (temp != nullptr)
+    {
+        if (temp->data->getFirstKeyCode() == key)
+        {
+            return temp->data->getIndex();
+        }
+        temp = temp->next;
+    }
+    return RKP_NO_KEY_INDEX;
+#endif
+}
@@ -35,17 +35,66 @@
 #include <stdint.h>
 #include <Arduino.h>
 #include <rusty_key_list.h>
+#include <rusty_text_buffer.h>
+#include <rusty_credentials.h>
+#include <rusty_input_mask.h>
+#include <rusty_buzzer.h>
+#include <rusty_notification.h>
+
+#include <rusty_deadline_queue.h>
+#include <rusty_trace.h>
+#include <rusty_latency.h>
 
 /**
- * @brief Defines the maximum size of the keypad matrix.
+ * @brief Set to 1 to keep a table from the 256 key codes to the keys, so that looking a key up by its
+ *        code doesn't have to search the keys.
  *
- * This macro sets the maximum number of rows and columns allowed in the keypad matrix.
- * It ensures that the keypad matrix does not exceed this size to maintain compatibility
- * with the rest of the system and avoid memory issues.
+ * The table takes 256 bytes (512 bytes with 255 keys or more), so it is off by default on AVR.
+ */
+#ifndef RUSTY_KEYPAD_CODE_TABLE
+#if defined(__AVR__)
+#define RUSTY_KEYPAD_CODE_TABLE 0
+#else
+#define RUSTY_KEYPAD_CODE_TABLE 1
+#endif
+#endif
+
+/**
+ * @brief A bit per column of one matrix row; the matrix state is an array of these words.
+ */
+#if MAX_KEYPAD_MATRIX_SIZE > 8
+typedef uint16_t RustyRowBits;
+#else
+typedef uint8_t RustyRowBits;
+#endif
+
+/**
+ * @brief The scan interval right after the keypad becomes idle, in milliseconds.
+ */
+#ifndef RUSTY_KEYPAD_IDLE_SCAN_MIN_MILLIS
+#define RUSTY_KEYPAD_IDLE_SCAN_MIN_MILLIS 10
+#endif
+
+/**
+ * @brief The longest scan interval of an idle keypad, in milliseconds.
  *
- * @note Adjust this value based on the specific requirements of your keypad matrix.
+ * @note A key press shorter than this interval can be missed while the keypad is idle.
+ */
+#ifndef RUSTY_KEYPAD_IDLE_SCAN_MAX_MILLIS
+#define RUSTY_KEYPAD_IDLE_SCAN_MAX_MILLIS 80
+#endif
+
+/**
+ * @brief How long an idle keypad keeps a scan interval before doubling it, in milliseconds.
+ */
+#ifndef RUSTY_KEYPAD_IDLE_STEP_MILLIS
+#define RUSTY_KEYPAD_IDLE_STEP_MILLIS 1000
+#endif
+
+/**
+ * @brief Returned by `getSleepDuration()` when no scan is needed until a key is pressed.
  */
-#define MAX_KEYPAD_MATRIX_SIZE 5
+#define RKP_SLEEP_FOREVER ((unsigned long)-1)
 
 /**
  * @enum KeypadTypes
@@ -63,12 +112,23 @@ typedef enum
     RKP_FLOAT,
 
     /** Keypad for RKP_T9 text input. */
-    RKP_T9
+    RKP_T9,
+
+    /** Keypad for hexadecimal RKP_HEX input (0-9, A-F). */
+    RKP_HEX
 
 } KeypadTypes;
 
 class BaseRustyKeypad
 {
+    friend class RustyKey;
+    friend class RustyScanTask;
+    friend class RustyAwait;
+    friend class RustyRecorder;
+    friend class RustyReplay;
+    friend class RustyEventStream;
+    friend class RustySelfTest;
+    friend class RustyAnalogKeypad;
 
 public:
     /**
@@ -114,6 +174,78 @@ public:
         uint8_t col,
         uint8_t mode = INPUT_PULLUP);
 
+    /**
+     * @brief Sets up the keypad with a layout stored in flash (PROGMEM).
+     *
+     * Works like `keyboardSetup`, but both the key strings and the table of pointers are read from flash,
+     * so the layout takes no SRAM on AVR boards.
+     *
+     * @example
+     * const char key1[] PROGMEM = "1.,";
+     * const char key2[] PROGMEM = "2ABC";
+     * // ...
+     * const char *const map[MAX_KEYPAD_MATRIX_SIZE][MAX_KEYPAD_MATRIX_SIZE] PROGMEM = {
+     *     {key1, key2, key3},
+     *     // ...
+     * };
+     *
+     * keyboardSetup_P(map, rows, cols, 4, 3);
+     */
+    static void keyboardSetup_P(
+        const char *const map[MAX_KEYPAD_MATRIX_SIZE][MAX_KEYPAD_MATRIX_SIZE],
+        const uint8_t row_pins[MAX_KEYPAD_MATRIX_SIZE],
+        const uint8_t col_pins[MAX_KEYPAD_MATRIX_SIZE],
+        uint8_t row,
+        uint8_t col,
+        uint8_t mode = INPUT_PULLUP);
+
+    /**
+     * @brief Sets up the keypad with a layout of any size up to `MAX_KEYPAD_MATRIX_SIZE`.
+     *
+     * The layout is a flat array of `row * col` key strings, row after row, so it doesn't have to be
+     * declared with the maximum matrix size.
+     *
+     * @example
+     * const char *map[16 * 8] = {
+     *     "A1", "A2", "A3", "A4", "A5", "A6", "A7", "A8",
+     *     // ... 15 more rows
+     * };
+     * const uint8_t rows[16] = {22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37};
+     * const uint8_t cols[8] = {2, 3, 4, 5, 6, 7, 8, 9};
+     *
+     * keyboardSetup(map, rows, cols, 16, 8);
+     */
+    static void keyboardSetup(
+        const char *const *map,
+        const uint8_t *row_pins,
+        const uint8_t *col_pins,
+        uint8_t row,
+        uint8_t col,
+        uint8_t mode = INPUT_PULLUP);
+
+    /**
+     * @brief Sets up the keypad with a flat layout stored in flash (PROGMEM).
+     *
+     * Works like the flat `keyboardSetup`, with the key strings and the table of pointers read from flash.
+     */
+    static void keyboardSetup_P(
+        const char *const *map,
+        const uint8_t *row_pins,
+        const uint8_t *col_pins,
+        uint8_t row,
+        uint8_t col,
+        uint8_t mode = INPUT_PULLUP);
+
+    /**
+     * @brief Returns the number of rows of the configured matrix.
+     */
+    static uint8_t getRowCount();
+
+    /**
+     * @brief Returns the number of columns of the configured matrix.
+     */
+    static uint8_t getColCount();
+
     /**
      * @brief Enables the keypad functionality.
      *
@@ -152,6 +284,8 @@ public:
      * when using the stored text feature. The length is specified by the `len` parameter.
      *
      * @param len The maximum number of characters to allow for stored text. Should be a value greater than 0.
+     *
+     * @note Values above `RUSTY_KEYPAD_MAX_TEXT_LENGTH` are clamped to it.
      */
     static void setMaxTextLength(uint8_t len);
 
@@ -270,7 +404,7 @@ public:
      * @brief Registers a listener for multiple key events.
      *
      * This static function allows you to register a callback function that will be triggered when
-     * multiple keys are pressed in sequence. The callback function should accept a `String` parameter
+     * multiple keys are pressed in sequence. The callback function should accept a `RustyText` parameter
      * representing the sequence of keys pressed.
      *
      * @param listener  A pointer to the function that will handle multiple key events. The function must
@@ -284,17 +418,17 @@ public:
      *
      * addMultipleKeyListener(onMultipleKeyPress);
      */
-    static void addMultipleKeyListener(void (*listener)(String));
+    static void addMultipleKeyListener(void (*listener)(RustyText));
 
     /**
      * @brief Registers a listener for text changes.
      *
      * This static function allows you to register a callback function that will be triggered
-     * whenever there is a change in the text. The callback function should accept a `String`
+     * whenever there is a change in the text. The callback function should accept a `RustyText`
      * parameter representing the updated text.
      *
      * @param listener A pointer to the function that will handle text change events.
-     *                 The function must take a `String` argument representing the updated text.
+     *                 The function must take a `RustyText` argument representing the updated text.
      *
      * @example
      * void onTextChange(String newText) {
@@ -303,18 +437,41 @@ public:
      * }
      *
      * addTextChangeListener(onTextChange);
+     *
+     * @note The changes made during a `scan()` are delivered once at the end of it, with the final text.
+     */
+    static void addTextChangeListener(void (*listener)(RustyText));
+
+    /**
+     * @brief Registers a listener for text changes that also receives what has changed.
+     *
+     * Like the listener above, it is called at most once per `scan()`, with the final text and the
+     * `RustyTextChanges` bits of every change made since the last call. Changes made outside `scan()`,
+     * e.g. by `enable()`, are delivered at once.
+     *
+     * @param listener A pointer to the function that will handle text change events.
+     *
+     * @example
+     * void onTextChange(RustyText text, uint8_t changes) {
+     *     if (changes & RKP_TEXT_CLEAR) {
+     *         lcd.clear();
+     *     }
+     *     lcd.print(text);
+     * }
+     *
+     * addTextChangeListener(onTextChange);
      */
-    static void addTextChangeListener(void (*listener)(String));
+    static void addTextChangeListener(void (*listener)(RustyText, uint8_t));
 
     /**
      * @brief Registers a listener for the enter key press event.
      *
      * This static function allows you to register a callback function that will be triggered
-     * when the enter key is pressed. The callback function should accept a `String` parameter
+     * when the enter key is pressed. The callback function should accept a `RustyText` parameter
      * representing the data or text entered before the enter key was pressed.
      *
      * @param listener  A pointer to the function that will handle the enter key press event.
-     *                  The function must take a `String` argument representing the data entered.
+     *                  The function must take a `RustyText` argument representing the data entered.
      *
      * @example
      * void onEnterPress(String data) {
@@ -324,7 +481,7 @@ public:
      *
      * addEnterActionListener(onEnterPress);
      */
-    static void addEnterActionListener(void (*listener)(String));
+    static void addEnterActionListener(void (*listener)(RustyText));
 
     /**
      * @brief Registers a listener for the Delete key action.
@@ -346,6 +503,25 @@ public:
      */
     static void addDeleteActionListener(void (*listener)(char));
 
+    /**
+     * @brief Registers a listener for cursor movements.
+     *
+     * This static function allows you to register a callback function that will be triggered
+     * whenever the cursor is moved with the cursor keys. The callback function receives the new
+     * cursor position, which is the number of characters in front of the cursor. Text changes
+     * also move the cursor; use `getCursor()` inside the text change listener for those.
+     *
+     * @param listener A pointer to the function that will handle cursor movements.
+     *
+     * @example
+     * void onCursorMove(uint8_t position) {
+     *     LCD.setCursor(position, 1);
+     * }
+     *
+     * addCursorMoveListener(onCursorMove);
+     */
+    static void addCursorMoveListener(void (*listener)(uint8_t));
+
     /**
      * @brief Sets the type of the keypad.
      *
@@ -353,7 +529,14 @@ public:
      * `KeypadTypes` enumeration. The type determines the functionality and behavior of the keypad.
      *
      * @param type  The type of the keypad, specified using the `KeypadTypes` enumeration.
-     *              Possible values include `RKP_INTEGER`, `RKP_FLOAT`, and `RKP_T9`.
+     *              Possible values include `RKP_INTEGER`, `RKP_FLOAT`, `RKP_T9` and `RKP_HEX`.
+     *
+     * In the numeric modes (`RKP_INTEGER`, `RKP_FLOAT` and `RKP_HEX`) the value of the text is kept up
+     * to date as it is typed. Every key is added to the text; the value is read from the digits of the
+     * mode and skips the other characters.
+     *
+     * The scan routine and the key rules for the type are chosen here, so `scan()` doesn't check the
+     * type for every key.
      *
      * @example
      * setType(RKP_INTEGER);  // Configures the keypad for RKP_INTEGER input
@@ -367,7 +550,7 @@ public:
      * `KeypadTypes` enumeration. It indicates which mode the keypad is operating in.
      *
      * @return The type of the keypad, specified using the `KeypadTypes` enumeration.
-     *         Possible values include `RKP_INTEGER`, `RKP_FLOAT`, and `RKP_T9`.
+     *         Possible values include `RKP_INTEGER`, `RKP_FLOAT`, `RKP_T9` and `RKP_HEX`.
      *
      * @example
      * KeypadTypes currentType = getType();
@@ -469,6 +652,48 @@ public:
      */
     static void ignoreEnterKey();
 
+    /**
+     * @brief Assigns the keys that move the cursor to the left and to the right.
+     *
+     * Once assigned, releasing these keys moves the insertion point inside the entered text instead
+     * of appending a character. New characters are inserted at the cursor and the delete key removes
+     * the character in front of the cursor. As with the other special keys, the first character of
+     * each key is used.
+     *
+     * @param left  The first character of the key that moves the cursor to the left.
+     * @param right The first character of the key that moves the cursor to the right.
+     *
+     * @example
+     * setCursorKeys('A', 'B');  // On a 4x4 keypad
+     */
+    static void setCursorKeys(char left, char right);
+
+    /**
+     * @brief Disables the cursor keys.
+     *
+     * After calling this function the keys assigned with `setCursorKeys` behave like regular keys
+     * again and text is always appended at the end.
+     */
+    static void ignoreCursorKeys();
+
+    /**
+     * @brief Checks if the given key is one of the cursor keys.
+     *
+     * @param key The first character of the key to check.
+     * @return true if the key moves the cursor, otherwise false.
+     */
+    static bool isCursorKey(char key);
+
+    /**
+     * @brief Returns the current cursor position.
+     *
+     * The position is the number of characters in front of the cursor, so it can be passed directly
+     * to display functions such as `LCD.setCursor()`.
+     *
+     * @return The cursor position inside the entered text.
+     */
+    static uint8_t getCursor();
+
     /**
      * @brief Returns the current text entered on the keypad.
      *
@@ -479,7 +704,7 @@ public:
      * @return A `String` representing the current keypad input. If the password mask is active,
      *         the string is returned with '*' characters.
      */
-    static String getKeypadData();
+    static RustyText getKeypadData();
 
     /**
      * @brief Compares the current keypad input with a specified string.
@@ -490,7 +715,187 @@ public:
      * @param text The `String` to compare with the current keypad input.
      * @return true if the entered keypad input matches the provided text, otherwise false.
      */
-    static bool isKeypadEqual(String text);
+    static bool isKeypadEqual(RustyText text);
+
+    /**
+     * @brief Sets the input mask that formats the entered text.
+     *
+     * While a mask is set, literal separators of the mask are inserted automatically, keys that don't
+     * fit the position under the cursor or the range of its field are rejected, and the delete key
+     * removes the last typed character together with the separators behind it. Text is always typed
+     * at the end, so the cursor keys have no effect. Setting a mask clears the text.
+     *
+     * @param mask A pointer to a compiled `RustyInputMask`, or `nullptr` to remove the mask.
+     *             The mask must stay valid while it is in use.
+     *
+     * @example
+     * RustyInputMask time;
+     * time.compile("##:##");
+     * time.setRange(0, 0, 23);
+     * time.setRange(1, 0, 59);
+     *
+     * setInputMask(&time);
+     */
+    static void setInputMask(const RustyInputMask *mask);
+
+    /**
+     * @brief Assigns the key that types the decimal separator in RKP_FLOAT mode.
+     *
+     * In RKP_FLOAT mode, tapping this key adds a '.' to the text. The default is '*', which it shares
+     * with the default delete key: a tap types the separator and a long press deletes. It can't be
+     * the enter key, whose tap would end the input with a stray separator.
+     *
+     * @param key The first character of the key to be used as the decimal separator.
+     * @return false, keeping the old key, if the key is the enter key.
+     */
+    static bool setFloatChar(char key);
+
+    /**
+     * @brief Returns the integer value of the entered number.
+     *
+     * The value is accumulated while the number is typed, so no parsing takes place here. In RKP_FLOAT
+     * mode the fractional part is cut off; in RKP_HEX mode the text is read as a hexadecimal number.
+     *
+     * @return The integer value, or the last value that fit if the number overflowed (see `isNumberOverflow`).
+     */
+    static long getIntegerValue();
+
+    /**
+     * @brief Returns the entered number as a fixed-point value.
+     *
+     * The result is the entered number multiplied by 10^decimals, with any further fractional digits
+     * cut off. For example, "12.345" returns 1234 with two decimals.
+     *
+     * @param decimals The number of decimals of the result, at most 9.
+     * @return The fixed-point value, saturated to the range of `long` if it doesn't fit.
+     */
+    static long getFixedValue(uint8_t decimals);
+
+    /**
+     * @brief Checks if the entered number is too large to be represented.
+     *
+     * Decimals beyond the ninth, or beyond what fits in a `long`, are cut off and don't count as an
+     * overflow.
+     *
+     * @return true if the digits before the decimal separator no longer fit in a `long`, otherwise false.
+     */
+    static bool isNumberOverflow();
+
+    /**
+     * @brief Sets the credential table used to check entered codes.
+     *
+     * When a table is set, the entered text is hashed while it is typed and looked up in the table
+     * when the enter key is pressed. The result is reported to the credential listener before the
+     * enter listener, which then receives the text masked with '*' so the code isn't passed around in
+     * plain text. Pass `nullptr` to stop checking credentials.
+     *
+     * @param table A pointer to a credential table generated with `extras/tools/rusty_credentials.py`.
+     *              The table must stay valid while it is in use.
+     *
+     * @example
+     * #include "door_credentials.h"
+     *
+     * setCredentialTable(&door_credentials);
+     */
+    static void setCredentialTable(const RustyCredentialTable *table);
+
+    /**
+     * @brief Looks up the entered text in the credential table.
+     *
+     * The hash of the text is kept up to date while characters are appended, so this costs a final
+     * mix and one pass over the slots of the table, which takes the same time for every code.
+     *
+     * @return The identifier of the matching credential, or `RKP_CREDENTIAL_NONE` if there is no
+     *         match or no credential table is set.
+     */
+    static uint16_t findCredential();
+
+    /**
+     * @brief Registers a listener for credential checks.
+     *
+     * This static function allows you to register a callback function that will be triggered when the
+     * enter key is pressed while a credential table is set. The callback receives the identifier of
+     * the matching credential, or `RKP_CREDENTIAL_NONE` if the entered code is unknown.
+     *
+     * @param listener A pointer to the function that will handle credential checks.
+     *
+     * @example
+     * void onCredential(uint16_t id) {
+     *     if (id == RKP_CREDENTIAL_NONE) {
+     *         // Access denied
+     *         return;
+     *     }
+     *     openDoor(id);
+     * }
+     *
+     * addCredentialListener(onCredential);
+     */
+    static void addCredentialListener(void (*listener)(uint16_t));
+
+    /**
+     * @brief Sets the inactivity time after which the keypad becomes idle.
+     *
+     * While keys are active or T9 input is in progress, the keypad is scanned on every call of `scan()`.
+     * After `timeout` milliseconds without activity, the keypad becomes idle and `scan()` samples the keys
+     * less often: every `RUSTY_KEYPAD_IDLE_SCAN_MIN_MILLIS` at first, doubling every
+     * `RUSTY_KEYPAD_IDLE_STEP_MILLIS` up to `RUSTY_KEYPAD_IDLE_SCAN_MAX_MILLIS`. The first key press
+     * restores the full scan rate.
+     *
+     * @param timeout The inactivity time in milliseconds. Default is 30000, 0 disables the idle mode.
+     */
+    static void setIdleTimeout(unsigned long timeout);
+
+    /**
+     * @brief Checks if the keypad is idle.
+     *
+     * @return true if the keypad is scanned at the reduced idle rate, otherwise false.
+     */
+    static bool isIdle();
+
+    /**
+     * @brief Registers a listener for idle state changes.
+     *
+     * The callback receives `true` when the keypad becomes idle and `false` when a key wakes it up.
+     * It can be used to dim or turn off a display.
+     *
+     * @param listener A pointer to the function that will handle idle state changes.
+     *
+     * @example
+     * void onIdle(bool idle) {
+     *     lcd.setBacklight(idle ? LOW : HIGH);
+     * }
+     *
+     * addIdleListener(onIdle);
+     */
+    static void addIdleListener(void (*listener)(bool));
+
+    /**
+     * @brief Registers a listener for the faults found by `RustySelfTest`.
+     *
+     * The callback receives one of `RustyFaultTypes` and the lines or the key it concerns. Each
+     * fault is reported once.
+     *
+     * @param listener A pointer to the function that will handle the faults.
+     *
+     * @example
+     * void onFault(uint8_t type, uint8_t a, uint8_t b) {
+     *     Serial.print("keypad fault ");
+     *     Serial.println(type);
+     * }
+     *
+     * addFaultListener(onFault);
+     */
+    static void addFaultListener(void (*listener)(uint8_t type, uint8_t a, uint8_t b));
+
+    /**
+     * @brief Calls the listener a notification is meant for.
+     *
+     * Notifications are normally delivered as soon as they happen. When they are queued instead (see
+     * `RustyScanTask`), this function delivers them in the task that takes them from the queue.
+     *
+     * @param notification The notification to deliver.
+     */
+    static void dispatchNotification(const RustyKeypadNotification &notification);
 
     /**
      * @brief Checks if password masking is enabled.
@@ -528,6 +933,29 @@ public:
      */
     static void setPasswordMask(bool state);
 
+    /**
+     * @brief Reveals the last typed character of a masked password for a short time.
+     *
+     * When password masking is enabled, the most recently appended character is shown in clear
+     * text for `duration` milliseconds before it is replaced with '*', similar to the behavior of
+     * password fields on mobile phones. A duration of zero disables the reveal.
+     *
+     * @param duration The reveal time in milliseconds. Default is 0 (disabled).
+     */
+    static void setPasswordReveal(unsigned long duration);
+
+    /**
+     * @brief Returns the masked representation of the entered text.
+     *
+     * The mask is maintained incrementally next to the real text buffer, so this accessor
+     * neither allocates nor iterates over the text. The returned pointer stays valid until
+     * the next text change.
+     *
+     * @return A null-terminated string of '*' characters (with the last character possibly
+     *         revealed, see `setPasswordReveal`).
+     */
+    static const char *getPasswordMask();
+
     /**
      * @brief Enables the buzzer on the specified pin with a default beep duration.
      *
@@ -535,13 +963,15 @@ public:
      * and sets the duration for which it will sound. The default beep duration is set to 50 milliseconds,
      * but it can be overridden by providing a different value.
      *
+     * An active buzzer is switched with a digital output. A passive buzzer needs a tone; pass its frequency
+     * and the beeps are played with `tone()`. `scan()` steps through the beeps, or a timer does on the ESP32.
+     *
      * @param pin The GPIO pin number where the buzzer is connected.
      * @param beep_duration The duration (in milliseconds) for which the buzzer should sound.
      *                      Default is 50 ms if not specified.
-     *
-     * @note Ensure the specified pin is correctly initialized as an output before calling this function.
+     * @param frequency The tone frequency of the beeps in Hz. Default is 0 (active buzzer).
      */
-    static void enableBuzzer(uint8_t pin, unsigned long beep_duration = 50);
+    static void enableBuzzer(uint8_t pin, unsigned long beep_duration = 50, uint16_t frequency = 0);
 
     /**
      * @brief Disables the buzzer.
@@ -558,21 +988,135 @@ public:
     /**
      * @brief Beeps the buzzer a specified number of times.
      *
-     * This static function activates the buzzer for a given number of beeps. If the specified
-     * `beep_duration` is zero, it uses the previously set duration. If a new count is provided,
-     * it overrides the previous beep count. The function returns `false` if the buzzer is currently
-     * busy and cannot perform the operation; otherwise, it returns `true`.
+     * This static function queues the given number of beeps. If the specified `beep_duration` is zero,
+     * it uses the previously set duration. If the buzzer is busy, the beeps are played after the current
+     * pattern. A count of zero silences the buzzer and drops the queue.
      *
      * @param count The number of times to beep the buzzer.
      * @param beep_duration The duration for each beep in milliseconds. If set to zero, the last
      *                      used duration is applied.
      *
      * @return A boolean value:
-     *         - `true` if the operation was successful and the buzzer is now beeping,
-     *         - `false` if the buzzer was busy and the operation could not be performed.
+     *         - `true` if the beeps were queued,
+     *         - `false` if the buzzer is disabled or its queue is full.
      */
     static bool beepBuzzer(uint8_t count, unsigned long beep_duration = 0UL);
 
+    /**
+     * @brief Queues a buzzer pattern stored in RAM.
+     *
+     * The pattern is played after the patterns already queued. It is not copied and has to stay valid
+     * until it has been played.
+     *
+     * @param steps The pattern, terminated by a step with a duration of 0.
+     * @return false if the buzzer is disabled or its queue is full, otherwise true.
+     *
+     * @example
+     * static const RustyToneStep chirp[] = {{2000, 60}, {0, 30}, {2600, 60}, {0, 0}};
+     * RustyKeypad::playBuzzerPattern(chirp);
+     */
+    static bool playBuzzerPattern(const RustyToneStep *steps);
+
+    /**
+     * @brief Queues a buzzer pattern stored in flash (PROGMEM).
+     *
+     * @param steps The pattern, terminated by a step with a duration of 0.
+     * @return false if the buzzer is disabled or its queue is full, otherwise true.
+     */
+    static bool playBuzzerPattern_P(const RustyToneStep *steps);
+
+    /**
+     * @brief Checks if any key is waiting for a timeout.
+     *
+     * @return true if at least one key has a pending deadline, otherwise false.
+     */
+    static bool hasPendingDeadline();
+
+    /**
+     * @brief Returns the earliest pending key deadline.
+     *
+     * Until this time, which is comparable with `millis()`, no key can change its state unless a key
+     * is pressed or released. It can be used to decide how long the application may wait before the
+     * next scan.
+     *
+     * @return The earliest deadline in milliseconds. Only meaningful if `hasPendingDeadline()` is true.
+     */
+    static unsigned long getNextDeadline();
+
+    /**
+     * @brief Returns how long the MCU may sleep before the next scan is required.
+     *
+     * The duration covers the pending key deadlines, the buzzer and the password reveal. While a key
+     * is held, its release can only be detected by scanning, so the duration is limited to the noise
+     * filter. If nothing is pending and no key is held, `RKP_SLEEP_FOREVER` is returned; the MCU may then
+     * sleep until a key press wakes it (see `armWakeup()`).
+     *
+     * Example usage:
+     * @code
+     * RustyKeypad::scan();
+     * unsigned long budget = RustyKeypad::getSleepDuration();
+     * if (budget == RKP_SLEEP_FOREVER)
+     * {
+     *     RustyKeypad::armWakeup();
+     *     // power down, wake on a column pin change
+     *     RustyKeypad::disarmWakeup();
+     * }
+     * @endcode
+     *
+     * @return The sleep duration in milliseconds, `0` if a scan is due now.
+     */
+    static unsigned long getSleepDuration();
+
+    /**
+     * @brief Checks if any key is currently held down.
+     *
+     * @return true if at least one key is pressed, otherwise false.
+     */
+    static bool isAnyKeyPressed();
+
+    /**
+     * @brief Checks if the key with the given code is held down.
+     *
+     * The code is the first character of the key string. When several keys start with the same
+     * character, the first of them in the layout is checked.
+     *
+     * @param key The key code.
+     * @return true if the key is pressed, false if it isn't or there is no such key.
+     */
+    static bool isKeyPressed(char key);
+
+    /**
+     * @brief Checks if the key at the given position of the matrix is held down.
+     *
+     * @param row The row index, starting at 0.
+     * @param col The column index, starting at 0.
+     * @return true if the key is pressed, false if it isn't or the position is outside of the matrix.
+     */
+    static bool isKeyPressed(uint8_t row, uint8_t col);
+
+    /**
+     * @brief Returns the position of the key with the given code, `row * getColCount() + col`.
+     *
+     * @param key The key code, the first character of the key string.
+     * @return The key index, or `RKP_NO_KEY_INDEX` if no key starts with this character.
+     */
+    static RustyKeyIndex getKeyIndex(char key);
+
+    /**
+     * @brief Drives all rows active so that a key press changes its column pin.
+     *
+     * Call this before entering a sleep mode that wakes on a pin change of the column pins (for example
+     * AVR power-down with pin change interrupts or ESP32 light sleep with GPIO wake-up). The rows are
+     * restored by `disarmWakeup()` or automatically by the next `scan()`. Rows set up with `RKP_NO_PIN`
+     * are left alone.
+     */
+    static void armWakeup();
+
+    /**
+     * @brief Restores the rows after `armWakeup()`.
+     */
+    static void disarmWakeup();
+
     /**
      * @brief Checks if the key is a special key.
      *
@@ -659,21 +1203,239 @@ protected:
     static RustyKeyList *KeyList;
 
     /**
-     * @brief Pointer to the function handling key down events.
-     *
-     * This static variable holds a pointer to a function that will be called whenever a key is pressed down.
-     * The function should accept a `char` parameter representing the key that was pressed.
+     * @brief The keys waiting for a timeout, ordered by their deadline.
      *
-     * @note This function pointer is used by the `addKeyDownListener` method to register a key down event handler.
+     * Keys schedule themselves here whenever their event changes. The scan loop wakes only the keys
+     * whose deadline has passed, the other keys skip their timeout checks.
      */
-    static void (*keyDownListener)(char);
+    static RustyDeadlineQueue deadlines;
 
     /**
-     * @brief Pointer to the function handling key up events.
-     *
-     * This static variable holds a pointer to a function that will be called whenever a key is released.
-     * The function should accept a `char` parameter representing the key that was released.
-     *
+     * @brief The first key of each row in `KeyList`; the keys of a row follow each other.
+     */
+    static RustyKeyNode *row_heads[MAX_KEYPAD_MATRIX_SIZE];
+
+    /**
+     * @brief The keys read as pressed by the last `sampleMatrix()`, a word per row and a bit per column.
+     */
+    static RustyRowBits key_bits[MAX_KEYPAD_MATRIX_SIZE];
+
+    /**
+     * @brief A bit per row with a key that is pressed or hasn't returned to RKP_KEY_IDLE yet.
+     */
+    static RustyRowBits busy_rows;
+
+    /**
+     * @brief Samples the key matrix into `key_bits`.
+     *
+     * The sample is read from the pins with `readMatrix()`, or taken from `sampleSource` if it is set,
+     * and then shown to `sampleObserver`.
+     *
+     * @return A bit per row that has a pressed key or is in `busy_rows`, which are the rows `scan()`
+     *         has to process. While a RKP_T9 key is waited for, only its row is returned.
+     */
+    static RustyRowBits sampleMatrix();
+
+    /**
+     * @brief Reads the key matrix from the pins into `key_bits`.
+     *
+     * All rows are driven at once and the columns are read a single time. Only when a column is active
+     * the rows are driven one by one, and then only the active columns are read, so an idle scan costs
+     * two pin writes per row and a read per column whatever the number of keys.
+     */
+    static void readMatrix();
+
+    /**
+     * @brief Fills `key_bits` instead of the pins, if set.
+     *
+     * Used by `RustyReplay` to feed recorded samples to the keys.
+     */
+    static void (*sampleSource)(RustyRowBits *rows, uint8_t row_count);
+
+    /**
+     * @brief Sees every matrix sample before the keys, if set.
+     *
+     * Used by `RustyRecorder` to record the samples.
+     */
+    static void (*sampleObserver)(const RustyRowBits *rows, uint8_t row_count);
+
+    /**
+     * @brief Checks the keys of the rows returned by `sampleMatrix()`; chosen by `selectScanRoutine()`.
+     *
+     * @param rows          A bit per row to check.
+     * @param pressed_keys  Receives the codes of the pressed keys.
+     * @param pressed_count The number of codes in `pressed_keys`.
+     * @return true if a key changed its event, otherwise false.
+     */
+    static bool (*scanRows)(RustyRowBits rows, char *pressed_keys, uint8_t &pressed_count);
+
+    /**
+     * @brief Chooses `scanRows` and the key rules for the keypad type.
+     *
+     * Defined in rusty_keypad.cpp next to the scan routines. With `RUSTY_KEYPAD_GENERIC_SCAN` the
+     * scan routine that checks the type for every key is used, to measure the difference.
+     */
+    static void selectScanRoutine();
+
+    /**
+     * @brief The debounced state of the keys, a word per row and a bit per column.
+     */
+    static RustyRowBits pressed_bits[MAX_KEYPAD_MATRIX_SIZE];
+
+#if RUSTY_KEYPAD_CODE_TABLE
+    /**
+     * @brief The index of the first key starting with each character, or `RKP_NO_KEY_INDEX`.
+     */
+    static RustyKeyIndex code_table[256];
+#endif
+
+    /**
+     * @brief Updates the bits of a row in `busy_rows` and `pressed_bits` from the state of its keys.
+     *
+     * @param row The row index.
+     */
+    static void updateRowState(uint8_t row);
+
+    /**
+     * @brief Clears the `pressed_bits` of the released keys in the rows the scan didn't visit.
+     *
+     * After an early stop, or while a T9 key waits, the keys of the other rows aren't checked and keep
+     * their old state. A key of such a row counts as pressed only while the sample agrees.
+     *
+     * @param visited The rows checked by the scan, a bit per row.
+     */
+    static void maskSkippedRows(RustyRowBits visited);
+
+    /**
+     * @brief Indicates whether the rows are driven active by `armWakeup()`.
+     */
+    static bool wakeup_armed;
+
+    /**
+     * @brief Receives the notifications instead of the listeners, if set.
+     *
+     * Returns false if the notification could not be accepted.
+     */
+    static bool (*notificationSink)(const RustyKeypadNotification &);
+
+    /**
+     * @brief Sees every delivered notification before its listener, if set.
+     *
+     * Used by the awaitable API to mark the coroutines that wait for keys or lines; they are resumed by
+     * `scanObserver`.
+     */
+    static void (*notificationObserver)(uint8_t type, char key, uint16_t value, const char *text);
+
+    /**
+     * @brief Sees every notification, also the ones without a listener, if set.
+     *
+     * Used by `RustyEventStream` to send the events to a host.
+     */
+    static void (*notificationStream)(uint8_t type, char key, uint16_t value, const char *text);
+
+    /**
+     * @brief Called at the end of every scan while `notificationStream` is set.
+     *
+     * Used by `RustyEventStream` to send the records of the scan.
+     */
+    static void (*streamUpdate)();
+
+    /**
+     * @brief Called at the end of every scan that read the pins, if set.
+     *
+     * Used by `RustySelfTest` to test the matrix a little at a time.
+     */
+    static void (*selfTestStep)();
+
+    /**
+     * @brief Called at the start and at the end of every scan, or after every notification delivered by
+     *        `RustyScanTask::dispatch()`, if set.
+     *
+     * Used by the awaitable API to expire the timeouts of the waiting coroutines and to resume them
+     * outside of the listener calls, once the scan has updated the keypad.
+     */
+    static void (*scanObserver)();
+
+    /**
+     * @brief Notifies the listener of a text notification.
+     *
+     * @param type RKP_NOTIFY_TEXT_CHANGE, RKP_NOTIFY_MULTIPLE_KEYS or RKP_NOTIFY_ENTER.
+     * @param text The text passed to the listener.
+     */
+    static void notifyText(KeypadNotifyTypes type, const char *text);
+
+    /**
+     * @brief Notifies the listener of a key notification.
+     *
+     * @param type RKP_NOTIFY_KEY_DOWN, RKP_NOTIFY_KEY_UP, RKP_NOTIFY_LONG_PRESS or RKP_NOTIFY_DELETE.
+     * @param key The key passed to the listener.
+     */
+    static void notifyKey(KeypadNotifyTypes type, char key);
+
+    /**
+     * @brief Notifies the listener of a value notification.
+     *
+     * @param type RKP_NOTIFY_CURSOR_MOVE, RKP_NOTIFY_CREDENTIAL or RKP_NOTIFY_IDLE.
+     * @param value The value passed to the listener.
+     */
+    static void notifyValue(KeypadNotifyTypes type, uint16_t value);
+
+    /**
+     * @brief Hands a notification to the sink, or calls the listener when there is no sink.
+     */
+    static void notify(KeypadNotifyTypes type, char key, uint16_t value, const char *text);
+
+    /**
+     * @brief Calls the listener registered for the notification type.
+     *
+     * The text is only turned into a `RustyText` for a text listener, so the notifications don't build
+     * a String when nobody takes it.
+     */
+    static void callListener(uint8_t type, char key, uint16_t value, const char *text);
+
+    /**
+     * @brief Checks if this scan has to be skipped because the keypad is idle.
+     *
+     * @return true if the idle scan interval has not passed yet, otherwise false.
+     */
+    static bool isIdleScanSkipped();
+
+    /**
+     * @brief Updates the idle state after a scan.
+     *
+     * Activity records the time in `last_activity_ts` and wakes an idle keypad. Without activity, the
+     * keypad becomes idle once `idle_timeout` has passed, and the idle scan interval is stepped up.
+     *
+     * @param active true if a key is pressed, changed its state or is waiting for a timeout.
+     */
+    static void checkIdle(bool active);
+
+    /**
+     * @brief Returns the milliseconds from `now` until `time`, limited to `limit`.
+     *
+     * @param now The current time.
+     * @param time The time to wait for.
+     * @param limit The upper bound of the result.
+     * @return `0` if the time has already passed.
+     */
+    static unsigned long untilTime(unsigned long now, unsigned long time, unsigned long limit);
+
+    /**
+     * @brief Pointer to the function handling key down events.
+     *
+     * This static variable holds a pointer to a function that will be called whenever a key is pressed down.
+     * The function should accept a `char` parameter representing the key that was pressed.
+     *
+     * @note This function pointer is used by the `addKeyDownListener` method to register a key down event handler.
+     */
+    static void (*keyDownListener)(char);
+
+    /**
+     * @brief Pointer to the function handling key up events.
+     *
+     * This static variable holds a pointer to a function that will be called whenever a key is released.
+     * The function should accept a `char` parameter representing the key that was released.
+     *
      * @note This function pointer is used by the `addKeyUpListener` method to register a key up event handler.
      */
     static void (*keyUpListener)(char);
@@ -697,7 +1459,44 @@ protected:
      *
      * @note This function pointer is used by the `addMultipleKeyListener` method to register a multiple key event handler.
      */
-    static void (*multipleKeyListener)(String);
+    static void (*multipleKeyListener)(RustyText);
+
+    /**
+     * @brief Pointer to the function handling text change events with the `RustyTextChanges` bits.
+     */
+    static void (*textChangesListener)(RustyText, uint8_t);
+
+    /**
+     * @brief The `RustyTextChanges` bits not delivered yet.
+     */
+    static uint8_t text_changes;
+
+    /**
+     * @brief The RKP_T9 character shown after the cursor by the pending text change, or `'\0'`.
+     */
+    static char text_preview_key;
+
+    /**
+     * @brief true while `scan()` collects the text changes instead of delivering them.
+     */
+    static bool text_deferred;
+
+    /**
+     * @brief Records a change of the text; it is delivered at once outside `scan()`.
+     *
+     * @param change One of `RustyTextChanges`.
+     */
+    static void markTextChange(uint8_t change);
+
+    /**
+     * @brief Records that the text shows `key` as the RKP_T9 character being selected.
+     */
+    static void markTextPreview(char key);
+
+    /**
+     * @brief Delivers the pending text changes in a single notification and stops collecting them.
+     */
+    static void flushTextChange();
 
     /**
      * @brief Pointer to the function handling text change events.
@@ -708,7 +1507,7 @@ protected:
      * @note This function pointer is used by the `addTextChangeListener` method to register a text
      * change event handler.
      */
-    static void (*textChangeListener)(String);
+    static void (*textChangeListener)(RustyText);
 
     /**
      * @brief Pointer to the function handling the enter key event.
@@ -728,7 +1527,7 @@ protected:
      *
      * addEnterActionListener(onEnterPress);
      */
-    static void (*onEnterListener)(String);
+    static void (*onEnterListener)(RustyText);
 
     /**
      * @brief Pointer to the function handling the Delete key action.
@@ -741,6 +1540,38 @@ protected:
      */
     static void (*onDeleteListener)(char);
 
+    /**
+     * @brief Pointer to the function handling cursor movements.
+     *
+     * This static variable holds a pointer to a function that will be called when the cursor is moved
+     * with the cursor keys. The function receives the new cursor position.
+     *
+     * @note This function pointer is used by the `addCursorMoveListener` method to register a handler.
+     */
+    static void (*cursorMoveListener)(uint8_t);
+
+    /**
+     * @brief Pointer to the function handling credential checks.
+     *
+     * This static variable holds a pointer to a function that will be called with the result of the
+     * credential lookup when the enter key is pressed.
+     *
+     * @note This function pointer is used by the `addCredentialListener` method to register a handler.
+     */
+    static void (*credentialListener)(uint16_t);
+
+    /**
+     * @brief Pointer to the function handling idle state changes.
+     *
+     * @note This function pointer is used by the `addIdleListener` method to register a handler.
+     */
+    static void (*idleListener)(bool);
+
+    /**
+     * @brief Pointer to the function handling the faults found by the self-test.
+     */
+    static void (*faultListener)(uint8_t, uint8_t, uint8_t);
+
     /**
      * @brief Indicates whether an interrupt has occurred.
      *
@@ -818,56 +1649,117 @@ protected:
     static char getDeleteKey();
 
     /**
-     * @brief Appends a character to the `keypad_data` at the current cursor position.
-     *
-     * This static function adds the character entered from the keypad to the `keypad_data` string
-     * at the position specified by `keypad_data_cursor`. The cursor is automatically updated after the
-     * character is inserted. This method is typically triggered by the `RKP_KEY_UP` event, indicating that
-     * a key has been released.
+     * @brief Inserts a character into the `keypad_data` at the current cursor position.
      *
-     * @param key The character to be appended to `keypad_data`.
+     * This static function adds the character entered from the keypad to the `keypad_data` buffer
+     * at the cursor position. The cursor is automatically moved behind the inserted character.
+     * This method is typically triggered by the `RKP_KEY_UP` event, indicating that a key has been released.
      *
-     * @note The cursor position (`keypad_data_cursor`) is incremented after the key is appended.
+     * @param key The character to be inserted into `keypad_data`.
      */
     static void appendKey(char key);
 
     /**
-     * @brief Deletes a character from the text based on the cursor position.
+     * @brief Deletes the character in front of the cursor.
      *
-     * This function removes a character from the text input at the current cursor position.
-     * It adjusts the text accordingly, ensuring that the remaining characters are
-     * correctly repositioned after the deletion. This function is typically used
-     * in conjunction with cursor navigation to manage text editing operations.
+     * This function removes the character before the cursor, like the backspace key of a computer
+     * keyboard. The characters after the cursor are not moved in memory, so deleting in the middle
+     * of the text costs the same as deleting at its end.
      */
     static void deleteChar();
 
     /**
-     * @brief Sets the state of the buzzer.
+     * @brief Inserts a character at the cursor and updates the buffers that follow the text.
+     *
+     * Unlike `appendKey`, this function doesn't validate the character and doesn't notify listeners.
+     *
+     * @param key    The character to insert.
+     * @param reveal true to reveal the character in the password mask, see `setPasswordReveal`.
+     */
+    static void insertChar(char key, bool reveal);
+
+    /**
+     * @brief Removes the character in front of the cursor and updates the buffers that follow the text.
+     *
+     * Unlike `deleteChar`, this function doesn't notify listeners.
+     *
+     * @return true if a character was removed, false if the cursor is at the beginning of the text.
+     */
+    static bool removeChar();
+
+    /**
+     * @brief Checks a key against the input mask position at the end of the text.
+     *
+     * On success the value of the field under the cursor is updated.
+     *
+     * @param key The character to check.
+     * @return true if no mask is set or the key is accepted by the mask, otherwise false.
+     */
+    static bool acceptMaskKey(char key);
+
+    /**
+     * @brief Appends the literal separators of the input mask that follow the end of the text.
+     */
+    static void insertMaskLiterals();
+
+    /**
+     * @brief Moves the cursor with the given cursor key.
+     *
+     * This static function is triggered by the `RKP_KEY_UP` event of a cursor key. It moves the cursor
+     * one character to the left or to the right and notifies the cursor move listener.
+     *
+     * @param key The first character of the cursor key that was released.
+     */
+    static void moveCursor(char key);
+
+    /**
+     * @brief Returns the entered text with a candidate character inserted at the cursor.
+     *
+     * This static function is used in RKP_T9 mode to preview the character that is currently selected
+     * while the key is held down. The password mask is respected.
+     *
+     * @param key The candidate character.
+     * @return The text as it would look if the key was released now.
+     */
+    static RustyText getKeypadPreview(char key);
+
+    /**
+     * @brief Returns the text sent with a notification without building a `RustyText`.
      *
-     * This static function allows you to enable or disable the buzzer by changing its state.
-     * When `state` is set to `true`, the buzzer will be activated, and when set to `false`,
-     * the buzzer will be turned off.
+     * With the password mask on this is the mask itself. Otherwise the text, or the preview of a
+     * candidate character, is copied into `buffer`.
      *
-     * @param state A boolean value indicating the desired state of the buzzer.
-     *              - `true` to activate the buzzer
-     *              - `false` to deactivate the buzzer
+     * @param buffer Room for `RUSTY_KEYPAD_MAX_TEXT_LENGTH + 2` characters.
+     * @param key The candidate character of a preview, or '\0'.
+     */
+    static const char *getNotifyText(char *buffer, char key);
+
+    /**
+     * @brief Returns the text sent with RKP_NOTIFY_ENTER.
+     *
+     * While a credential table is set this is the text masked with '*', whatever the password mask
+     * setting, so the entered code only reaches the credential check. Otherwise see `getNotifyText()`.
      *
-     * @note Ensure that the buzzer pin is properly configured before calling this function.
+     * @param buffer Room for `RUSTY_KEYPAD_MAX_TEXT_LENGTH + 2` characters.
      */
-    static void setBuzzerState(bool state);
+    static const char *getEnterText(char *buffer);
 
     /**
-     * @brief Manages the buzzer state and behavior.
+     * @brief Hides the revealed password character once its reveal time is over.
      *
-     * This static function is responsible for checking the current state of the buzzer
-     * and managing its activation and deactivation based on the set conditions.
-     * It handles the timing for beeping, including checking if the beep duration has
-     * expired and whether to silence the buzzer if the beep count has reached zero.
+     * This static function is called from the scan loop. When the character revealed by
+     * `setPasswordReveal` has been visible for longer than the configured duration, it is
+     * replaced with '*' and the text change listener is notified.
+     */
+    static void checkPasswordReveal();
+
+    /**
+     * @brief Reports the credential lookup of the entered text to the credential listener.
      *
-     * @note This method should be called regularly within the main loop to ensure
-     * that the buzzer operates as expected.
+     * This static function is triggered by the `RKP_PRESS_ENTER` event. It does nothing if no credential
+     * table or no listener is set.
      */
-    static void checkBuzzer();
+    static void checkCredential();
 
 private:
     /**
@@ -889,10 +1781,9 @@ private:
     /**
      * @brief Character used for floating-point input in float mode.
      *
-     * This static variable stores the character used to insert a floating-point symbol (e.g., a decimal point)
-     * when the keypad is in float mode. By default, the `'#'` key is assigned to act as the floating-point input.
-     *
-     * @note This character can be changed if needed, but the default value is set to `'#'`.
+     * This static variable stores the key used to insert a floating-point symbol (a decimal point)
+     * when the keypad is in float mode. By default, the `'#'` key is assigned to act as the floating-point
+     * input, as `'*'` is the default delete key.
      */
     static char float_char;
 
@@ -915,25 +1806,14 @@ private:
     /**
      * @brief Holds the text generated from keypad input.
      *
-     * This static variable stores the string of characters entered via the keypad. It accumulates the
-     * characters as keys are pressed, allowing you to capture and work with the complete input generated
-     * from the keypad.
+     * This static variable stores the characters entered via the keypad in a gap buffer. It accumulates the
+     * characters as keys are pressed and keeps track of the cursor, where the next character will be
+     * inserted. Editing at the cursor doesn't move the rest of the text in memory.
      *
      * @note The content of this variable represents the current input session and can be reset or modified
      *       as needed.
      */
-    static String keypad_data;
-
-    /**
-     * @brief Tracks the position for the next character in the keypad input.
-     *
-     * This static variable holds the cursor position where the next character will be added in the `keypad_data` string.
-     * Each time a key is pressed, the cursor is incremented by one to point to the next position. This position
-     * can also be controlled externally to modify where the next character will be inserted.
-     *
-     * @note This allows you to track and manipulate the insertion point within the current input session.
-     */
-    static unsigned int keypad_data_cursor;
+    static RustyTextBuffer keypad_data;
 
     /**
      * @brief Timeout duration for triggering the IDLE event, in milliseconds.
@@ -957,6 +1837,26 @@ private:
      */
     static unsigned long last_activity_ts;
 
+    /**
+     * @brief Indicates whether the keypad is idle and scanned at a reduced rate.
+     */
+    static bool idle_state;
+
+    /**
+     * @brief The current scan interval of the idle keypad, in milliseconds.
+     */
+    static unsigned long idle_scan_interval;
+
+    /**
+     * @brief The time of the last scan made while the keypad is idle.
+     */
+    static unsigned long idle_scan_ts;
+
+    /**
+     * @brief The time at which the idle scan interval was last changed.
+     */
+    static unsigned long idle_step_ts;
+
     /**
      * @brief Holds the digital output pins used to drive the keypad rows.
      *
@@ -966,22 +1866,71 @@ private:
      *
      * @note The pins are configured as outputs and are used in the keypad scanning process.
      */
+#if defined(RUSTY_KEYPAD_STATIC_ALLOCATION)
+    static uint8_t row_out_pins[MAX_KEYPAD_MATRIX_SIZE];
+
+    /**
+     * @brief Holds the digital input pins of the keypad columns.
+     */
+    static uint8_t col_in_pins[MAX_KEYPAD_MATRIX_SIZE];
+
+    /**
+     * @brief Holds the text returned by `getKeypadData()` in the static allocation mode.
+     */
+    static char keypad_text[RUSTY_KEYPAD_MAX_TEXT_LENGTH + 1];
+
+    /**
+     * @brief Holds the text returned by `getKeypadPreview()` in the static allocation mode.
+     */
+    static char preview_text[RUSTY_KEYPAD_MAX_TEXT_LENGTH + 2];
+#else
     static uint8_t *row_out_pins;
 
     /**
-     * @brief Resizes the array of row output pins to match the current configuration.
+     * @brief Holds the digital input pins of the keypad columns; allocated together with `row_out_pins`.
+     */
+    static uint8_t *col_in_pins;
+#endif
+
+#if !defined(RUSTY_KEYPAD_STATIC_ALLOCATION)
+    /**
+     * @brief Allocates the arrays of row output and column input pins for the current configuration.
      *
-     * This static function adjusts the size of the `row_out_pins` array based on the specified size.
-     * While `row_out_pins` is initially allocated with a size defined by `MAX_KEYPAD_MATRIX_SIZE`,
-     * if the actual number of rows in the keypad configuration is less than this maximum,
-     * this function will resize the array to save memory.
+     * Both arrays are taken from a single allocation sized for the actual number of rows and columns
+     * instead of `MAX_KEYPAD_MATRIX_SIZE`, to save memory.
      *
-     * @param size The new size for the `row_out_pins` array, reflecting the number of row pins required.
+     * @param rows The number of row pins.
+     * @param cols The number of column pins.
+     */
+    static void resizePins(size_t rows, size_t cols);
+#endif
+
+    /**
+     * @brief Drives the row pins of the current matrix to their passive level.
+     */
+    static void setRowsPassive();
+
+    /**
+     * @brief Updates the role of every key after the delete, enter or cursor keys changed.
+     */
+    static void updateKeyRoles();
+
+    /**
+     * @brief Creates the keys of the matrix; shared by all `keyboardSetup` variants.
      *
-     * @note This function is used to optimize memory usage by resizing the array according to the actual
-     *       keypad configuration rather than using the maximum predefined size.
+     * @param map      The key strings, row after row.
+     * @param stride   The distance between the first keys of two rows in `map`.
+     * @param in_flash true if the layout is stored in PROGMEM.
      */
-    static void resizeRowPins(size_t size);
+    static void setupMatrix(
+        const char *const *map,
+        uint8_t stride,
+        const uint8_t *row_pins,
+        const uint8_t *col_pins,
+        uint8_t row,
+        uint8_t col,
+        uint8_t mode,
+        bool in_flash);
 
     /**
      * @brief A static constant 2D array representing the factory keypad layout.
@@ -989,9 +1938,9 @@ private:
      * This array defines the default key mappings for the keypad interface,
      * with each entry corresponding to a specific key configuration.
      * As a static member, it ensures consistent access across all instances
-     * of the class.
+     * of the class. The table and its strings are stored in flash (PROGMEM).
      */
-    static const char *keypadFactoryMap[MAX_KEYPAD_MATRIX_SIZE][MAX_KEYPAD_MATRIX_SIZE];
+    static const char *const keypadFactoryMap[MAX_KEYPAD_MATRIX_SIZE][MAX_KEYPAD_MATRIX_SIZE];
 
     /**
      * @brief Holds the last key pressed in RKP_T9 mode.
@@ -1054,6 +2003,128 @@ private:
      */
     static bool use_password_mask;
 
+    /**
+     * @brief Holds the masked representation of `keypad_data`.
+     *
+     * This buffer always contains one '*' per stored character followed by a null terminator.
+     * Since every position holds the same character, inserting at the cursor only extends it by one.
+     * It is updated together with `keypad_data` in `appendKey`, `deleteChar` and `clearScreen`,
+     * so reading the mask is allocation-free and independent of the text length.
+     */
+    static char keypad_mask[RUSTY_KEYPAD_MAX_TEXT_LENGTH + 1];
+
+    /**
+     * @brief Duration, in milliseconds, for which the last typed character stays visible.
+     *
+     * A value of zero disables revealing, so every character is masked immediately.
+     */
+    static unsigned long mask_reveal_duration;
+
+    /**
+     * @brief Timestamp at which the currently revealed character was typed.
+     */
+    static unsigned long mask_reveal_ts;
+
+    /**
+     * @brief Position of the revealed character in `keypad_mask`.
+     *
+     * Holds `RUSTY_KEYPAD_MAX_TEXT_LENGTH` when no character is revealed.
+     */
+    static uint8_t mask_reveal_index;
+
+    /**
+     * @brief The credential table used to check entered codes, or `nullptr`.
+     */
+    static const RustyCredentialTable *credential_table;
+
+    /**
+     * @brief Running hash state of the entered text.
+     *
+     * The state is advanced with each character appended at the end of the text. Edits elsewhere
+     * invalidate it, and it is then rebuilt from the text on the next lookup.
+     */
+    static uint32_t credential_state;
+
+    /**
+     * @brief Indicates whether `credential_state` matches the entered text.
+     */
+    static bool credential_state_valid;
+
+    /**
+     * @brief The input mask that formats the entered text, or `nullptr`.
+     */
+    static const RustyInputMask *input_mask;
+
+    /**
+     * @brief Values typed so far in each field of the input mask.
+     *
+     * Only the fields that have a range are tracked.
+     */
+    static uint16_t mask_field_values[RUSTY_KEYPAD_MAX_MASK_FIELDS];
+
+    /**
+     * @brief Digits of the entered number, without the decimal separator.
+     */
+    static long number_value;
+
+    /**
+     * @brief Number of digits after the decimal separator in RKP_FLOAT mode.
+     */
+    static uint8_t number_decimals;
+
+    /**
+     * @brief Indicates whether the entered number contains the decimal separator.
+     */
+    static bool number_has_separator;
+
+    /**
+     * @brief Indicates whether the entered number overflowed `number_value`.
+     */
+    static bool number_overflow;
+
+    /**
+     * @brief Indicates whether characters of the fraction were left out of `number_value`.
+     *
+     * Set by the decimals beyond the ninth and the decimals that no longer fit.
+     */
+    static bool number_truncated;
+
+    /**
+     * @brief Converts a key into the character stored for the current numeric mode.
+     *
+     * @param key The key code; the float key is replaced with '.' in RKP_FLOAT mode.
+     */
+    static void toNumberChar(char &key);
+
+    /**
+     * @brief Returns the value of a digit in the current numeric mode, or -1.
+     */
+    static int8_t digitValue(char key);
+
+    /**
+     * @brief Adds a character typed at the end of the text to the entered number.
+     */
+    static void pushNumberChar(char key);
+
+    /**
+     * @brief Removes the last character of the text from the entered number.
+     */
+    static void popNumberChar(char key);
+
+    /**
+     * @brief Recalculates the entered number from the text.
+     *
+     * This is used after edits in the middle of the text, after an overflow and after the mode changes.
+     */
+    static void rebuildNumber();
+
+    /**
+     * @brief Replaces the revealed character, if any, with '*'.
+     *
+     * @return true if a revealed character was hidden, otherwise false.
+     */
+    static bool concealMask();
+
     /**
      * @brief Indicates whether an enter key has been assigned.
      *
@@ -1079,54 +2150,19 @@ private:
     static char enter_key;
 
     /**
-     * @brief Static variable representing the pin connected to the buzzer.
-     *
-     * This static variable holds the GPIO pin number that is assigned to control the buzzer.
-     * Being static, it is shared across all instances of the class, meaning it doesn't belong to
-     * any specific instance of the class but to the class itself.
-     *
-     * The pin number should be set using the appropriate method before any operations involving the buzzer.
-     *
-     * @note The pin must be correctly initialized and configured for output to properly control the buzzer.
+     * @brief Indicates whether cursor keys have been assigned.
      */
-    static uint8_t buzzer_pin;
+    static bool has_cursor_keys;
 
     /**
-     * @brief Static flag to enable or disable the buzzer functionality.
-     *
-     * This static boolean variable determines whether the buzzer feature is active or not.
-     * When set to `true`, the system will allow the use of the buzzer to provide audible feedback.
-     * When set to `false`, the buzzer will be disabled, and no sound will be triggered.
-     *
-     * This variable is shared across all instances of the class and controls the global behavior
-     * of the buzzer.
-     *
-     * @note Ensure the `buzzer_pin` is properly set before enabling this feature.
-     */
-    static bool use_buzzer;
-
-    /**
-     * @brief Static variable to indicate the current state of the buzzer.
-     *
-     * This static boolean variable shows whether the buzzer is currently sounding (true) or silent (false).
-     * It is used to track if the buzzer is active or inactive at any given moment.
-     *
-     * This variable helps manage the buzzer's operation within the system and can be used
-     * to ensure that the buzzer is only activated when necessary.
+     * @brief The first character of the key that moves the cursor to the left.
      */
-    static bool buzzer_state;
+    static char cursor_left_key;
 
     /**
-     * @brief Static variable to store the timestamp of the last buzzer activation.
-     *
-     * This static unsigned long variable keeps track of the time (in milliseconds) when the buzzer
-     * was last activated. It can be used to implement timing logic, such as preventing the buzzer
-     * from sounding continuously or for a specified duration.
-     *
-     * This variable is essential for managing the buzzer's behavior in relation to time-sensitive actions,
-     * allowing for more controlled and efficient use of the buzzer.
+     * @brief The first character of the key that moves the cursor to the right.
      */
-    static unsigned long last_buzzer_activate_ts;
+    static char cursor_right_key;
 
     /**
      * @brief Static variable to define the duration of the buzzer beep.
@@ -1139,31 +2175,5 @@ private:
      * to manage user notifications or alerts based on time intervals.
      */
     static unsigned long buzzer_beep_duration;
-
-    /**
-     * @brief Checks if the beep duration for the buzzer has elapsed.
-     *
-     * This static function compares the current time against the last activation timestamp
-     * of the buzzer to determine if the specified beep duration has passed. It returns `true`
-     * if the duration has exceeded, indicating that the buzzer can be activated again or
-     * that the previous beep has completed.
-     *
-     * @return A boolean value:
-     *         - `true` if the beep duration is over,
-     *         - `false` if the beep duration is still active.
-     */
-    static bool isBeepDurationOver();
-
-    /**
-     * @brief Counts the number of beeps to determine when to silence the buzzer.
-     *
-     * This static variable holds the count of how many times the buzzer is allowed to beep
-     * before it silences. Each time the buzzer beeps, this count is decremented. When the
-     * count reaches zero, the buzzer will be turned off.
-     *
-     * @note Ensure to decrement this count each time the buzzer beeps. Once it reaches zero,
-     * the buzzer should be disabled to prevent further sounds until the count is reset.
-     */
-    static uint8_t buzzer_beep_count;
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,269 @@
+#include <rusty_analog_keypad.h>
+
+uint8_t RustyAnalogKeypad::analog_pin{0};
+bool RustyAnalogKeypad::running{false};
+uint8_t RustyAnalogKeypad::key_count{0};
+uint8_t RustyAnalogKeypad::band_count{0};
+uint16_t RustyAnalogKeypad::key_levels[RUSTY_KEYPAD_ANALOG_MAX_KEYS];
+uint16_t RustyAnalogKeypad::idle_level{0};
+uint16_t RustyAnalogKeypad::thresholds[RUSTY_KEYPAD_ANALOG_MAX_KEYS];
+uint16_t RustyAnalogKeypad::band_levels[RUSTY_KEYPAD_ANALOG_MAX_KEYS + 1];
+RustyKeyIndex RustyAnalogKeypad::band_keys[RUSTY_KEYPAD_ANALOG_MAX_KEYS + 1]{RKP_NO_KEY_INDEX};
+uint16_t RustyAnalogKeypad::last_value{0};
+RustyKeyIndex RustyAnalogKeypad::stable_key{RKP_NO_KEY_INDEX};
+RustyKeyIndex RustyAnalogKeypad::candidate_key{RKP_NO_KEY_INDEX};
+uint8_t RustyAnalogKeypad::candidate_count{0};
+
+void RustyAnalogKeypad::keyboardSetup(const char *const *map, uint8_t row, uint8_t col)
+{
+    uint8_t pins[MAX_KEYPAD_MATRIX_SIZE];
+    memset(pins, RKP_NO_PIN, sizeof(pins));
+    BaseRustyKeypad::keyboardSetup(map, pins, pins, row, col);
+}
+
+void RustyAnalogKeypad::keyboardSetup_P(const char *const *map, uint8_t row, uint8_t col)
+{
+    uint8_t pins[MAX_KEYPAD_MATRIX_SIZE];
+    memset(pins, RKP_NO_PIN, sizeof(pins));
+    BaseRustyKeypad::keyboardSetup_P(map, pins, pins, row, col);
+}
+
+bool RustyAnalogKeypad::begin(uint8_t pin, const uint16_t *levels, uint16_t idle)
+{
+    uint16_t keys = (uint16_t)BaseRustyKeypad::row_size * BaseRustyKeypad::col_size;
+    bool valid = (keys <= RUSTY_KEYPAD_ANALOG_MAX_KEYS);
+    analog_pin = pin;
+    key_count = (uint8_t)(valid ? keys : RUSTY_KEYPAD_ANALOG_MAX_KEYS);
+    idle_level = idle;
+    for (uint8_t i = 0; i < key_count; i++)
+    {
+        key_levels[i] = (levels != nullptr ? levels[i] : RKP_ANALOG_NO_LEVEL);
+    }
+    for (uint8_t i = 0; i < key_count && valid; i++)
+    {
+        valid = (key_levels[i] == RKP_ANALOG_NO_LEVEL || isSeparate(key_levels[i], i));
+    }
+    buildThresholds();
+    last_value = idle;
+    stable_key = RKP_NO_KEY_INDEX;
+    candidate_key = RKP_NO_KEY_INDEX;
+    candidate_count = 0;
+    running = true;
+    BaseRustyKeypad::sampleSource = &RustyAnalogKeypad::sample;
+    return valid;
+}
+
+void RustyAnalogKeypad::end()
+{
+    if (!running)
+    {
+        return;
+    }
+    running = false;
+    BaseRustyKeypad::sampleSource = NULL;
+}
+
+bool RustyAnalogKeypad::isRunning()
+{
+    return running;
+}
+
+uint16_t RustyAnalogKeypad::read()
+{
+    uint16_t spread;
+    return read(spread);
+}
+
+uint16_t RustyAnalogKeypad::read(uint16_t &spread)
+{
+    uint32_t sum = 0;
+    uint16_t lowest = 0xFFFF;
+    uint16_t highest = 0;
+    for (uint8_t i = 0; i < RUSTY_KEYPAD_ANALOG_OVERSAMPLING; i++)
+    {
+        uint16_t value = (uint16_t)analogRead(analog_pin);
+        sum += value;
+        lowest = (value < lowest ? value : lowest);
+        highest = (value > highest ? value : highest);
+    }
+    spread = (uint16_t)(highest - lowest);
+    return (uint16_t)((sum + RUSTY_KEYPAD_ANALOG_OVERSAMPLING / 2) / RUSTY_KEYPAD_ANALOG_OVERSAMPLING);
+}
+
+RustyKeyIndex RustyAnalogKeypad::getKey(uint16_t value)
+{
+    return band_keys[findBand(value)];
+}
+
+uint8_t RustyAnalogKeypad::findBand(uint16_t value)
+{
+    uint8_t low = 0;
+    uint8_t high = band_count;
+    while (low < high)
+    {
+        uint8_t middle = (uint8_t)((low + high) / 2);
+        if (value < thresholds[middle])
+        {
+            high = middle;
+        }
+        else
+        {
+            low = (uint8_t)(middle + 1);
+        }
+    }
+    return low;
+}
+
+bool RustyAnalogKeypad::isSettled(uint8_t band, uint16_t value)
+{
+    uint16_t level = band_levels[band];
+    uint16_t below = (band > 0 ? (uint16_t)(level - thresholds[band - 1]) : 0xFFFF);
+    uint16_t above = (band < band_count ? (uint16_t)(thresholds[band] - level) : 0xFFFF);
+    uint16_t window = (below < above ? below : above);
+    return (value > level ? value - level : level - value) <= window;
+}
+
+bool RustyAnalogKeypad::calibrateKey(RustyKeyIndex index)
+{
+    if (index >= key_count)
+    {
+        return false;
+    }
+    uint16_t level = measure();
+    if (level == RKP_ANALOG_NO_LEVEL || !isSeparate(level, index))
+    {
+        return false;
+    }
+    key_levels[index] = level;
+    buildThresholds();
+    return true;
+}
+
+bool RustyAnalogKeypad::calibrateIdle()
+{
+    uint16_t level = measure();
+    if (level == RKP_ANALOG_NO_LEVEL || !isSeparate(level, RKP_NO_KEY_INDEX))
+    {
+        return false;
+    }
+    idle_level = level;
+    buildThresholds();
+    return true;
+}
+
+const uint16_t *RustyAnalogKeypad::getLevels()
+{
+    return key_levels;
+}
+
+uint16_t RustyAnalogKeypad::getIdleLevel()
+{
+    return idle_level;
+}
+
+uint16_t RustyAnalogKeypad::getLastValue()
+{
+    return last_value;
+}
+
+RustyKeyIndex RustyAnalogKeypad::getCurrentKey()
+{
+    return stable_key;
+}
+
+void RustyAnalogKeypad::sample(RustyRowBits *rows, uint8_t row_count)
+{
+    for (uint8_t i = 0; i < row_count; i++)
+    {
+        rows[i] = 0;
+    }
+    uint16_t spread;
+    last_value = read(spread);
+    uint8_t band = findBand(last_value);
+    if (spread > RUSTY_KEYPAD_ANALOG_TOLERANCE || !isSettled(band, last_value))
+    {
+        candidate_count = 0;
+    }
+    else if (band_keys[band] != candidate_key || candidate_count == 0)
+    {
+        candidate_key = band_keys[band];
+        candidate_count = 1;
+    }
+    else if (candidate_count < RUSTY_KEYPAD_ANALOG_STABLE_SAMPLES)
+    {
+        candidate_count++;
+    }
+    if (candidate_count == RUSTY_KEYPAD_ANALOG_STABLE_SAMPLES)
+    {
+        stable_key = candidate_key;
+    }
+    uint8_t cols = BaseRustyKeypad::col_size;
+    if (stable_key != RKP_NO_KEY_INDEX && stable_key / cols < row_count)
+    {
+        rows[stable_key / cols] |= (RustyRowBits)(1U << (stable_key % cols));
+    }
+}
+
+uint16_t RustyAnalogKeypad::measure()
+{
+    uint32_t sum = 0;
+    uint16_t lowest = 0xFFFF;
+    uint16_t highest = 0;
+    for (uint8_t i = 0; i < RUSTY_KEYPAD_ANALOG_CALIBRATION_SAMPLES; i++)
+    {
+        uint16_t value = read();
+        sum += value;
+        lowest = (value < lowest ? value : lowest);
+        highest = (value > highest ? value : highest);
+    }
+    if (highest - lowest > RUSTY_KEYPAD_ANALOG_TOLERANCE)
+    {
+        return RKP_ANALOG_NO_LEVEL;
+    }
+    return (uint16_t)((sum + RUSTY_KEYPAD_ANALOG_CALIBRATION_SAMPLES / 2) / RUSTY_KEYPAD_ANALOG_CALIBRATION_SAMPLES);
+}
+
+bool RustyAnalogKeypad::isSeparate(uint16_t level, RustyKeyIndex index)
+{
+    if (index != RKP_NO_KEY_INDEX && abs((int32_t)level - (int32_t)idle_level) < RUSTY_KEYPAD_ANALOG_TOLERANCE)
+    {
+        return false;
+    }
+    for (uint8_t i = 0; i < key_count; i++)
+    {
+        if (i != index && key_levels[i] != RKP_ANALOG_NO_LEVEL &&
+            abs((int32_t)level - (int32_t)key_levels[i]) < RUSTY_KEYPAD_ANALOG_TOLERANCE)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void RustyAnalogKeypad::buildThresholds()
+{
+    uint16_t *levels = band_levels;
+    uint8_t count = 0;
+    levels[0] = idle_level;
+    band_keys[count++] = RKP_NO_KEY_INDEX;
+    for (uint8_t i = 0; i < key_count; i++)
+    {
+        if (key_levels[i] == RKP_ANALOG_NO_LEVEL)
+        {
+            continue;
+        }
+        uint8_t j = count++;
+        for (; j > 0 && levels[j - 1] > key_levels[i]; j--)
+        {
+            levels[j] = levels[j - 1];
+            band_keys[j] = band_keys[j - 1];
+        }
+        levels[j] = key_levels[i];
+        band_keys[j] = i;
+    }
+    band_count = (uint8_t)(count - 1);
+    for (uint8_t i = 0; i < band_count; i++)
+    {
+        thresholds[i] = (uint16_t)(((uint32_t)levels[i] + levels[i + 1] + 1) / 2);
+    }
+}
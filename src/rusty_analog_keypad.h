@@ -0,0 +1,275 @@
+/*
+ * RustyAnalogKeypad Class
+ *
+ * Author: Aras TAŞKIRAN
+ * Email: aras@arastaskiran.com
+ * Date: 2024-09-2024
+ *
+ * Description:
+ *
+ * Cheap keypads often have no matrix at all: the keys switch the taps of a
+ * resistor ladder onto a single analog pin, so every key gives its own voltage.
+ * RustyAnalogKeypad reads that pin once per scan, averages a few ADC readings,
+ * looks the voltage up in a table of thresholds and hands the key to the
+ * keypad as a matrix sample. The keys then go through the same states, events
+ * and listeners as the keys of a matrix. A calibration helper measures the
+ * level of each key on the actual board.
+ *
+ * License:
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUSTY_KEYPAD_ANALOG_KEYPAD_H
+#define RUSTY_KEYPAD_ANALOG_KEYPAD_H
+
+#include <stdint.h>
+#include <Arduino.h>
+#include <base_keypad.h>
+
+/**
+ * @brief The most keys on a resistor ladder.
+ */
+#ifndef RUSTY_KEYPAD_ANALOG_MAX_KEYS
+#define RUSTY_KEYPAD_ANALOG_MAX_KEYS 16
+#endif
+
+#if RUSTY_KEYPAD_ANALOG_MAX_KEYS > RUSTY_KEYPAD_MAX_KEYS
+#error "RUSTY_KEYPAD_ANALOG_MAX_KEYS must not be larger than RUSTY_KEYPAD_MAX_KEYS"
+#endif
+
+/**
+ * @brief The number of ADC readings averaged into one sample.
+ */
+#ifndef RUSTY_KEYPAD_ANALOG_OVERSAMPLING
+#define RUSTY_KEYPAD_ANALOG_OVERSAMPLING 4
+#endif
+
+/**
+ * @brief The number of samples in a row that have to show the same key before it is passed on.
+ *
+ * While a contact bounces or the ladder settles, the voltage passes the levels of other keys. A key
+ * matrix never shows such keys, so the key filter of the keypad doesn't catch them.
+ */
+#ifndef RUSTY_KEYPAD_ANALOG_STABLE_SAMPLES
+#define RUSTY_KEYPAD_ANALOG_STABLE_SAMPLES 3
+#endif
+
+/**
+ * @brief The smallest distance between two levels, in ADC counts.
+ *
+ * Levels closer than this can't be told apart reliably. A sample whose readings spread more than this
+ * is taken while the voltage moves and is ignored, and so is a calibration whose samples do.
+ */
+#ifndef RUSTY_KEYPAD_ANALOG_TOLERANCE
+#define RUSTY_KEYPAD_ANALOG_TOLERANCE 8
+#endif
+
+/**
+ * @brief The number of samples taken to calibrate a level.
+ */
+#ifndef RUSTY_KEYPAD_ANALOG_CALIBRATION_SAMPLES
+#define RUSTY_KEYPAD_ANALOG_CALIBRATION_SAMPLES 32
+#endif
+
+/**
+ * @brief The level of a key that hasn't been calibrated; such a key is never read as pressed.
+ */
+#define RKP_ANALOG_NO_LEVEL 0xFFFF
+
+/**
+ * @class RustyAnalogKeypad
+ * @brief Reads the keys of a resistor ladder from a single analog pin.
+ *
+ * The keypad is set up with `RustyAnalogKeypad::keyboardSetup()`, which takes the layout but no
+ * pins, and `begin()` with the ADC level of every key and of the released keypad:
+ *
+ * @code
+ * const char *map[4 * 4] = {"1", "2", "3", "A", "4", "5", "6", "B", "7", "8", "9", "C", "*", "0", "#", "D"};
+ * const uint16_t levels[4 * 4] = {0, 64, 128, 192, ...};
+ *
+ * RustyAnalogKeypad::keyboardSetup(map, 4, 4);
+ * RustyAnalogKeypad::begin(A0, levels, 1023);
+ * RustyKeypad::enable();
+ * @endcode
+ *
+ * Every scan averages `RUSTY_KEYPAD_ANALOG_OVERSAMPLING` readings and finds the nearest level with a
+ * binary search over the midpoints between the sorted levels, so the lookup costs a handful of
+ * comparisons whatever the number of keys. A key is passed on once `RUSTY_KEYPAD_ANALOG_STABLE_SAMPLES`
+ * samples in a row are settled at its level: the readings of a sample spread no more than
+ * `RUSTY_KEYPAD_ANALOG_TOLERANCE`, and their average is no farther from the level than half the gap
+ * to the nearest other level. Until then the last key stays, so the mixed readings of a bouncing
+ * contact, whose average can fall on any other key, don't press other keys.
+ *
+ * A ladder can only show one key at a time: two keys pressed together read as a third level, usually
+ * as the key nearer to the pin. RKP_NOTIFY_MULTIPLE_KEYS is never sent.
+ *
+ * The samples are fed through `sampleSource`, so `RustyRecorder` records them like matrix samples.
+ * `RustyReplay` replaces the analog pin until `begin()` is called again, and `RustySelfTest` has no
+ * pins to test and is skipped.
+ */
+class RustyAnalogKeypad
+{
+public:
+    /**
+     * @brief Sets up a keypad without pins; works like the flat `keyboardSetup` of `RustyKeypad`.
+     *
+     * @param map The key strings, `row * col` of them, row after row.
+     * @param row The number of rows.
+     * @param col The number of columns.
+     */
+    static void keyboardSetup(const char *const *map, uint8_t row, uint8_t col);
+
+    /**
+     * @brief Sets up a keypad without pins from a layout stored in flash (PROGMEM).
+     */
+    static void keyboardSetup_P(const char *const *map, uint8_t row, uint8_t col);
+
+    /**
+     * @brief Starts reading the keys from the analog pin.
+     *
+     * Call it after `keyboardSetup()`, as the number of keys comes from the layout.
+     *
+     * @param pin    The analog pin of the ladder.
+     * @param levels The ADC reading of every key, `row * col` of them in the order of the layout, or
+     *               nullptr to calibrate every key with `calibrateKey()`. The table is copied, so it
+     *               can be built on the stack or read from EEPROM. Keys at `RKP_ANALOG_NO_LEVEL` are
+     *               left out.
+     * @param idle   The ADC reading while no key is pressed.
+     * @return false if there are more than `RUSTY_KEYPAD_ANALOG_MAX_KEYS` keys or two levels are
+     *         closer than `RUSTY_KEYPAD_ANALOG_TOLERANCE`; the keys are read anyway.
+     */
+    static bool begin(uint8_t pin, const uint16_t *levels, uint16_t idle);
+
+    /**
+     * @brief Stops reading the analog pin; the keypad reads the pins again.
+     */
+    static void end();
+
+    /**
+     * @brief Checks if the keys are read from the analog pin.
+     */
+    static bool isRunning();
+
+    /**
+     * @brief Reads the analog pin, averaging `RUSTY_KEYPAD_ANALOG_OVERSAMPLING` readings.
+     */
+    static uint16_t read();
+
+    /**
+     * @brief Returns the key whose level is nearest to an ADC value.
+     *
+     * @return The key index, or `RKP_NO_KEY_INDEX` if the value is nearest to the idle level.
+     */
+    static RustyKeyIndex getKey(uint16_t value);
+
+    /**
+     * @brief Measures the level of a key, which has to be held down during the call.
+     *
+     * Takes `RUSTY_KEYPAD_ANALOG_CALIBRATION_SAMPLES` samples, which blocks for a few milliseconds.
+     * The measured level replaces the level of the key, and `getLevels()` returns the table to store.
+     *
+     * @param index The key index, `row * getColCount() + col`.
+     * @return false, keeping the old level, if the samples spread too much or the level is too close
+     *         to the idle level or to the level of another key.
+     */
+    static bool calibrateKey(RustyKeyIndex index);
+
+    /**
+     * @brief Measures the idle level, with all keys released during the call.
+     *
+     * @return false, keeping the old level, if the samples spread too much or the level is too close
+     *         to the level of a key.
+     */
+    static bool calibrateIdle();
+
+    /**
+     * @brief Returns the level of every key, in the order of the layout.
+     */
+    static const uint16_t *getLevels();
+
+    /**
+     * @brief Returns the level read while no key is pressed.
+     */
+    static uint16_t getIdleLevel();
+
+    /**
+     * @brief Returns the value read by the last scan.
+     */
+    static uint16_t getLastValue();
+
+    /**
+     * @brief Returns the key passed on by the last scan, or `RKP_NO_KEY_INDEX`.
+     */
+    static RustyKeyIndex getCurrentKey();
+
+private:
+    /**
+     * @brief Reads the pin into the keypad; set as `sampleSource`.
+     */
+    static void sample(RustyRowBits *rows, uint8_t row_count);
+
+    /**
+     * @brief Reads the analog pin like `read()` and returns the spread of the readings.
+     */
+    static uint16_t read(uint16_t &spread);
+
+    /**
+     * @brief Finds the band of the sorted levels a value falls into with a binary search.
+     */
+    static uint8_t findBand(uint16_t value);
+
+    /**
+     * @brief Checks if a value is settled at the level of its band.
+     */
+    static bool isSettled(uint8_t band, uint16_t value);
+
+    /**
+     * @brief Takes the calibration samples.
+     *
+     * @return The average, or `RKP_ANALOG_NO_LEVEL` if the samples spread more than
+     *         `RUSTY_KEYPAD_ANALOG_TOLERANCE`.
+     */
+    static uint16_t measure();
+
+    /**
+     * @brief Checks that a level is at least `RUSTY_KEYPAD_ANALOG_TOLERANCE` away from the idle level
+     *        and the levels of the other keys.
+     *
+     * @param level The level to check.
+     * @param index The key the level is for, or `RKP_NO_KEY_INDEX` for the idle level.
+     */
+    static bool isSeparate(uint16_t level, RustyKeyIndex index);
+
+    /**
+     * @brief Sorts the levels and computes the thresholds halfway between them.
+     */
+    static void buildThresholds();
+
+    static uint8_t analog_pin;
+    static bool running;
+    static uint8_t key_count;
+    static uint8_t band_count;
+    static uint16_t key_levels[RUSTY_KEYPAD_ANALOG_MAX_KEYS];
+    static uint16_t idle_level;
+    static uint16_t thresholds[RUSTY_KEYPAD_ANALOG_MAX_KEYS];
+    static uint16_t band_levels[RUSTY_KEYPAD_ANALOG_MAX_KEYS + 1];
+    static RustyKeyIndex band_keys[RUSTY_KEYPAD_ANALOG_MAX_KEYS + 1];
+    static uint16_t last_value;
+    static RustyKeyIndex stable_key;
+    static RustyKeyIndex candidate_key;
+    static uint8_t candidate_count;
+};
+
+#endif
@@ -0,0 +1,289 @@
+#include <rusty_buzzer.h>
+
+/*
+ * The whole step change, output included, runs under the lock: the timer can't
+ * start a step while stop() or a new pattern is silencing or starting the
+ * buzzer. On the ESP32 the lock is a mutex because the callback runs in the
+ * esp_timer task and tone() talks to a task of its own; on AVR it keeps the
+ * compare interrupt out. Other boards only change steps from the loop.
+ */
+#if defined(RUSTY_BUZZER_ESP_TIMER)
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+static esp_timer_handle_t buzzer_timer{nullptr};
+static SemaphoreHandle_t buzzer_mutex{nullptr};
+#define RUSTY_BUZZER_LOCK() xSemaphoreTake(buzzer_mutex, portMAX_DELAY)
+#define RUSTY_BUZZER_UNLOCK() xSemaphoreGive(buzzer_mutex)
+#elif defined(RUSTY_BUZZER_AVR_TIMER)
+#define RUSTY_BUZZER_LOCK() \
+    uint8_t buzzer_sreg = SREG; \
+    cli()
+#define RUSTY_BUZZER_UNLOCK() SREG = buzzer_sreg
+#else
+#define RUSTY_BUZZER_LOCK()
+#define RUSTY_BUZZER_UNLOCK()
+#endif
+
+RustyBuzzer::Entry RustyBuzzer::queue[RUSTY_KEYPAD_BUZZER_QUEUE_SIZE + 1];
+uint8_t RustyBuzzer::queue_length{0};
+uint16_t RustyBuzzer::step_index{0};
+uint8_t RustyBuzzer::pin{0};
+uint16_t RustyBuzzer::beep_frequency{0};
+bool RustyBuzzer::enabled{false};
+bool RustyBuzzer::waiting{false};
+unsigned long RustyBuzzer::next_change_ts{0};
+
+void RustyBuzzer::begin(uint8_t buzzer_pin, uint16_t frequency)
+{
+    stop();
+    pin = buzzer_pin;
+    beep_frequency = frequency;
+    pinMode(pin, OUTPUT);
+    digitalWrite(pin, LOW);
+#if defined(RUSTY_BUZZER_ESP_TIMER)
+    if (buzzer_mutex == nullptr)
+    {
+        buzzer_mutex = xSemaphoreCreateMutex();
+    }
+    if (buzzer_timer == nullptr)
+    {
+        esp_timer_create_args_t args = {};
+        args.callback = &RustyBuzzer::onTimer;
+        args.name = "rusty_buzzer";
+        esp_timer_create(&args, &buzzer_timer);
+    }
+#elif defined(RUSTY_BUZZER_AVR_TIMER)
+    TIMSK0 |= _BV(OCIE0B);
+#endif
+    enabled = true;
+}
+
+void RustyBuzzer::end()
+{
+    if (!enabled)
+    {
+        return;
+    }
+    stop();
+#if defined(RUSTY_BUZZER_ESP_TIMER)
+    esp_timer_delete(buzzer_timer);
+    buzzer_timer = nullptr;
+#elif defined(RUSTY_BUZZER_AVR_TIMER)
+    TIMSK0 &= ~_BV(OCIE0B);
+#endif
+    enabled = false;
+}
+
+bool RustyBuzzer::isEnabled()
+{
+    return enabled;
+}
+
+bool RustyBuzzer::beep(uint8_t count, uint16_t duration)
+{
+    Entry entry = {nullptr, false, count, duration};
+    return push(entry);
+}
+
+bool RustyBuzzer::play(const RustyToneStep *steps)
+{
+    Entry entry = {steps, false, 0, 0};
+    return push(entry);
+}
+
+bool RustyBuzzer::play_P(const RustyToneStep *steps)
+{
+    Entry entry = {steps, true, 0, 0};
+    return push(entry);
+}
+
+void RustyBuzzer::stop()
+{
+    if (!enabled)
+    {
+        return;
+    }
+    RUSTY_BUZZER_LOCK();
+    queue_length = 0;
+    step_index = 0;
+    waiting = false;
+#if defined(RUSTY_BUZZER_ESP_TIMER)
+    esp_timer_stop(buzzer_timer);
+#endif
+    output(0, 0);
+    RUSTY_BUZZER_UNLOCK();
+}
+
+bool RustyBuzzer::isPlaying()
+{
+    return queue_length > 0;
+}
+
+void RustyBuzzer::update()
+{
+    if (enabled)
+    {
+        advanceIfDue();
+    }
+}
+
+bool RustyBuzzer::hasPendingUpdate()
+{
+#if defined(RUSTY_BUZZER_ESP_TIMER)
+    return false;
+#else
+    return waiting;
+#endif
+}
+
+unsigned long RustyBuzzer::getNextChange()
+{
+    return next_change_ts;
+}
+
+bool RustyBuzzer::push(const Entry &entry)
+{
+    if (!enabled)
+    {
+        return false;
+    }
+    RUSTY_BUZZER_LOCK();
+    if (queue_length > RUSTY_KEYPAD_BUZZER_QUEUE_SIZE)
+    {
+        RUSTY_BUZZER_UNLOCK();
+        return false;
+    }
+    queue[queue_length++] = entry;
+    if (!waiting)
+    {
+        advance();
+    }
+    RUSTY_BUZZER_UNLOCK();
+    return true;
+}
+
+bool RustyBuzzer::readStep(uint16_t index, RustyToneStep &step)
+{
+    const Entry &entry = queue[0];
+    if (entry.steps == nullptr)
+    {
+        if (index >= 2 * (uint16_t)entry.beep_count)
+        {
+            return false;
+        }
+        step.frequency = (index % 2 == 0 ? (beep_frequency == 0 ? 1 : beep_frequency) : 0);
+        step.duration = entry.beep_duration;
+        return true;
+    }
+    if (entry.progmem)
+    {
+        step.frequency = pgm_read_word(&entry.steps[index].frequency);
+        step.duration = pgm_read_word(&entry.steps[index].duration);
+    }
+    else
+    {
+        step = entry.steps[index];
+    }
+    return step.duration != 0;
+}
+
+void RustyBuzzer::advance()
+{
+    RustyToneStep step = {0, 0};
+    bool found = false;
+    while (queue_length > 0)
+    {
+        if (readStep(step_index, step))
+        {
+            step_index++;
+            found = true;
+            break;
+        }
+        for (uint8_t i = 1; i < queue_length; i++)
+        {
+            queue[i - 1] = queue[i];
+        }
+        queue_length--;
+        step_index = 0;
+    }
+    waiting = found;
+    if (!found)
+    {
+        output(0, 0);
+        return;
+    }
+    output(step.frequency, step.duration);
+    scheduleNext(step.duration);
+}
+
+void RustyBuzzer::advanceIfDue()
+{
+    RUSTY_BUZZER_LOCK();
+    if (waiting && (long)(millis() - next_change_ts) >= 0)
+    {
+        advance();
+    }
+    RUSTY_BUZZER_UNLOCK();
+}
+
+void RustyBuzzer::output(uint16_t frequency, uint16_t duration)
+{
+    if (beep_frequency == 0)
+    {
+        digitalWrite(pin, (frequency != 0 ? HIGH : LOW));
+    }
+    else if (frequency != 0)
+    {
+        tone(pin, frequency, duration);
+    }
+    else
+    {
+        noTone(pin);
+    }
+}
+
+void RustyBuzzer::scheduleNext(uint16_t duration)
+{
+    next_change_ts = millis() + duration;
+#if defined(RUSTY_BUZZER_ESP_TIMER)
+    esp_timer_stop(buzzer_timer);
+    esp_timer_start_once(buzzer_timer, (uint64_t)duration * 1000ULL);
+#endif
+}
+
+#if defined(RUSTY_BUZZER_ESP_TIMER)
+void RustyBuzzer::onTimer(void *)
+{
+    RUSTY_BUZZER_LOCK();
+    if (waiting)
+    {
+        // A callback that waited on the lock may belong to a step which was replaced meanwhile.
+        long remaining = (long)(next_change_ts - millis());
+        if (remaining > 0)
+        {
+            esp_timer_start_once(buzzer_timer, (uint64_t)remaining * 1000ULL);
+        }
+        else
+        {
+            advance();
+        }
+    }
+    RUSTY_BUZZER_UNLOCK();
+}
+#elif defined(RUSTY_BUZZER_AVR_TIMER)
+void RustyBuzzer::onTick()
+{
+    // tone() reprograms Timer2 and blocks the other interrupts too long, so a passive buzzer waits for scan().
+    if (enabled && beep_frequency == 0 && waiting && (long)(millis() - next_change_ts) >= 0)
+    {
+        advance();
+    }
+}
+
+ISR(TIMER0_COMPB_vect)
+{
+    RustyBuzzer::onTick();
+}
+#endif
@@ -0,0 +1,256 @@
+/*
+ * RustyBuzzer Class
+ *
+ * Author: Aras TAŞKIRAN
+ * Email: aras@arastaskiran.com
+ * Date: 2024-09-2024
+ *
+ * Description:
+ *
+ * The buzzer used to be toggled from inside the scan loop, so a slow loop made
+ * every beep longer and a second beep request was refused while the first one
+ * was still playing. Feedback is now queued as patterns of tones and rests which
+ * are played in the background: on the ESP32 a timer callback steps through the
+ * pattern, on AVR boards the Timer0 compare interrupt does, next to the `millis()`
+ * overflow it shares the timer with. Other boards start the next step from
+ * `RustyBuzzer::update()` in the sketch loop. Patterns can be kept in flash.
+ *
+ * License:
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUSTY_KEYPAD_BUZZER_H
+#define RUSTY_KEYPAD_BUZZER_H
+
+#include <stdint.h>
+#include <Arduino.h>
+
+/**
+ * @brief Number of patterns that can wait behind the pattern that is playing.
+ */
+#ifndef RUSTY_KEYPAD_BUZZER_QUEUE_SIZE
+#define RUSTY_KEYPAD_BUZZER_QUEUE_SIZE 4
+#endif
+
+/**
+ * @brief Set to 0 to step through the patterns from `RustyBuzzer::update()` only.
+ *
+ * On the ESP32 the steps are started by an `esp_timer`. On AVR boards the Timer0 compare B interrupt,
+ * which leaves the `millis()` overflow and `analogWrite()` untouched, steps an active buzzer; a passive
+ * buzzer is stepped by `scan()`, as `tone()` reprograms Timer2 and must not run in an interrupt. Without
+ * the timer the `TIMER0_COMPB` vector stays free for the application.
+ */
+#ifndef RUSTY_KEYPAD_BUZZER_TIMER
+#define RUSTY_KEYPAD_BUZZER_TIMER 1
+#endif
+
+#if defined(ESP32) && RUSTY_KEYPAD_BUZZER_TIMER
+#define RUSTY_BUZZER_ESP_TIMER
+#elif defined(__AVR__) && defined(OCIE0B) && RUSTY_KEYPAD_BUZZER_TIMER
+#define RUSTY_BUZZER_AVR_TIMER
+#endif
+
+/**
+ * @brief One step of a buzzer pattern.
+ *
+ * A pattern is an array of steps terminated by a step with a duration of 0. A frequency of 0 is a rest.
+ * Active buzzers, which are driven with a plain digital output, sound for any other frequency.
+ *
+ * @example
+ * const RustyToneStep success[] PROGMEM = {{2000, 80}, {0, 40}, {3000, 120}, {0, 0}};
+ */
+struct RustyToneStep
+{
+    uint16_t frequency; /**< Tone frequency in Hz, 0 for a rest. */
+    uint16_t duration;  /**< Step duration in milliseconds, 0 ends the pattern. */
+};
+
+/**
+ * @class RustyBuzzer
+ * @brief Plays queued buzzer patterns without depending on the scan rate.
+ */
+class RustyBuzzer
+{
+public:
+    /**
+     * @brief Configures the buzzer pin.
+     *
+     * @param pin       The pin the buzzer is connected to.
+     * @param frequency The frequency of the simple beeps in Hz. 0 drives an active buzzer with a digital
+     *                  output instead of `tone()`.
+     */
+    static void begin(uint8_t pin, uint16_t frequency = 0);
+
+    /**
+     * @brief Silences the buzzer, drops the queue and releases the timer.
+     */
+    static void end();
+
+    /**
+     * @brief Checks if the buzzer has been configured with `begin()`.
+     *
+     * @return true if the buzzer is enabled, otherwise false.
+     */
+    static bool isEnabled();
+
+    /**
+     * @brief Queues a number of simple beeps.
+     *
+     * Each beep sounds for `duration` milliseconds followed by a rest of the same length.
+     *
+     * @param count    The number of beeps.
+     * @param duration The duration of one beep in milliseconds.
+     * @return false if the queue is full, otherwise true.
+     */
+    static bool beep(uint8_t count, uint16_t duration);
+
+    /**
+     * @brief Queues a pattern stored in RAM.
+     *
+     * The pattern is not copied, it has to stay valid until it has been played.
+     *
+     * @param steps The pattern, terminated by a step with a duration of 0.
+     * @return false if the queue is full, otherwise true.
+     */
+    static bool play(const RustyToneStep *steps);
+
+    /**
+     * @brief Queues a pattern stored in flash (PROGMEM).
+     *
+     * @param steps The pattern, terminated by a step with a duration of 0.
+     * @return false if the queue is full, otherwise true.
+     */
+    static bool play_P(const RustyToneStep *steps);
+
+    /**
+     * @brief Silences the buzzer and drops the queued patterns.
+     */
+    static void stop();
+
+    /**
+     * @brief Checks if a pattern is playing or waiting in the queue.
+     *
+     * @return true if the buzzer is busy, otherwise false.
+     */
+    static bool isPlaying();
+
+    /**
+     * @brief Starts the next step when the current one is over.
+     *
+     * `scan()` calls it while a step is playing, except on the ESP32, where a timer starts the steps. It
+     * compares the time once, the tones themselves are timed by `tone()`. A sketch that stops scanning
+     * while a pattern plays calls it from `loop()`.
+     */
+    static void update();
+
+#if defined(RUSTY_BUZZER_AVR_TIMER)
+    /**
+     * @brief Starts the next step of an active buzzer; called by the Timer0 compare B interrupt.
+     */
+    static void onTick();
+#endif
+
+    /**
+     * @brief Checks if the loop has to be awake when the next step starts.
+     *
+     * The AVR timer doesn't run in the deeper sleep modes, so a step played from it counts as well.
+     *
+     * @return true if a step is playing and the next one isn't started by the ESP32 timer, otherwise false.
+     */
+    static bool hasPendingUpdate();
+
+    /**
+     * @brief Returns the time at which `update()` starts the next step.
+     *
+     * @return The time in milliseconds, comparable with `millis()`. Only meaningful if
+     *         `hasPendingUpdate()` is true.
+     */
+    static unsigned long getNextChange();
+
+private:
+    /**
+     * @brief A queued pattern.
+     *
+     * Simple beeps have no step array; they are generated from `beep_count` and `beep_duration`.
+     */
+    struct Entry
+    {
+        const RustyToneStep *steps; /**< The pattern, or nullptr for simple beeps. */
+        bool progmem;               /**< Whether `steps` points into flash. */
+        uint8_t beep_count;         /**< Number of simple beeps. */
+        uint16_t beep_duration;     /**< Duration of one simple beep. */
+    };
+
+    /**
+     * @brief Adds a pattern to the queue and starts it if the buzzer is silent.
+     *
+     * @return false if the queue is full, otherwise true.
+     */
+    static bool push(const Entry &entry);
+
+    /**
+     * @brief Reads a step of the current pattern.
+     *
+     * @param index The step index.
+     * @param step  Receives the step.
+     * @return false if the pattern has ended, otherwise true.
+     */
+    static bool readStep(uint16_t index, RustyToneStep &step);
+
+    /**
+     * @brief Starts the next step, moving on to the next queued pattern when the current one has ended.
+     *
+     * Called with the buzzer locked.
+     */
+    static void advance();
+
+    /**
+     * @brief Calls `advance()` if a step is playing and its time is over.
+     */
+    static void advanceIfDue();
+
+    /**
+     * @brief Sounds or silences the buzzer.
+     *
+     * @param frequency The frequency in Hz, 0 to silence the buzzer.
+     * @param duration  The duration of the tone in milliseconds.
+     */
+    static void output(uint16_t frequency, uint16_t duration);
+
+    /**
+     * @brief Schedules the next call of `advance()`.
+     *
+     * @param duration The time until the next step in milliseconds.
+     */
+    static void scheduleNext(uint16_t duration);
+
+#if defined(RUSTY_BUZZER_ESP_TIMER)
+    /**
+     * @brief Timer callback that starts the next step.
+     */
+    static void onTimer(void *);
+#endif
+
+    static Entry queue[RUSTY_KEYPAD_BUZZER_QUEUE_SIZE + 1]; /**< Slot 0 is the playing pattern. */
+    static uint8_t queue_length;                            /**< Patterns in the queue, including the playing one. */
+    static uint16_t step_index;                             /**< The next step of the playing pattern. */
+    static uint8_t pin;                                     /**< The buzzer pin. */
+    static uint16_t beep_frequency;                         /**< Frequency of simple beeps, 0 for an active buzzer. */
+    static bool enabled;                                    /**< Whether `begin()` has been called. */
+    static bool waiting;                                    /**< Whether a step is playing and `advance()` is pending. */
+    static unsigned long next_change_ts;                    /**< Start time of the next step. */
+};
+
+#endif
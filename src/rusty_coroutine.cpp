@@ -0,0 +1,176 @@
+#include <rusty_coroutine.h>
+
+#if defined(RUSTY_KEYPAD_HAS_COROUTINES)
+
+RustyAwaiter *RustyAwait::waiting[RUSTY_KEYPAD_MAX_AWAITERS]{};
+bool RustyAwait::frame_used[RUSTY_KEYPAD_COROUTINE_FRAMES]{};
+alignas(max_align_t) unsigned char RustyAwait::frames[RUSTY_KEYPAD_COROUTINE_FRAMES][RUSTY_KEYPAD_COROUTINE_FRAME_SIZE];
+
+void *RustyTask::promise_type::operator new(size_t size) noexcept
+{
+    return RustyAwait::allocateFrame(size);
+}
+
+void RustyTask::promise_type::operator delete(void *frame) noexcept
+{
+    RustyAwait::releaseFrame(frame);
+}
+
+RustyAwaiter::RustyAwaiter(RustyAwaiterKinds kind, unsigned long timeout)
+    : start_ts(0), timeout(timeout), kind(kind), ready(false), timed_out(false), key('\0')
+{
+}
+
+bool RustyAwaiter::await_suspend(std::coroutine_handle<> waiting_handle) noexcept
+{
+    handle = waiting_handle;
+    start_ts = millis();
+    return RustyAwait::add(this);
+}
+
+RustyKeyAwaiter RustyAwait::nextKey(unsigned long timeout)
+{
+    return RustyKeyAwaiter(timeout);
+}
+
+RustyLineAwaiter RustyAwait::readLine(unsigned long timeout)
+{
+    return RustyLineAwaiter(timeout);
+}
+
+RustyDelayAwaiter RustyAwait::delay(unsigned long duration)
+{
+    return RustyDelayAwaiter(duration);
+}
+
+uint8_t RustyAwait::getWaitingCount()
+{
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < RUSTY_KEYPAD_MAX_AWAITERS; i++)
+    {
+        if (waiting[i] != nullptr)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+bool RustyAwait::add(RustyAwaiter *awaiter)
+{
+    for (uint8_t i = 0; i < RUSTY_KEYPAD_MAX_AWAITERS; i++)
+    {
+        if (waiting[i] == nullptr)
+        {
+            waiting[i] = awaiter;
+            BaseRustyKeypad::notificationObserver = &RustyAwait::onNotification;
+            BaseRustyKeypad::scanObserver = &RustyAwait::onScan;
+            return true;
+        }
+    }
+    awaiter->timed_out = true;
+    return false;
+}
+
+void RustyAwait::resumeReady()
+{
+    std::coroutine_handle<> ready[RUSTY_KEYPAD_MAX_AWAITERS];
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < RUSTY_KEYPAD_MAX_AWAITERS; i++)
+    {
+        if (waiting[i] != nullptr && waiting[i]->ready)
+        {
+            ready[count++] = waiting[i]->handle;
+            waiting[i] = nullptr;
+        }
+    }
+    for (uint8_t i = 0; i < count; i++)
+    {
+        ready[i].resume();
+    }
+}
+
+void RustyAwait::onNotification(uint8_t type, char key, uint16_t, const char *text)
+{
+    for (uint8_t i = 0; i < RUSTY_KEYPAD_MAX_AWAITERS; i++)
+    {
+        RustyAwaiter *awaiter = waiting[i];
+        if (awaiter == nullptr || awaiter->ready)
+        {
+            continue;
+        }
+        if (awaiter->kind == RKP_AWAIT_KEY && type == RKP_NOTIFY_KEY_UP)
+        {
+            awaiter->key = key;
+        }
+        else if (awaiter->kind == RKP_AWAIT_LINE && type == RKP_NOTIFY_ENTER)
+        {
+            setLine(awaiter, true, text);
+        }
+        else
+        {
+            continue;
+        }
+        awaiter->ready = true;
+    }
+}
+
+void RustyAwait::onScan()
+{
+    unsigned long now = millis();
+    for (uint8_t i = 0; i < RUSTY_KEYPAD_MAX_AWAITERS; i++)
+    {
+        RustyAwaiter *awaiter = waiting[i];
+        if (awaiter == nullptr || awaiter->ready || awaiter->timeout == 0 || (now - awaiter->start_ts) < awaiter->timeout)
+        {
+            continue;
+        }
+        awaiter->timed_out = true;
+        if (awaiter->kind == RKP_AWAIT_LINE)
+        {
+            char text[RUSTY_KEYPAD_MAX_TEXT_LENGTH + 2];
+            setLine(awaiter, false, BaseRustyKeypad::getNotifyText(text, '\0'));
+        }
+        awaiter->ready = true;
+    }
+    resumeReady();
+}
+
+void RustyAwait::setLine(RustyAwaiter *awaiter, bool entered, const char *text)
+{
+    RustyLine &line = static_cast<RustyLineAwaiter *>(awaiter)->line;
+    strncpy(line.text, text, RUSTY_KEYPAD_MAX_TEXT_LENGTH);
+    line.text[RUSTY_KEYPAD_MAX_TEXT_LENGTH] = '\0';
+    line.entered = entered;
+}
+
+void *RustyAwait::allocateFrame(size_t size)
+{
+    if (size > RUSTY_KEYPAD_COROUTINE_FRAME_SIZE)
+    {
+        return nullptr;
+    }
+    for (uint8_t i = 0; i < RUSTY_KEYPAD_COROUTINE_FRAMES; i++)
+    {
+        if (!frame_used[i])
+        {
+            frame_used[i] = true;
+            return frames[i];
+        }
+    }
+    return nullptr;
+}
+
+void RustyAwait::releaseFrame(void *frame)
+{
+    for (uint8_t i = 0; i < RUSTY_KEYPAD_COROUTINE_FRAMES; i++)
+    {
+        if (frame == frames[i])
+        {
+            frame_used[i] = false;
+            return;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,299 @@
+/*
+ * RustyAwait Class
+ *
+ * Author: Aras TAŞKIRAN
+ * Email: aras@arastaskiran.com
+ * Date: 2024-09-2024
+ *
+ * Description:
+ *
+ * Asking for a user ID and then for a PIN with listeners ends up as a state
+ * machine spread over several callbacks and globals. With a C++20 compiler (the
+ * ESP32 cores and the PC build) such a flow can be written top to bottom as a
+ * coroutine instead:
+ *
+ *     RustyTask login()
+ *     {
+ *         RustyLine id = co_await RustyAwait::readLine(10000);
+ *         if (!id.entered)
+ *             co_return;
+ *         RustyLine pin = co_await RustyAwait::readLine(10000);
+ *         ...
+ *     }
+ *
+ * The coroutines are resumed by scan() (or RustyScanTask::dispatch()), in the
+ * task that calls it. Their frames come from a small static pool, so no heap is
+ * used; when the pool is exhausted the coroutine simply doesn't start.
+ *
+ * License:
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUSTY_KEYPAD_COROUTINE_H
+#define RUSTY_KEYPAD_COROUTINE_H
+
+#if __cplusplus >= 202002L
+#if __has_include(<coroutine>)
+#define RUSTY_KEYPAD_HAS_COROUTINES
+#endif
+#endif
+
+#if defined(RUSTY_KEYPAD_HAS_COROUTINES)
+
+#include <coroutine>
+#include <stddef.h>
+#include <base_keypad.h>
+
+/**
+ * @brief Number of coroutines that can run at the same time.
+ */
+#ifndef RUSTY_KEYPAD_COROUTINE_FRAMES
+#define RUSTY_KEYPAD_COROUTINE_FRAMES 2
+#endif
+
+/**
+ * @brief Size of one coroutine frame in bytes.
+ *
+ * The frame holds the local variables of the coroutine that live across a `co_await`. A coroutine
+ * whose frame doesn't fit doesn't start.
+ */
+#ifndef RUSTY_KEYPAD_COROUTINE_FRAME_SIZE
+#define RUSTY_KEYPAD_COROUTINE_FRAME_SIZE 384
+#endif
+
+/**
+ * @brief Number of `co_await` operations that can wait at the same time.
+ */
+#ifndef RUSTY_KEYPAD_MAX_AWAITERS
+#define RUSTY_KEYPAD_MAX_AWAITERS 4
+#endif
+
+/**
+ * @brief What an awaitable waits for.
+ */
+typedef enum RustyAwaiterKinds
+{
+    /** The next released key, see `RustyAwait::nextKey()`. */
+    RKP_AWAIT_KEY,
+
+    /** The enter key, see `RustyAwait::readLine()`. */
+    RKP_AWAIT_LINE,
+
+    /** The end of a delay, see `RustyAwait::delay()`. */
+    RKP_AWAIT_DELAY
+
+} RustyAwaiterKinds;
+
+/**
+ * @brief The result of `RustyAwait::readLine()`.
+ */
+struct RustyLine
+{
+    bool entered;                                /**< true if the enter key was pressed, false on timeout. */
+    char text[RUSTY_KEYPAD_MAX_TEXT_LENGTH + 1]; /**< The entered text, or the text typed so far. */
+};
+
+/**
+ * @class RustyTask
+ * @brief The return type of keypad coroutines.
+ *
+ * A `RustyTask` starts running as soon as it is called and cleans up after itself when it finishes.
+ * It doesn't have to be stored.
+ */
+class RustyTask
+{
+public:
+    struct promise_type
+    {
+        RustyTask get_return_object() noexcept { return RustyTask(true); }
+        static RustyTask get_return_object_on_allocation_failure() noexcept { return RustyTask(false); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept {}
+        static void *operator new(size_t size) noexcept;
+        static void operator delete(void *frame) noexcept;
+    };
+
+    /**
+     * @brief Checks if the coroutine could be started.
+     *
+     * @return false if no frame was free in the pool, otherwise true.
+     */
+    bool isStarted() const { return started; }
+
+private:
+    explicit RustyTask(bool started) : started(started) {}
+    bool started;
+};
+
+/**
+ * @class RustyAwaiter
+ * @brief Common part of the keypad awaitables; registers the waiting coroutine.
+ */
+class RustyAwaiter
+{
+    friend class RustyAwait;
+
+public:
+    bool await_ready() const noexcept { return kind == RKP_AWAIT_DELAY && timeout == 0; }
+    bool await_suspend(std::coroutine_handle<> waiting) noexcept;
+
+protected:
+    RustyAwaiter(RustyAwaiterKinds kind, unsigned long timeout);
+
+    std::coroutine_handle<> handle;
+    unsigned long start_ts;
+    unsigned long timeout;
+    RustyAwaiterKinds kind;
+    bool ready;
+    bool timed_out;
+    char key;
+};
+
+/**
+ * @brief Awaitable returned by `RustyAwait::nextKey()`; resumes with the key, or '\0' on timeout.
+ */
+class RustyKeyAwaiter : public RustyAwaiter
+{
+public:
+    explicit RustyKeyAwaiter(unsigned long timeout) : RustyAwaiter(RKP_AWAIT_KEY, timeout) {}
+    char await_resume() const noexcept { return key; }
+};
+
+/**
+ * @brief Awaitable returned by `RustyAwait::readLine()`; resumes with the line.
+ */
+class RustyLineAwaiter : public RustyAwaiter
+{
+    friend class RustyAwait;
+
+public:
+    explicit RustyLineAwaiter(unsigned long timeout) : RustyAwaiter(RKP_AWAIT_LINE, timeout)
+    {
+        line.entered = false;
+        line.text[0] = '\0';
+    }
+    RustyLine await_resume() const noexcept { return line; }
+
+private:
+    RustyLine line;
+};
+
+/**
+ * @brief Awaitable returned by `RustyAwait::delay()`.
+ */
+class RustyDelayAwaiter : public RustyAwaiter
+{
+public:
+    explicit RustyDelayAwaiter(unsigned long duration) : RustyAwaiter(RKP_AWAIT_DELAY, duration) {}
+    void await_resume() const noexcept {}
+};
+
+/**
+ * @class RustyAwait
+ * @brief Awaitable keypad operations for coroutines.
+ */
+class RustyAwait
+{
+    friend class RustyAwaiter;
+    friend struct RustyTask::promise_type;
+
+public:
+    /**
+     * @brief Waits for the next released key.
+     *
+     * @param timeout The longest wait in milliseconds, 0 waits forever.
+     * @return An awaitable that resumes with the key code, or '\0' on timeout.
+     */
+    static RustyKeyAwaiter nextKey(unsigned long timeout = 0);
+
+    /**
+     * @brief Waits until the enter key is pressed.
+     *
+     * @param timeout The longest wait in milliseconds, 0 waits forever.
+     * @return An awaitable that resumes with the entered line. On timeout `entered` is false and
+     *         `text` holds what has been typed so far.
+     */
+    static RustyLineAwaiter readLine(unsigned long timeout = 0);
+
+    /**
+     * @brief Waits for the given time while the keypad keeps working.
+     *
+     * @param duration The time in milliseconds.
+     * @return An awaitable that resumes after the time has passed.
+     */
+    static RustyDelayAwaiter delay(unsigned long duration);
+
+    /**
+     * @brief Returns the number of coroutines waiting in a `co_await`.
+     *
+     * @return The number of waiting coroutines.
+     */
+    static uint8_t getWaitingCount();
+
+private:
+    /**
+     * @brief Registers a waiting awaitable and installs the keypad hooks.
+     *
+     * @return false if all slots are in use, otherwise true.
+     */
+    static bool add(RustyAwaiter *awaiter);
+
+    /**
+     * @brief Resumes the awaitables marked as ready.
+     */
+    static void resumeReady();
+
+    /**
+     * @brief Marks the awaitables that wait for a notification as ready.
+     *
+     * The notification may come from the middle of `scan()`, so the coroutines are not resumed here but
+     * by the next `onScan()`.
+     */
+    static void onNotification(uint8_t type, char key, uint16_t, const char *text);
+
+    /**
+     * @brief Marks the awaitables whose timeout has passed as ready and resumes the ready ones.
+     *
+     * Called at the start and at the end of `scan()`, or after each notification delivered by
+     * `RustyScanTask::dispatch()`, when the keypad state is consistent.
+     */
+    static void onScan();
+
+    /**
+     * @brief Copies a text into the line of a line awaitable.
+     */
+    static void setLine(RustyAwaiter *awaiter, bool entered, const char *text);
+
+    /**
+     * @brief Takes a frame from the pool.
+     *
+     * @return The frame, or nullptr if the pool is exhausted or the frame is too large.
+     */
+    static void *allocateFrame(size_t size);
+
+    /**
+     * @brief Returns a frame to the pool.
+     */
+    static void releaseFrame(void *frame);
+
+    static RustyAwaiter *waiting[RUSTY_KEYPAD_MAX_AWAITERS];
+    static bool frame_used[RUSTY_KEYPAD_COROUTINE_FRAMES];
+    alignas(max_align_t) static unsigned char frames[RUSTY_KEYPAD_COROUTINE_FRAMES][RUSTY_KEYPAD_COROUTINE_FRAME_SIZE];
+};
+
+#endif
+#endif
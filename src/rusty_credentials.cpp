@@ -0,0 +1,75 @@
+#include <rusty_credentials.h>
+
+#define RUSTY_FNV_OFFSET 2166136261UL
+#define RUSTY_FNV_PRIME 16777619UL
+
+uint32_t RustyCredentials::seed(uint32_t salt)
+{
+    uint32_t state = RUSTY_FNV_OFFSET;
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        state = step(state, (char)(salt >> (8 * i)));
+    }
+    return state;
+}
+
+uint32_t RustyCredentials::step(uint32_t state, char c)
+{
+    state ^= (uint8_t)c;
+    return state * RUSTY_FNV_PRIME;
+}
+
+uint32_t RustyCredentials::finish(uint32_t state)
+{
+    state ^= state >> 16;
+    state *= 0x85ebca6bUL;
+    state ^= state >> 13;
+    state *= 0xc2b2ae35UL;
+    state ^= state >> 16;
+    return state == 0 ? 1 : state;
+}
+
+uint32_t RustyCredentials::hash(uint32_t salt, const char *text)
+{
+    uint32_t state = seed(salt);
+    while (*text != '\0')
+    {
+        state = step(state, *text++);
+    }
+    return finish(state);
+}
+
+uint16_t RustyCredentials::find(const RustyCredentialTable *table, uint32_t hash)
+{
+    if (table == nullptr || table->slot_count == 0)
+    {
+        return RKP_CREDENTIAL_NONE;
+    }
+    uint16_t mask = table->slot_count - 1;
+    uint16_t slot = hash & mask;
+    uint16_t found = RKP_CREDENTIAL_NONE;
+    bool open = true;
+    uint16_t probes = (table->slot_count < RUSTY_KEYPAD_CREDENTIAL_PROBES ? table->slot_count
+                                                                          : RUSTY_KEYPAD_CREDENTIAL_PROBES);
+    for (uint16_t probe = 0; probe < probes; probe++)
+    {
+        uint32_t stored = pgm_read_dword(&table->hashes[slot]);
+        uint16_t id = pgm_read_word(&table->ids[slot]);
+        open = open && (stored != 0);
+        bool match = open && isEqual(stored, hash) && found == RKP_CREDENTIAL_NONE;
+        found = match ? id : found;
+        slot = (slot + 1) & mask;
+    }
+    return found;
+}
+
+bool RustyCredentials::isEqual(uint32_t a, uint32_t b)
+{
+    uint32_t diff = a ^ b;
+    uint8_t folded = 0;
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        folded |= (uint8_t)(diff >> (8 * i));
+    }
+    return folded == 0;
+}
@@ -0,0 +1,142 @@
+/*
+ * RustyCredentials Class
+ *
+ * Author: Aras TAŞKIRAN
+ * Email: aras@arastaskiran.com
+ * Date: 2024-09-2024
+ *
+ * Description:
+ *
+ * Checking a PIN against a single String is fine for a toy lock, but a door
+ * controller has to know hundreds of users. The PINs are stored here as salted
+ * hashes in an open addressing table that lives in flash, so the entered code is
+ * found with one or two probes and no plaintext PIN ever sits in RAM.
+ * The tables are generated on the PC with extras/tools/rusty_credentials.py.
+ *
+ * Keep in mind that a short PIN has few combinations; the hash keeps the PINs
+ * unreadable in a memory dump, it doesn't replace a lockout after wrong attempts.
+ *
+ * License:
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUSTY_KEYPAD_CREDENTIALS_H
+#define RUSTY_KEYPAD_CREDENTIALS_H
+
+#include <stdint.h>
+#include <Arduino.h>
+
+/**
+ * @brief Identifier reported when the entered code doesn't match any credential.
+ */
+#define RKP_CREDENTIAL_NONE 0xFFFF
+
+/**
+ * @brief The number of slots a lookup reads, starting at the slot selected by the hash.
+ *
+ * `extras/tools/rusty_credentials.py` places every PIN within this many slots of its first slot, growing
+ * the table when a probe chain would be longer; its `--probes` must not be larger than this value.
+ */
+#ifndef RUSTY_KEYPAD_CREDENTIAL_PROBES
+#define RUSTY_KEYPAD_CREDENTIAL_PROBES 4
+#endif
+
+/**
+ * @brief Describes a credential table stored in flash.
+ *
+ * The table is an open addressing hash table with linear probing. Each slot holds the salted hash
+ * of one PIN and the identifier of its owner; empty slots hold a hash of 0. `slot_count` must be a
+ * power of two, and every PIN must sit within `RUSTY_KEYPAD_CREDENTIAL_PROBES` slots of its first slot.
+ *
+ * @note Don't fill these tables by hand, generate them with `extras/tools/rusty_credentials.py`.
+ */
+struct RustyCredentialTable
+{
+    uint32_t salt;          /**< Salt mixed into every hash of this table. */
+    uint16_t slot_count;    /**< Number of slots, a power of two. */
+    const uint32_t *hashes; /**< Slot hashes, stored in PROGMEM. */
+    const uint16_t *ids;    /**< Slot owner identifiers, stored in PROGMEM. */
+};
+
+/**
+ * @class RustyCredentials
+ * @brief Hashing and lookup helpers for `RustyCredentialTable`.
+ *
+ * The hash is FNV-1a seeded with the salt and finished with the MurmurHash3 mixer. Since FNV-1a
+ * consumes one character at a time, the keypad updates the hash as digits arrive and only the
+ * final mix and the table probe are left for the moment the enter key is pressed.
+ */
+class RustyCredentials
+{
+public:
+    /**
+     * @brief Starts a new hash for the given salt.
+     *
+     * @param salt The salt of the credential table.
+     * @return The initial hash state.
+     */
+    static uint32_t seed(uint32_t salt);
+
+    /**
+     * @brief Adds one character to a hash state.
+     *
+     * @param state The current hash state.
+     * @param c     The character to add.
+     * @return The new hash state.
+     */
+    static uint32_t step(uint32_t state, char c);
+
+    /**
+     * @brief Finishes a hash state into the value stored in the table.
+     *
+     * The result is never 0, since 0 marks an empty slot.
+     *
+     * @param state The hash state after the last character.
+     * @return The final hash.
+     */
+    static uint32_t finish(uint32_t state);
+
+    /**
+     * @brief Hashes a complete code in one call.
+     *
+     * @param salt The salt of the credential table.
+     * @param text The null-terminated code.
+     * @return The final hash, as stored in the table.
+     */
+    static uint32_t hash(uint32_t salt, const char *text);
+
+    /**
+     * @brief Looks up a final hash in the table.
+     *
+     * The probe starts at the slot selected by the low bits of the hash and matches up to the first
+     * empty slot, but always reads `RUSTY_KEYPAD_CREDENTIAL_PROBES` slots and compares the hashes without
+     * early exit, so the time taken doesn't tell whether the code matched or how far its slot was.
+     *
+     * @param table The credential table.
+     * @param hash  The final hash of the entered code.
+     * @return The identifier of the matching credential, or `RKP_CREDENTIAL_NONE`.
+     */
+    static uint16_t find(const RustyCredentialTable *table, uint32_t hash);
+
+private:
+    /**
+     * @brief Compares two hashes in constant time.
+     *
+     * @return true if the hashes are equal, otherwise false.
+     */
+    static bool isEqual(uint32_t a, uint32_t b);
+};
+
+#endif
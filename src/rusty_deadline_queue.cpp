@@ -0,0 +1,109 @@
+#include <base_keypad.h>
+
+RustyDeadlineQueue::RustyDeadlineQueue()
+{
+    size = 0;
+    memset(slots, 0xFF, sizeof(slots));
+}
+
+void RustyDeadlineQueue::schedule(RustyKeyIndex index, unsigned long deadline)
+{
+    RustyKeyIndex slot = slots[index];
+    if (slot == RKP_NO_QUEUE_SLOT)
+    {
+        if (size >= RUSTY_KEYPAD_MAX_KEYS)
+        {
+            return;
+        }
+        slot = size++;
+    }
+    Entry entry = {deadline, index};
+    place(slot, entry);
+    siftUp(slot);
+    siftDown(slots[index]);
+}
+
+void RustyDeadlineQueue::cancel(RustyKeyIndex index)
+{
+    RustyKeyIndex slot = slots[index];
+    if (slot == RKP_NO_QUEUE_SLOT)
+    {
+        return;
+    }
+    slots[index] = RKP_NO_QUEUE_SLOT;
+    size--;
+    if (slot == size)
+    {
+        return;
+    }
+    place(slot, items[size]);
+    siftUp(slot);
+    siftDown(slots[items[slot].index]);
+}
+
+bool RustyDeadlineQueue::isDue(RustyKeyIndex index, unsigned long now) const
+{
+    RustyKeyIndex slot = slots[index];
+    return (slot != RKP_NO_QUEUE_SLOT && (long)(now - items[slot].deadline) >= 0);
+}
+
+bool RustyDeadlineQueue::isEmpty() const
+{
+    return size == 0;
+}
+
+unsigned long RustyDeadlineQueue::getNextDeadline() const
+{
+    return items[0].deadline;
+}
+
+bool RustyDeadlineQueue::isEarlier(const Entry &a, const Entry &b)
+{
+    return (long)(a.deadline - b.deadline) < 0;
+}
+
+void RustyDeadlineQueue::place(RustyKeyIndex slot, const Entry &entry)
+{
+    items[slot] = entry;
+    slots[entry.index] = slot;
+}
+
+void RustyDeadlineQueue::siftUp(RustyKeyIndex slot)
+{
+    Entry entry = items[slot];
+    while (slot > 0)
+    {
+        RustyKeyIndex parent = (slot - 1) / 2;
+        if (!isEarlier(entry, items[parent]))
+        {
+            break;
+        }
+        place(slot, items[parent]);
+        slot = parent;
+    }
+    place(slot, entry);
+}
+
+void RustyDeadlineQueue::siftDown(RustyKeyIndex slot)
+{
+    Entry entry = items[slot];
+    while (true)
+    {
+        uint16_t child = 2 * slot + 1;
+        if (child >= size)
+        {
+            break;
+        }
+        if (child + 1 < size && isEarlier(items[child + 1], items[child]))
+        {
+            child++;
+        }
+        if (!isEarlier(items[child], entry))
+        {
+            break;
+        }
+        place(slot, items[child]);
+        slot = child;
+    }
+    place(slot, entry);
+}
@@ -0,0 +1,141 @@
+/*
+ * RustyDeadlineQueue Class
+ *
+ * Author: Aras TAŞKIRAN
+ * Email: aras@arastaskiran.com
+ * Date: 2024-09-2024
+ *
+ * Description:
+ *
+ * Every pressed key used to ask the clock on every scan whether one of its
+ * timeouts (T9 commit, key-up timeout, long press, clear screen) had expired.
+ * Now each key calculates its next deadline when its event changes and is kept
+ * in this small min-heap. A key only looks at its timeouts once its deadline
+ * has passed, and the earliest deadline tells how long nothing can happen.
+ *
+ * License:
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUSTY_KEYPAD_DEADLINE_QUEUE_H
+#define RUSTY_KEYPAD_DEADLINE_QUEUE_H
+
+#include <stdint.h>
+#include <rusty_key.h>
+
+/**
+ * @class RustyDeadlineQueue
+ * @brief A fixed capacity min-heap of keys ordered by their next deadline.
+ *
+ * The capacity is one entry per key of the largest supported matrix, `RUSTY_KEYPAD_MAX_KEYS`.
+ *
+ * The deadlines are kept here only, in full `millis()` values compared with wrap-around safe
+ * arithmetic; an entry names its key by the key index. The queue also remembers the heap position of
+ * every key index, so rescheduling, removing or looking up a key doesn't need a search.
+ *
+ * A key stays in the queue after its deadline has passed, until its next event schedules a new
+ * deadline or cancels it. Until then `isDue` is true and the key evaluates its timeouts on every scan.
+ */
+class RustyDeadlineQueue
+{
+public:
+    /**
+     * @brief Constructs an empty queue.
+     */
+    RustyDeadlineQueue();
+
+    /**
+     * @brief Adds a key to the queue or moves it to the position of its new deadline.
+     *
+     * @param index    The index of the key, less than `RUSTY_KEYPAD_MAX_KEYS`.
+     * @param deadline The deadline in milliseconds, comparable with `millis()`.
+     */
+    void schedule(RustyKeyIndex index, unsigned long deadline);
+
+    /**
+     * @brief Removes a key from the queue, if it is queued.
+     *
+     * @param index The index of the key.
+     */
+    void cancel(RustyKeyIndex index);
+
+    /**
+     * @brief Checks if a key is queued and its deadline has passed.
+     *
+     * @param index The index of the key.
+     * @param now   The current time in milliseconds, only read if the key is queued.
+     * @return true if the key has to evaluate its timeouts, otherwise false.
+     */
+    bool isDue(RustyKeyIndex index, unsigned long now) const;
+
+    /**
+     * @brief Checks if any key is waiting for a deadline.
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief Returns the earliest deadline in the queue.
+     *
+     * @note Only meaningful when the queue is not empty.
+     */
+    unsigned long getNextDeadline() const;
+
+private:
+    /**
+     * @brief A queued key: its deadline in full and its key index.
+     */
+    struct Entry
+    {
+        unsigned long deadline;
+        RustyKeyIndex index;
+    };
+
+    /**
+     * @brief The heap, with the earliest deadline at index 0.
+     */
+    Entry items[RUSTY_KEYPAD_MAX_KEYS];
+
+    /**
+     * @brief Position of every key index in the heap, or `RKP_NO_QUEUE_SLOT`.
+     */
+    RustyKeyIndex slots[RUSTY_KEYPAD_MAX_KEYS];
+
+    /**
+     * @brief Number of keys in the heap.
+     */
+    RustyKeyIndex size;
+
+    /**
+     * @brief Checks if the deadline of entry `a` comes before the deadline of entry `b`.
+     */
+    static bool isEarlier(const Entry &a, const Entry &b);
+
+    /**
+     * @brief Places an entry at a heap position and records the position of its key.
+     */
+    void place(RustyKeyIndex slot, const Entry &entry);
+
+    /**
+     * @brief Moves the entry at the given position towards the root while it is earlier than its parent.
+     */
+    void siftUp(RustyKeyIndex slot);
+
+    /**
+     * @brief Moves the entry at the given position towards the leaves while a child is earlier.
+     */
+    void siftDown(RustyKeyIndex slot);
+};
+
+#endif
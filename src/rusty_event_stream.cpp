@@ -0,0 +1,144 @@
+#include <rusty_event_stream.h>
+
+Print *RustyEventStream::output{nullptr};
+uint8_t RustyEventStream::frame[RUSTY_KEYPAD_STREAM_FRAME_SIZE];
+uint8_t RustyEventStream::length{0};
+uint8_t RustyEventStream::sequence{0};
+uint16_t RustyEventStream::flush_interval{0};
+unsigned long RustyEventStream::frame_ts{0};
+
+void RustyEventStream::begin(Print &out, uint16_t interval)
+{
+    end();
+    output = &out;
+    flush_interval = interval;
+    length = 0;
+    sequence = 0;
+    BaseRustyKeypad::notificationStream = &RustyEventStream::onNotification;
+    BaseRustyKeypad::streamUpdate = &RustyEventStream::update;
+}
+
+void RustyEventStream::end()
+{
+    if (output == nullptr)
+    {
+        return;
+    }
+    flush();
+    BaseRustyKeypad::notificationStream = NULL;
+    BaseRustyKeypad::streamUpdate = NULL;
+    output = nullptr;
+}
+
+void RustyEventStream::flush()
+{
+    if (output == nullptr || length == 0)
+    {
+        return;
+    }
+    uint8_t header[4] = {length, sequence, (uint8_t)frame_ts, (uint8_t)(frame_ts >> 8)};
+    uint16_t crc = 0xFFFF;
+    for (uint8_t i = 0; i < sizeof(header); i++)
+    {
+        crc = crc16(crc, header[i]);
+    }
+    for (uint8_t i = 0; i < length; i++)
+    {
+        crc = crc16(crc, frame[i]);
+    }
+    output->write((uint8_t)RUSTY_KEYPAD_STREAM_SYNC);
+    output->write(header, sizeof(header));
+    output->write(frame, length);
+    output->write((uint8_t)crc);
+    output->write((uint8_t)(crc >> 8));
+    sequence++;
+    length = 0;
+}
+
+void RustyEventStream::update()
+{
+    if (length > 0 && (millis() - frame_ts) >= flush_interval)
+    {
+        flush();
+    }
+}
+
+bool RustyEventStream::isStreaming()
+{
+    return output != nullptr;
+}
+
+uint8_t RustyEventStream::getSequence()
+{
+    return sequence;
+}
+
+void RustyEventStream::onNotification(uint8_t type, char key, uint16_t value, const char *text)
+{
+    uint8_t size = (uint8_t)strlen(text);
+    uint8_t data[3];
+    switch (type)
+    {
+    case RKP_NOTIFY_TEXT_CHANGE:
+        data[0] = (uint8_t)value;
+        data[1] = size;
+        data[2] = (uint8_t)(size > 0 ? text[size - 1] : '\0');
+        add(type, data, 3);
+        break;
+    case RKP_NOTIFY_MULTIPLE_KEYS:
+        data[0] = size;
+        data[1] = (uint8_t)(size > 0 ? text[0] : '\0');
+        data[2] = (uint8_t)(size > 1 ? text[1] : '\0');
+        add(type, data, 3);
+        break;
+    case RKP_NOTIFY_ENTER:
+        data[0] = size;
+        add(type, data, 1);
+        break;
+    case RKP_NOTIFY_CREDENTIAL:
+        data[0] = (uint8_t)value;
+        data[1] = (uint8_t)(value >> 8);
+        add(type, data, 2);
+        break;
+    case RKP_NOTIFY_FAULT:
+        data[0] = (uint8_t)key;
+        data[1] = (uint8_t)value;
+        data[2] = (uint8_t)(value >> 8);
+        add(type, data, 3);
+        break;
+    case RKP_NOTIFY_CURSOR_MOVE:
+    case RKP_NOTIFY_IDLE:
+        data[0] = (uint8_t)value;
+        add(type, data, 1);
+        break;
+    default:
+        data[0] = (uint8_t)key;
+        add(type, data, 1);
+        break;
+    }
+}
+
+void RustyEventStream::add(uint8_t type, const uint8_t *data, uint8_t size)
+{
+    if (length + 1 + size > RUSTY_KEYPAD_STREAM_FRAME_SIZE)
+    {
+        flush();
+    }
+    if (length == 0)
+    {
+        frame_ts = millis();
+    }
+    frame[length++] = (uint8_t)((size << 4) | (type & 0x0F));
+    memcpy(frame + length, data, size);
+    length += size;
+}
+
+uint16_t RustyEventStream::crc16(uint16_t crc, uint8_t value)
+{
+    crc ^= (uint16_t)value << 8;
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
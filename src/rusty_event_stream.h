@@ -0,0 +1,143 @@
+/*
+ * RustyEventStream Class
+ *
+ * Author: Aras TAŞKIRAN
+ * Email: aras@arastaskiran.com
+ * Date: 2024-09-2024
+ *
+ * Description:
+ *
+ * A keypad that reports to a host over a serial line doesn't need to print
+ * text: RustyEventStream sends every keypad event as a record of 2 to 4 bytes.
+ * The records of a scan are batched into a frame with a sequence number, a time
+ * stamp and a CRC, so the host can find the frames in the byte stream, drop the
+ * damaged ones and notice the lost ones. extras/tools/rusty_stream.py is the
+ * reference decoder.
+ *
+ * License:
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUSTY_KEYPAD_EVENT_STREAM_H
+#define RUSTY_KEYPAD_EVENT_STREAM_H
+
+#include <stdint.h>
+#include <Arduino.h>
+#include <base_keypad.h>
+
+/**
+ * @brief The most record bytes in a frame.
+ *
+ * A frame takes 7 bytes more than its records. When the records of a scan don't fit, they are split
+ * over several frames.
+ */
+#ifndef RUSTY_KEYPAD_STREAM_FRAME_SIZE
+#define RUSTY_KEYPAD_STREAM_FRAME_SIZE 32
+#endif
+
+#if RUSTY_KEYPAD_STREAM_FRAME_SIZE < 4 || RUSTY_KEYPAD_STREAM_FRAME_SIZE > 255
+#error "RUSTY_KEYPAD_STREAM_FRAME_SIZE must be between 4 and 255"
+#endif
+
+/**
+ * @brief The first byte of every frame.
+ */
+#define RUSTY_KEYPAD_STREAM_SYNC 0x7E
+
+/**
+ * @class RustyEventStream
+ * @brief Sends the keypad events to a host in CRC protected binary frames.
+ *
+ * A frame is the sync byte 0x7E, the number of record bytes, the sequence number (8 bits, counting
+ * up from 0 with every frame), the time of the first record in milliseconds (the low 16 bits of
+ * `millis()`), the records, and the CRC-16/CCITT-FALSE of the bytes from the length to the last
+ * record. Numbers are little endian.
+ *
+ * A record starts with a byte that holds the `KeypadNotifyTypes` in its low nibble and the number of
+ * bytes that follow, 1 to 3, in its high nibble:
+ *
+ * - RKP_NOTIFY_KEY_DOWN, KEY_UP, LONG_PRESS and DELETE: the key.
+ * - RKP_NOTIFY_TEXT_CHANGE: the `RustyTextChanges` bits, the text length and the last character.
+ * - RKP_NOTIFY_MULTIPLE_KEYS: the number of keys and the first two of them.
+ * - RKP_NOTIFY_ENTER: the text length.
+ * - RKP_NOTIFY_CURSOR_MOVE: the cursor position.
+ * - RKP_NOTIFY_CREDENTIAL: the credential id (16 bits).
+ * - RKP_NOTIFY_IDLE: 1 when the keypad became idle, 0 when it woke up.
+ * - RKP_NOTIFY_FAULT: the `RustyFaultTypes` and the two lines of the fault.
+ *
+ * The events are sent whether or not a listener is registered for them.
+ */
+class RustyEventStream
+{
+public:
+    /**
+     * @brief Starts sending the events.
+     *
+     * @param out      The output, e.g. `Serial`. It must stay valid until `end()`.
+     * @param interval The milliseconds the records may wait for more records before their frame is
+     *                 sent; 0 sends the records of every scan in a frame at the end of the scan.
+     */
+    static void begin(Print &out, uint16_t interval = 0);
+
+    /**
+     * @brief Sends the pending records and stops sending the events.
+     */
+    static void end();
+
+    /**
+     * @brief Sends the pending records in a frame.
+     */
+    static void flush();
+
+    /**
+     * @brief Sends the pending records once the interval has passed; called at the end of every `scan()`.
+     */
+    static void update();
+
+    /**
+     * @brief Checks if the events are being sent.
+     */
+    static bool isStreaming();
+
+    /**
+     * @brief Returns the sequence number of the next frame.
+     */
+    static uint8_t getSequence();
+
+private:
+    /**
+     * @brief Adds the record of a notification; set as `notificationStream`.
+     */
+    static void onNotification(uint8_t type, char key, uint16_t value, const char *text);
+
+    /**
+     * @brief Adds a record, sending the pending records first if it doesn't fit.
+     */
+    static void add(uint8_t type, const uint8_t *data, uint8_t size);
+
+    /**
+     * @brief Updates a CRC-16/CCITT-FALSE with a byte.
+     */
+    static uint16_t crc16(uint16_t crc, uint8_t value);
+
+    static Print *output;
+    static uint8_t frame[RUSTY_KEYPAD_STREAM_FRAME_SIZE];
+    static uint8_t length;
+    static uint8_t sequence;
+    static uint16_t flush_interval;
+    static unsigned long frame_ts;
+};
+
+#endif
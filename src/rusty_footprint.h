@@ -0,0 +1,92 @@
+/*
+ * RustyKeypadFootprint
+ *
+ * Author: Aras TAŞKIRAN
+ * Email: aras@arastaskiran.com
+ * Date: 2024-09-2024
+ *
+ * Description:
+ *
+ * The RAM taken by the keypad depends on the matrix size and the text length the
+ * library is compiled for. RustyKeypadFootprint computes it at compile time, so a
+ * sketch can print it or a build can be stopped when it grows too large: define
+ * RUSTY_KEYPAD_RAM_BUDGET with the number of bytes the keypad may use and the
+ * build fails with a static_assert when the configuration doesn't fit.
+ *
+ * With RUSTY_KEYPAD_STATIC_ALLOCATION defined the keypad doesn't use the heap at
+ * all; the keys are constructed in a static arena and every text is returned in a
+ * static buffer. Without it the keys are allocated once by keyboardSetup(), and
+ * heap_bytes is the upper bound of that allocation.
+ *
+ * License:
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUSTY_KEYPAD_FOOTPRINT_H
+#define RUSTY_KEYPAD_FOOTPRINT_H
+
+#include <stddef.h>
+#include <base_keypad.h>
+
+/**
+ * @brief The RAM used by the keypad in the compiled configuration, in bytes.
+ *
+ * Only the storage that grows with `MAX_KEYPAD_MATRIX_SIZE` and `RUSTY_KEYPAD_MAX_TEXT_LENGTH` is
+ * counted; the fixed settings of the keypad, the optional scan task, coroutine pools, trace ring and latency histograms are not.
+ */
+struct RustyKeypadFootprint
+{
+    /** The keys, their list nodes and the list. */
+    static constexpr size_t key_bytes = RUSTY_KEYPAD_MAX_KEYS * (sizeof(RustyKey) + sizeof(RustyKeyNode)) + sizeof(RustyKeyList);
+
+    /** The row and column pins. */
+    static constexpr size_t pin_bytes = 2 * MAX_KEYPAD_MATRIX_SIZE * sizeof(uint8_t);
+
+    /** The deadline queue of the keys. */
+    static constexpr size_t deadline_bytes = sizeof(RustyDeadlineQueue);
+
+    /** The row heads and the row bitmaps used by the scan. */
+    static constexpr size_t scan_bytes = MAX_KEYPAD_MATRIX_SIZE * (sizeof(RustyKeyNode *) + sizeof(RustyRowBits)) + sizeof(RustyRowBits);
+
+#if defined(RUSTY_KEYPAD_STATIC_ALLOCATION)
+    /** The text buffer, the password mask and the buffers of the returned texts. */
+    static constexpr size_t text_bytes = sizeof(RustyTextBuffer) + (RUSTY_KEYPAD_MAX_TEXT_LENGTH + 1) * 2 + (RUSTY_KEYPAD_MAX_TEXT_LENGTH + 2);
+
+    /** The storage reserved at compile time. */
+    static constexpr size_t static_bytes = key_bytes + pin_bytes + deadline_bytes + scan_bytes + text_bytes;
+
+    /** The storage taken from the heap. */
+    static constexpr size_t heap_bytes = 0;
+#else
+    /** The text buffer and the password mask; the returned `String` texts are not counted. */
+    static constexpr size_t text_bytes = sizeof(RustyTextBuffer) + (RUSTY_KEYPAD_MAX_TEXT_LENGTH + 1);
+
+    /** The storage reserved at compile time. */
+    static constexpr size_t static_bytes = deadline_bytes + scan_bytes + text_bytes;
+
+    /** The largest storage taken from the heap by `keyboardSetup()`, without the allocator overhead. */
+    static constexpr size_t heap_bytes = key_bytes + pin_bytes;
+#endif
+
+    /** The sum of the static and the heap storage. */
+    static constexpr size_t total_bytes = static_bytes + heap_bytes;
+};
+
+#if defined(RUSTY_KEYPAD_RAM_BUDGET)
+static_assert(RustyKeypadFootprint::total_bytes <= RUSTY_KEYPAD_RAM_BUDGET,
+              "RustyKeypad doesn't fit into RUSTY_KEYPAD_RAM_BUDGET, reduce MAX_KEYPAD_MATRIX_SIZE or RUSTY_KEYPAD_MAX_TEXT_LENGTH");
+#endif
+
+#endif
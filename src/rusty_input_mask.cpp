@@ -0,0 +1,164 @@
+#include <rusty_input_mask.h>
+
+static const uint32_t maskPowersOfTen[] = {1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL};
+
+RustyInputMask::RustyInputMask()
+{
+    slot_count = 0;
+    field_count = 0;
+    ranged_fields = 0;
+}
+
+bool RustyInputMask::compile(const char *pattern)
+{
+    slot_count = 0;
+    field_count = 0;
+    ranged_fields = 0;
+    bool in_field = false;
+    for (; *pattern != '\0'; pattern++)
+    {
+        if (slot_count >= RUSTY_KEYPAD_MAX_MASK_LENGTH)
+        {
+            slot_count = 0;
+            return false;
+        }
+        RustyMaskSlot &slot = slots[slot_count++];
+        slot.rest = 0;
+        switch (*pattern)
+        {
+        case '#':
+            slot.kind = RKP_MASK_DIGIT;
+            break;
+        case 'X':
+            slot.kind = RKP_MASK_HEX;
+            break;
+        case 'A':
+            slot.kind = RKP_MASK_LETTER;
+            break;
+        case '?':
+            slot.kind = RKP_MASK_ANY;
+            break;
+        case '\\':
+            if (pattern[1] != '\0')
+            {
+                pattern++;
+            }
+            /* fall through */
+        default:
+            slot.kind = RKP_MASK_LITERAL;
+            slot.field = (uint8_t)*pattern;
+            in_field = false;
+            continue;
+        }
+        if (!in_field)
+        {
+            if (field_count >= RUSTY_KEYPAD_MAX_MASK_FIELDS)
+            {
+                slot_count = 0;
+                return false;
+            }
+            field_count++;
+            in_field = true;
+        }
+        slot.field = field_count - 1;
+    }
+
+    for (int8_t i = slot_count - 2; i >= 0; i--)
+    {
+        if (slots[i].kind != RKP_MASK_LITERAL && slots[i + 1].kind != RKP_MASK_LITERAL)
+        {
+            slots[i].rest = slots[i + 1].rest + 1;
+        }
+    }
+    return true;
+}
+
+bool RustyInputMask::setRange(uint8_t field, uint16_t min, uint16_t max)
+{
+    if (field >= field_count)
+    {
+        return false;
+    }
+    for (uint8_t i = 0; i < slot_count; i++)
+    {
+        if (slots[i].kind != RKP_MASK_LITERAL && slots[i].field == field)
+        {
+            if (slots[i].rest >= 5)
+            {
+                return false;
+            }
+            break;
+        }
+    }
+    range_min[field] = min;
+    range_max[field] = max;
+    ranged_fields |= (RustyMaskFieldBits)((RustyMaskFieldBits)1 << field);
+    return true;
+}
+
+uint8_t RustyInputMask::length() const
+{
+    return slot_count;
+}
+
+bool RustyInputMask::isLiteral(uint8_t position) const
+{
+    return slots[position].kind == RKP_MASK_LITERAL;
+}
+
+char RustyInputMask::getLiteral(uint8_t position) const
+{
+    return (char)slots[position].field;
+}
+
+uint8_t RustyInputMask::getField(uint8_t position) const
+{
+    return slots[position].field;
+}
+
+bool RustyInputMask::accept(uint8_t position, char key, uint16_t &field_value) const
+{
+    const RustyMaskSlot &slot = slots[position];
+    if (!matchesKind(slot.kind, key))
+    {
+        return false;
+    }
+    if (slot.kind != RKP_MASK_DIGIT || !(ranged_fields & ((RustyMaskFieldBits)1 << slot.field)))
+    {
+        return true;
+    }
+
+    uint32_t value = field_value * 10UL + (key - '0');
+    uint32_t scale = maskPowersOfTen[slot.rest];
+    if (value * scale > range_max[slot.field] || value * scale + (scale - 1) < range_min[slot.field])
+    {
+        return false;
+    }
+    field_value = (uint16_t)value;
+    return true;
+}
+
+void RustyInputMask::remove(uint8_t position, uint16_t &field_value) const
+{
+    if (slots[position].kind == RKP_MASK_DIGIT)
+    {
+        field_value /= 10;
+    }
+}
+
+bool RustyInputMask::matchesKind(uint8_t kind, char key)
+{
+    switch (kind)
+    {
+    case RKP_MASK_DIGIT:
+        return key >= '0' && key <= '9';
+    case RKP_MASK_HEX:
+        return (key >= '0' && key <= '9') || (key >= 'A' && key <= 'F') || (key >= 'a' && key <= 'f');
+    case RKP_MASK_LETTER:
+        return (key >= 'A' && key <= 'Z') || (key >= 'a' && key <= 'z');
+    case RKP_MASK_ANY:
+        return true;
+    default:
+        return false;
+    }
+}
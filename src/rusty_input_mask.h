@@ -0,0 +1,229 @@
+/*
+ * RustyInputMask Class
+ *
+ * Author: Aras TAŞKIRAN
+ * Email: aras@arastaskiran.com
+ * Date: 2024-09-2024
+ *
+ * Description:
+ *
+ * Dates, times and IP addresses are typed into fixed formats such as "##/##/####".
+ * Instead of reformatting the whole text on every key, the format is compiled once
+ * into a small slot table. While typing, the keypad only looks at the slot under the
+ * cursor: literal separators are inserted automatically, keys that don't fit the slot
+ * are rejected and every field can be limited to a range, for example 1-12 for months.
+ *
+ * Pattern characters:
+ *   #  a decimal digit
+ *   X  a hexadecimal digit
+ *   A  a letter
+ *   ?  any character
+ *   \  the next character is a literal
+ * Everything else is a literal separator.
+ *
+ * License:
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUSTY_KEYPAD_INPUT_MASK_H
+#define RUSTY_KEYPAD_INPUT_MASK_H
+
+#include <stdint.h>
+
+/**
+ * @brief Defines the maximum number of characters in an input mask pattern.
+ *
+ * @note Define this macro before including the library to change the limit.
+ */
+#ifndef RUSTY_KEYPAD_MAX_MASK_LENGTH
+#define RUSTY_KEYPAD_MAX_MASK_LENGTH 16
+#endif
+
+/**
+ * @brief Defines the maximum number of fields in an input mask pattern.
+ *
+ * A field is a run of placeholders between two literals, e.g. "##/##/####" has three fields.
+ */
+#ifndef RUSTY_KEYPAD_MAX_MASK_FIELDS
+#define RUSTY_KEYPAD_MAX_MASK_FIELDS 8
+#endif
+
+/**
+ * @brief A bit per field of an input mask.
+ */
+#if RUSTY_KEYPAD_MAX_MASK_FIELDS > 32
+#error "RUSTY_KEYPAD_MAX_MASK_FIELDS must not be larger than 32"
+#elif RUSTY_KEYPAD_MAX_MASK_FIELDS > 16
+typedef uint32_t RustyMaskFieldBits;
+#elif RUSTY_KEYPAD_MAX_MASK_FIELDS > 8
+typedef uint16_t RustyMaskFieldBits;
+#else
+typedef uint8_t RustyMaskFieldBits;
+#endif
+
+/**
+ * @enum RustyMaskSlotKinds
+ * @brief Defines what a position of an input mask accepts.
+ */
+typedef enum
+{
+    /** A literal separator that is inserted automatically. */
+    RKP_MASK_LITERAL,
+
+    /** A decimal digit ('#'). */
+    RKP_MASK_DIGIT,
+
+    /** A hexadecimal digit ('X'). */
+    RKP_MASK_HEX,
+
+    /** A letter ('A'). */
+    RKP_MASK_LETTER,
+
+    /** Any character ('?'). */
+    RKP_MASK_ANY
+
+} RustyMaskSlotKinds;
+
+/**
+ * @brief A compiled position of an input mask.
+ */
+struct RustyMaskSlot
+{
+    uint8_t kind;  /**< What the position accepts, one of `RustyMaskSlotKinds`. */
+    uint8_t field; /**< Field index of a placeholder, or the character of a literal. */
+    uint8_t rest;  /**< Number of placeholders that follow in the same field. */
+};
+
+/**
+ * @class RustyInputMask
+ * @brief An input format compiled into a slot table.
+ *
+ * @example
+ * RustyInputMask date;
+ * date.compile("##/##/####");
+ * date.setRange(0, 1, 31);
+ * date.setRange(1, 1, 12);
+ * RustyKeypad::setInputMask(&date);
+ */
+class RustyInputMask
+{
+public:
+    /**
+     * @brief Constructs an empty mask that accepts nothing until `compile` is called.
+     */
+    RustyInputMask();
+
+    /**
+     * @brief Compiles a pattern into the slot table.
+     *
+     * All ranges are removed.
+     *
+     * @param pattern The null-terminated pattern, see the description of this file.
+     * @return false if the pattern is longer than `RUSTY_KEYPAD_MAX_MASK_LENGTH` or has more than
+     *         `RUSTY_KEYPAD_MAX_MASK_FIELDS` fields, otherwise true.
+     */
+    bool compile(const char *pattern);
+
+    /**
+     * @brief Limits the value of a decimal field.
+     *
+     * Digits that would make the value impossible to keep within the range are rejected as they
+     * are typed, e.g. '4' as the first digit of a day.
+     *
+     * @param field The index of the field, counted from 0.
+     * @param min   The smallest accepted value.
+     * @param max   The largest accepted value.
+     * @return false if the field doesn't exist or has more than 5 digits, otherwise true.
+     */
+    bool setRange(uint8_t field, uint16_t min, uint16_t max);
+
+    /**
+     * @brief Returns the number of positions of the mask.
+     */
+    uint8_t length() const;
+
+    /**
+     * @brief Checks if the given position is a literal separator.
+     */
+    bool isLiteral(uint8_t position) const;
+
+    /**
+     * @brief Returns the character of a literal position.
+     */
+    char getLiteral(uint8_t position) const;
+
+    /**
+     * @brief Returns the field index of a placeholder position.
+     */
+    uint8_t getField(uint8_t position) const;
+
+    /**
+     * @brief Checks if a key may be typed at the given placeholder position.
+     *
+     * The key class is checked first, then the range of the field, if it has one.
+     *
+     * @param position    The placeholder position.
+     * @param key         The typed character.
+     * @param field_value The value of the field typed so far. It is updated if the key is accepted.
+     * @return true if the key is accepted, otherwise false.
+     */
+    bool accept(uint8_t position, char key, uint16_t &field_value) const;
+
+    /**
+     * @brief Removes the digit at the given position from a field value.
+     *
+     * @param position    The placeholder position of the deleted character.
+     * @param field_value The value of the field, updated in place.
+     */
+    void remove(uint8_t position, uint16_t &field_value) const;
+
+private:
+    /**
+     * @brief The compiled positions of the pattern.
+     */
+    RustyMaskSlot slots[RUSTY_KEYPAD_MAX_MASK_LENGTH];
+
+    /**
+     * @brief Smallest accepted value of each field.
+     */
+    uint16_t range_min[RUSTY_KEYPAD_MAX_MASK_FIELDS];
+
+    /**
+     * @brief Largest accepted value of each field.
+     */
+    uint16_t range_max[RUSTY_KEYPAD_MAX_MASK_FIELDS];
+
+    /**
+     * @brief Number of compiled positions.
+     */
+    uint8_t slot_count;
+
+    /**
+     * @brief Number of fields in the pattern.
+     */
+    uint8_t field_count;
+
+    /**
+     * @brief Bit mask of the fields that have a range.
+     */
+    RustyMaskFieldBits ranged_fields;
+
+    /**
+     * @brief Checks if a key belongs to the class of a slot.
+     */
+    static bool matchesKind(uint8_t kind, char key);
+};
+
+#endif
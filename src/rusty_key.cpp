@@ -1,160 +1,168 @@
 #include <rusty_key.h>
 #include <Arduino.h>
 #include <rusty_keypad.h>
+#include <rusty_key_table.h>
 
-RustyKey::RustyKey(const char *key, uint8_t row_pin, uint8_t col_pin)
+const uint16_t (*RustyKey::rules)[4][RUSTY_KEYPAD_KEY_EVENTS]{rkpRules(false)};
+
+RustyKey::RustyKey(const char *key, bool in_flash, RustyKeyIndex index)
 {
+    key_index = index;
     key_code = key;
-    row_out_pin = row_pin;
-    col_in_pin = col_pin;
+    key_in_flash = in_flash;
+    size_t length = (in_flash ? strlen_P(key) : strlen(key));
+    key_length = (length > RUSTY_KEYPAD_MAX_KEY_CHARS ? RUSTY_KEYPAD_MAX_KEY_CHARS : length);
     current_state = false;
     enabled = true;
     char_index = 0;
+    filter_passed = false;
     setEvent(RKP_KEY_IDLE);
-    pinMode(row_pin, OUTPUT);
-    pinMode(col_pin, RustyKeypad::pins_mode);
+    updateRole();
+}
+
+RustyKey::RustyKey(const RustyKey &other)
+{
+    last_activity_ts = other.last_activity_ts;
+    current_event = other.current_event;
+    key_code = other.key_code;
+    key_index = other.key_index;
+    key_length = other.key_length;
+    key_in_flash = other.key_in_flash;
+    char_index = other.char_index;
+    enabled = other.enabled;
+    current_state = other.current_state;
+    filter_passed = other.filter_passed;
+    key_role = other.key_role;
 }
 
 RustyKey::~RustyKey()
 {
-    rowPassive();
+    BaseRustyKeypad::deadlines.cancel(key_index);
 }
 
-bool RustyKey::check()
+bool RustyKey::check(bool pressed)
 {
+    bool new_state = (enabled && pressed);
+#if defined(RUSTY_KEYPAD_LATENCY)
+    RustyLatency::sampleKey(key_index, new_state != current_state);
+#endif
     if (!isScanAvailable())
     {
+#if defined(RUSTY_KEYPAD_TRACE)
+        if (new_state != current_state)
+        {
+            RustyTrace::record(RKP_TRACE_FILTERED, new_state, (uint8_t)key_index);
+        }
+#endif
         return false;
     }
 
-    bool new_state = read();
-    if (new_state == current_state)
-    {
-        return analyzeSameState(new_state);
-    }
-    current_state = new_state;
-    if (!new_state)
+    if (new_state == current_state && !isDeadlineDue())
     {
-        analyzeState();
-        return true;
+        return false;
     }
-    char_index = 0;
-    if (RustyKeypad::getType() == RKP_T9 && !RustyKeypad::isSpecialKey(getFirstKeyCode()))
+    uint8_t sample = (uint8_t)((current_state ? 2U : 0U) | (new_state ? 1U : 0U));
+    if (new_state != current_state)
     {
-        setEvent(RKP_T9_NEXT_CHAR);
-        return true;
+        current_state = new_state;
+#if defined(RUSTY_KEYPAD_TRACE)
+        RustyTrace::record(RKP_TRACE_EDGE, new_state, (uint8_t)key_index);
+#endif
     }
-    setEvent(RKP_KEY_DOWN);
-    return true;
-}
-
-void RustyKey::nextCharIndex()
-{
-    if ((char_index + 1) >= (int)strlen(key_code))
-        char_index = 0;
-    else
-        char_index++;
 
-    resetActivityTimer();
-}
-bool RustyKey::checkTimeout()
-{
-    if (RustyKeypad::isDeleteKey(getFirstKeyCode()))
+    uint16_t rule = rkpTransition(rules, getRole(), sample, current_event);
+    uint8_t event = rkpRuleEvent(rule);
+    uint8_t action = rkpRuleAction(rule);
+    if (rkpRuleTimer(rule) != RKP_TIMER_NONE && !isOverDuration(getTimerDuration(rkpRuleTimer(rule))))
     {
-        if (isOverT9Duration())
-        {
-            setEvent(RKP_PRESS_DELETE);
-            return true;
-        }
+        event = rkpRuleOtherwise(rule);
+        action = RKP_ACTION_NONE;
     }
-    else if (RustyKeypad::isEnterKey(getFirstKeyCode()))
+    if (event == RKP_NO_EVENT)
     {
-        if (isOverT9Duration())
-        {
-            setEvent(RKP_PRESS_ENTER);
-            return true;
-        }
+        return false;
     }
-    else if (RustyKeypad::getType() == RKP_T9)
+    if (action == RKP_ACTION_RESET_CHAR)
     {
-        if (isOverT9Duration())
-        {
-            nextCharIndex();
-            setEvent(RKP_T9_NEXT_CHAR);
-            return true;
-        }
-        return false;
+        char_index = 0;
     }
-    else if (isOverKeyDownDuration())
+    else if (action == RKP_ACTION_NEXT_CHAR)
     {
-        setEvent(RKP_KEY_UP);
-        return true;
+        nextCharIndex();
     }
-
-    return false;
+    setEvent((KeypadEventTypes)event);
+    return (event != RKP_KEY_IDLE && event != RKP_WAIT);
 }
 
-bool RustyKey::isOverT9Duration()
+void RustyKey::selectRules(bool t9)
 {
-    return ((millis() - last_activity_ts) > RustyKeypad::t9_duration);
+    rules = rkpRules(t9);
 }
 
-bool RustyKey::isOverKeyDownDuration()
+void RustyKey::nextCharIndex()
 {
-    return ((millis() - last_activity_ts) > RustyKeypad::keydown_timeout);
-}
+    if ((char_index + 1) >= key_length)
+        char_index = 0;
+    else
+        char_index++;
 
-bool RustyKey::isOverLongPressDuration()
+    resetActivityTimer();
+}
+unsigned long RustyKey::getTimerDuration(uint8_t timer) const
 {
-    return ((millis() - last_activity_ts) > RustyKeypad::long_press_duration);
+    switch (timer)
+    {
+    case RKP_TIMER_T9:
+        return RustyKeypad::t9_duration;
+    case RKP_TIMER_KEY_DOWN:
+        return RustyKeypad::keydown_timeout;
+    case RKP_TIMER_LONG_PRESS:
+        return RustyKeypad::long_press_duration;
+    default:
+        return RUSTY_KEYPAD_KEY_FILTER_MILLIS;
+    }
 }
 
-bool RustyKey::isPressed()
+uint8_t RustyKey::getRole() const
 {
-    return current_state;
+    return key_role;
 }
 
-void RustyKey::analyzeState()
+void RustyKey::updateRole()
 {
-    if (isEventDeleteRelation())
+    char code = getFirstKeyCode();
+    if (RustyKeypad::isDeleteKey(code))
     {
-        setEvent(RKP_RELEASE_DELETE);
-        return;
+        key_role = RKP_ROLE_DELETE;
     }
-    else if (isEventEnterRelation())
+    else if (RustyKeypad::isEnterKey(code))
     {
-        setEvent(RKP_RELEASE_ENTER);
-        return;
+        key_role = RKP_ROLE_ENTER;
     }
-    else if (RustyKeypad::getType() == RKP_T9)
+    else if (RustyKeypad::isCursorKey(code))
     {
-        setEvent(RKP_KEY_UP);
-        return;
+        key_role = RKP_ROLE_CURSOR;
     }
-    else if (isOverLongPressDuration())
+    else
     {
-        setEvent(RKP_LONG_PRESS);
-        return;
+        key_role = RKP_ROLE_NORMAL;
     }
-    setEvent(RKP_KEY_UP);
 }
 
-bool RustyKey::read()
+bool RustyKey::isOverDuration(unsigned long duration) const
 {
+    uint16_t elapsed = (uint16_t)millis() - last_activity_ts;
+    return (elapsed > (duration < RUSTY_KEYPAD_MAX_KEY_WAIT ? duration : RUSTY_KEYPAD_MAX_KEY_WAIT));
+}
 
-    if (!enabled)
-    {
-        if (digitalRead(row_out_pin) == (RustyKeypad::pins_mode == INPUT_PULLUP ? LOW : HIGH))
-        {
-            rowPassive();
-        }
-        return false;
-    }
-    rowActive();
-    bool state = (digitalRead(col_in_pin) == (RustyKeypad::pins_mode == INPUT_PULLUP ? LOW : HIGH));
-    rowPassive();
+bool RustyKey::isPressed()
+{
+    return current_state;
+}
 
-    return state;
+bool RustyKey::isBusy() const
+{
+    return (current_state || current_event != RKP_KEY_IDLE || isDeadlineDue());
 }
 
 void RustyKey::reset()
@@ -182,111 +190,98 @@ void RustyKey::disable()
     }
 }
 
-void RustyKey::rowActive()
-{
-    digitalWrite(row_out_pin, (RustyKeypad::pins_mode == INPUT_PULLUP ? LOW : HIGH));
-}
-void RustyKey::rowPassive()
-{
-    digitalWrite(row_out_pin, (RustyKeypad::pins_mode == INPUT_PULLUP ? HIGH : LOW));
-}
-
 KeypadEventTypes RustyKey::getCurrentEvent() const
 {
-    return current_event;
+    return (KeypadEventTypes)current_event;
 }
 
 char RustyKey::getKeyCode() const
 {
-    return key_code[char_index];
+    return readKeyChar(char_index);
 }
 
 char RustyKey::getFirstKeyCode() const
 {
-    return key_code[0];
+    return readKeyChar(0);
 }
 
-void RustyKey::setEvent(KeypadEventTypes e)
+char RustyKey::readKeyChar(uint8_t index) const
 {
-    current_event = e;
-    resetActivityTimer();
-}
-void RustyKey::resetActivityTimer()
-{
-    last_activity_ts = millis();
+    if (key_in_flash)
+    {
+        return (char)pgm_read_byte(key_code + index);
+    }
+    return key_code[index];
 }
 
-bool RustyKey::isScanAvailable()
+void RustyKey::setEvent(KeypadEventTypes e)
 {
-    return ((millis() - last_activity_ts) > RUSTY_KEYPAD_KEY_FILTER_MILLIS);
+#if defined(RUSTY_KEYPAD_TRACE)
+    RustyTrace::record(RKP_TRACE_EVENT, e, (uint8_t)key_index);
+#endif
+    current_event = e;
+    resetActivityTimer();
+    updateDeadline();
 }
 
-bool RustyKey::isEqual(const RustyKey *key)
+void RustyKey::updateDeadline()
 {
-    if (key == nullptr)
-        return false;
-
-    return getFirstKeyCode() == key->getFirstKeyCode();
-}
+    uint16_t rule = rkpTransition(rules, getRole(), (current_state ? RKP_SAMPLE_HELD : RKP_SAMPLE_RELEASED),
+                                  current_event);
+    if (rkpRuleTimer(rule) == RKP_TIMER_NONE && rkpRuleEvent(rule) == RKP_NO_EVENT)
+    {
+        BaseRustyKeypad::deadlines.cancel(key_index);
+        return;
+    }
 
-bool RustyKey::isEventDeleteRelation()
-{
-    return (isEvent(RKP_PRESS_DELETE) || isEvent(RKP_CLEAR_SCREEN));
+    unsigned long wait = getTimerDuration(rkpRuleTimer(rule));
+    if (wait < RUSTY_KEYPAD_KEY_FILTER_MILLIS)
+    {
+        wait = RUSTY_KEYPAD_KEY_FILTER_MILLIS;
+    }
+    else if (wait > RUSTY_KEYPAD_MAX_KEY_WAIT)
+    {
+        wait = RUSTY_KEYPAD_MAX_KEY_WAIT;
+    }
+    unsigned long now = millis();
+    unsigned long activity_ts = now - (uint16_t)((uint16_t)now - last_activity_ts);
+    BaseRustyKeypad::deadlines.schedule(key_index, activity_ts + wait + 1);
 }
 
-bool RustyKey::isEventEnterRelation()
+bool RustyKey::isDeadlineDue() const
 {
-    return (isEvent(RKP_PRESS_ENTER) || isEvent(RKP_RELEASE_ENTER));
+    return BaseRustyKeypad::deadlines.isDue(key_index, millis());
 }
 
-bool RustyKey::isEvent(KeypadEventTypes e)
+void RustyKey::resetActivityTimer()
 {
-    return e == current_event;
+    last_activity_ts = millis();
+    filter_passed = false;
 }
 
-bool RustyKey::analyzeSameState(bool new_state)
+bool RustyKey::isScanAvailable()
 {
-    if (new_state && current_event != RKP_WAIT)
+    if (!filter_passed)
     {
-        return fixCurrentState(new_state);
-    }
-    else if (!new_state && current_event != RKP_KEY_IDLE)
-    {
-        setEvent(RKP_KEY_IDLE);
+        if (!isOverDuration(RUSTY_KEYPAD_KEY_FILTER_MILLIS))
+        {
+            return false;
+        }
+        filter_passed = true;
     }
-    return !current_state ? false : checkTimeout();
+    return true;
 }
 
-bool RustyKey::fixCurrentState(bool new_state)
+bool RustyKey::isEqual(const RustyKey *key)
 {
-    if (isEventDeleteRelation())
-    {
-        if (isOverLongPressDuration() && !isEvent(RKP_CLEAR_SCREEN))
-        {
-            setEvent(RKP_CLEAR_SCREEN);
-            return true;
-        }
+    if (key == nullptr)
         return false;
-    }
-    else if (isEventEnterRelation())
-    {
-        if (!new_state)
-        {
-            setEvent(RKP_KEY_IDLE);
-        }
-        return !new_state;
-    }
-    else if (isEvent(RKP_T9_NEXT_CHAR))
-    {
-        setEvent(RKP_KEY_DOWN);
-        return true;
-    }
-    else if (current_event == RKP_KEY_UP)
-    {
-        char_index = 0;
-        setEvent(RKP_KEY_DOWN);
-        return true;
-    }
-    setEvent(RKP_WAIT);
-    return !current_state ? false : checkTimeout();
+
+    return key_index == key->key_index;
 }
+
+RustyKeyIndex RustyKey::getIndex() const
+{
+    return key_index;
+}
+
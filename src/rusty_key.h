@@ -31,6 +31,68 @@
 
 #include <stdint.h>
 #define RUSTY_KEYPAD_KEY_FILTER_MILLIS 20
+
+/**
+ * @brief Defines the maximum size of the keypad matrix.
+ *
+ * This macro sets the maximum number of rows and columns allowed in the keypad matrix.
+ * It ensures that the keypad matrix does not exceed this size to maintain compatibility
+ * with the rest of the system and avoid memory issues.
+ *
+ * @note Define this macro before including the library to change the size, up to 16 for a
+ *       16x16 matrix. The static buffers of the keypad grow with its square.
+ */
+#ifndef MAX_KEYPAD_MATRIX_SIZE
+#define MAX_KEYPAD_MATRIX_SIZE 5
+#endif
+
+#if MAX_KEYPAD_MATRIX_SIZE > 16
+#error "MAX_KEYPAD_MATRIX_SIZE must not be larger than 16"
+#endif
+
+/**
+ * @brief The number of keys of the largest supported matrix.
+ */
+#define RUSTY_KEYPAD_MAX_KEYS (MAX_KEYPAD_MATRIX_SIZE * MAX_KEYPAD_MATRIX_SIZE)
+
+/**
+ * @brief The type used to count and index the keys; 16 bits once a matrix can have 255 keys or more.
+ */
+#if RUSTY_KEYPAD_MAX_KEYS < 255
+typedef uint8_t RustyKeyIndex;
+#else
+typedef uint16_t RustyKeyIndex;
+#endif
+
+/**
+ * @brief Marks a key that is not waiting in the deadline queue.
+ */
+#define RKP_NO_QUEUE_SLOT ((RustyKeyIndex)~0U)
+
+/**
+ * @brief Returned by the key lookups when there is no such key.
+ */
+#define RKP_NO_KEY_INDEX ((RustyKeyIndex)~0U)
+
+/**
+ * @brief Marks a row or column that has no pin, for keypads whose keys are read some other way.
+ *
+ * The keys don't touch such a pin; the samples have to come from a `sampleSource`.
+ */
+#define RKP_NO_PIN 0xFF
+
+/**
+ * @brief The most characters a key can cycle through in RKP_T9 mode; longer key strings are cut.
+ */
+#define RUSTY_KEYPAD_MAX_KEY_CHARS 16
+
+/**
+ * @brief The longest time a key waits for a timeout, in milliseconds.
+ *
+ * The key timestamps are 16-bit values, so the T9 duration, the key down timeout and the long press
+ * duration are capped at this value.
+ */
+#define RUSTY_KEYPAD_MAX_KEY_WAIT 0x7FFFUL
 /**
  * @enum KeypadEventTypes
  * @brief Defines various states or events for a keypad.
@@ -75,23 +137,40 @@ typedef enum KeypadEventTypes
 
 } KeypadEventTypes;
 
+/**
+ * @brief Number of values of `KeypadEventTypes`.
+ */
+#define RUSTY_KEYPAD_KEY_EVENTS (RKP_T9_NEXT_CHAR + 1)
+
 class RustyKey
 {
+    friend class BaseRustyKeypad;
 
 public:
     /**
      * @brief Constructs a RustyKey object.
      *
-     * Initializes a key with a specified character and assigns it to the given row and column pins.
+     * Initializes a key with a specified character. The key doesn't touch the pins; the keypad drives the
+     * rows and reads the columns of the whole matrix and passes the state to `check`.
      *
      * @param key       A constant character pointer representing the key's value (e.g., "A", "A1B", "*").
-     * @param row_pin   The GPIO pin for the row where the key is located.
-     * @param col_pin   The GPIO pin for the column where the key is located.
+     * @param in_flash  true if `key` points to a string stored in PROGMEM.
+     * @param index     The position of the key in the matrix, `row * columns + column`.
      *
      * @example
-     * RustyKey key1("A", 5, 2);  // Creates key 'A' at row pin 5, column pin 2
+     * RustyKey key1("A", false, 5);  // Creates key 'A' at matrix position 5
+     */
+    RustyKey(const char *key, bool in_flash = false, RustyKeyIndex index = 0);
+
+    /**
+     * @brief Copy constructor.
+     *
+     * The copy has the key index of the original, so it shares the deadline that the deadline queue
+     * keeps for that index.
+     *
+     * @param other The key to copy.
      */
-    RustyKey(const char *key, uint8_t row_pin, uint8_t col_pin);
+    RustyKey(const RustyKey &other);
 
     /**
      * @brief Destructor for cleaning up the `RustyKey` object.
@@ -105,9 +184,10 @@ public:
      *
      * Evaluates the current state of the key and determines if it meets certain conditions.
      *
+     * @param pressed The state of the key as read from the matrix by the keypad.
      * @return True if the key meets the conditions, otherwise false.
      */
-    bool check();
+    bool check(bool pressed);
 
     /**
      * @brief Resets the state of the key.
@@ -126,6 +206,13 @@ public:
      */
     bool isPressed();
 
+    /**
+     * @brief Checks if the key has to be checked on the next scan although it isn't pressed.
+     *
+     * @return true if the key is pressed, its event is not RKP_KEY_IDLE or its deadline has passed.
+     */
+    bool isBusy() const;
+
     /**
      * @brief Disables the key functionality.
      *
@@ -140,17 +227,6 @@ public:
      */
     void enable();
 
-    /**
-     * @brief Reads the current state of the key.
-     *
-     * This method retrieves the current state of the key, determining whether it is active or not.
-     * It evaluates the key's status based on its internal logic and returns true if the key is active,
-     * otherwise false.
-     *
-     * @return True if the key is currently active, otherwise false.
-     */
-    bool read();
-
     /**
      * @brief Retrieves the current event type of the key.
      *
@@ -186,34 +262,32 @@ public:
      * @brief Compares the current key with another key for equality.
      *
      * This function checks if the current `RustyKey` object is equal to
-     * the provided `RustyKey` pointer. Equality is determined based on
-     * the relevant attributes of the keys, such as their values or properties.
+     * the provided `RustyKey` pointer. Two keys are equal when they are at the
+     * same position of the matrix, even if their key strings start alike.
      *
      * @param key A pointer to the `RustyKey` object to compare against.
      * @return bool `true` if the keys are equal, `false` otherwise.
      */
     bool isEqual(const RustyKey *key);
 
-protected:
-private:
     /**
-     * @brief Timestamp of the last key activity.
-     *
-     * This variable stores the time (in milliseconds) when the last activity was detected for the key.
-     * It is used to track the timing of key presses, releases, and other interactions. This timestamp
-     * helps in managing time-based behaviors, such as detecting idle periods or handling long presses.
+     * @brief Returns the position of the key in the matrix, `row * columns + column`.
      */
-    unsigned long last_activity_ts;
+    RustyKeyIndex getIndex() const;
 
     /**
-     * @brief The current event type for the key.
+     * @brief Checks if the deadline of the key has passed without a new event.
      *
-     * This variable holds the current event associated with the key, represented by the `KeypadEventTypes` enum.
-     * It indicates the key's current state or action, such as being idle, pressed down, released, long-pressed, or RKP_WAITing.
-     * The event type helps in managing and responding to various key interactions during operation.
+     * The deadline is calculated whenever the event of the key changes, from the event, the role of the
+     * key and the keypad mode, and is kept in the deadline queue under the key index. Until it has passed,
+     * a sample that equals the current state can't change anything.
+     *
+     * @return true if the key evaluates its timeouts on every scan, otherwise false.
      */
-    KeypadEventTypes current_event;
+    bool isDeadlineDue() const;
 
+protected:
+private:
     /**
      * @brief The character code associated with the key.
      *
@@ -224,22 +298,25 @@ private:
     const char *key_code;
 
     /**
-     * @brief The GPIO pin number for the key's row output.
+     * @brief Timestamp of the last key activity.
      *
-     * This variable specifies the GPIO pin used for the row where the key is located. It is used to connect
-     * the key's row to the microcontroller, allowing for the detection of key presses and interactions.
-     * The pin number corresponds to the physical pin on the microcontroller or development board.
+     * This variable stores the time (in milliseconds) when the last activity was detected for the key.
+     * It is used to track the timing of key presses, releases, and other interactions. This timestamp
+     * helps in managing time-based behaviors, such as detecting idle periods or handling long presses.
+     *
+     * Only the lower 16 bits of `millis()` are kept. The elapsed time is computed with wrap-around
+     * arithmetic, which is exact up to 65535 ms; the key timeouts are capped below that.
      */
-    uint8_t row_out_pin;
+    uint16_t last_activity_ts;
 
     /**
-     * @brief The GPIO pin number for the key's column input.
+     * @brief The current event type for the key.
      *
-     * This variable specifies the GPIO pin used for the column where the key is located. It is used to connect
-     * the key's column to the microcontroller, allowing for the detection of key presses and interactions.
-     * The pin number corresponds to the physical pin on the microcontroller or development board.
+     * This variable holds the current event associated with the key, represented by the `KeypadEventTypes` enum.
+     * It indicates the key's current state or action, such as being idle, pressed down, released, long-pressed, or RKP_WAITing.
+     * The event type helps in managing and responding to various key interactions during operation.
      */
-    uint8_t col_in_pin;
+    uint8_t current_event : 4;
 
     /**
      * @brief The index of the current character associated with the key.
@@ -249,35 +326,28 @@ private:
      * is being displayed or used based on the duration of the key press. The index changes as the key
      * is held down to cycle through the available characters.
      */
-    uint8_t char_index;
+    uint8_t char_index : 4;
 
     /**
-     * @brief Indicates whether the key is enabled or disabled.
+     * @brief Number of characters of `key_code`, counted once when the key is created.
      *
-     * This variable holds a flag that determines if the key is currently active and responsive to interactions.
-     * When `enabled` is true, the key can be pressed, and its events can be processed. When `enabled` is false,
-     * the key is inactive and will not respond to presses or other interactions.
+     * At most `RUSTY_KEYPAD_MAX_KEY_CHARS` characters of a key are used.
      */
-    bool enabled;
+    uint8_t key_length : 5;
 
     /**
-     * @brief Activates the row pin for key scanning.
-     *
-     * This method sets the row digital output pin to the appropriate level based on the input configuration.
-     * If the row pins are configured as `INPUT_PULLUP`, this method pulls the row pin to ground (LOW).
-     * Otherwise, it sets the pin to a high state (HIGH). This activation is necessary for scanning the key matrix
-     * and detecting key presses.
+     * @brief Indicates whether `key_code` is stored in flash (PROGMEM) and has to be read with `pgm_read_byte`.
      */
-    void rowActive();
+    uint8_t key_in_flash : 1;
+
     /**
-     * @brief Deactivates the row pin for key scanning.
+     * @brief Indicates whether the key is enabled or disabled.
      *
-     * This method sets the row digital output pin to a passive state based on the input configuration.
-     * If the input pins are configured as `INPUT_PULLUP`, this method sets the row pin to a high state (HIGH).
-     * Otherwise, it sets the pin to ground (LOW). This deactivation is essential for properly managing the
-     * key matrix during scanning and detecting key presses.
+     * This variable holds a flag that determines if the key is currently active and responsive to interactions.
+     * When `enabled` is true, the key can be pressed, and its events can be processed. When `enabled` is false,
+     * the key is inactive and will not respond to presses or other interactions.
      */
-    void rowPassive();
+    uint8_t enabled : 1;
 
     /**
      * @brief The current state of the key.
@@ -286,37 +356,55 @@ private:
      * The state is used to determine the key's interaction status and to manage the key's event processing.
      * It helps in differentiating between key being actively pressed or in its idle state.
      */
-    bool current_state;
+    uint8_t current_state : 1;
 
     /**
-     * @brief Analyzes the current state of the key to determine the event type.
+     * @brief Indicates whether the noise filter time has passed since the last activity.
      *
-     * This method determines whether the key event is a KeyUp or a LongPress when the key is released.
-     * It uses the `last_activity_ts` timestamp and the `long_press_duration` to make this determination.
-     * If the keyboard is configured in RKP_T9 mode, this method will always return a KeyUp event because
-     * pressing and holding the key is required to cycle through the alternative characters associated with the key.
+     * Once set, the key no longer looks at its timestamp before reading the pin, so a key that has been
+     * idle for longer than the 16-bit timestamp can count is still scanned.
      */
-    void analyzeState();
+    uint8_t filter_passed : 1;
 
     /**
-     * @brief Checks if the key press has timed out and performs actions based on the keyboard mode.
-     *
-     * This method determines if the key has been pressed for a duration that triggers specific actions
-     * based on the current keyboard mode:
+     * @brief The role of the key in the transition table, one of `RustyKeyRoles`, set by `updateRole`.
+     */
+    uint8_t key_role : 2;
+
+    /**
+     * @brief Reads a character of `key_code` from RAM or flash.
      *
-     * - **RKP_T9 Mode:** If the key is held down long enough, it will advance to the next character in the
-     *   sequence associated with the key. This is done by incrementing the `char_index` and triggering
-     *   a `RKP_KEY_DOWN` event. The method uses `t9_duration` and `last_activity_ts` to check if the timeout
-     *   threshold has been reached.
+     * @param index The character index.
+     * @return The character.
+     */
+    char readKeyChar(uint8_t index) const;
+
+    /**
+     * @brief Position of the key in the matrix; stays the same as long as the layout does.
+     */
+    RustyKeyIndex key_index;
+
+    /**
+     * @brief The half of the transition table for the keypad type, chosen by `selectRules`.
+     */
+    static const uint16_t (*rules)[4][RUSTY_KEYPAD_KEY_EVENTS];
+
+    /**
+     * @brief Chooses the rules of every key; called by `setType` so `check` doesn't ask for the type.
      *
-     * - **Other Modes:** In standard modes, holding the key for a set duration simulates releasing and
-     *   pressing the key again. When the timeout threshold is exceeded, it first triggers a `RKP_KEY_UP` event,
-     *   followed by a `RKP_KEY_DOWN` event in the next loop iteration. This behavior is controlled using
-     *   `keydown_timeout` and `last_activity_ts`.
+     * @param t9 true if the keypad is in RKP_T9 mode.
+     */
+    static void selectRules(bool t9);
+
+    /**
+     * @brief Calculates the next deadline of the key and updates the deadline queue.
      *
-     * @return `true` if the timeout condition is met and actions are performed, `false` otherwise.
+     * The deadline follows the timer of the rule that `check` looks up while the key stays as it is: the T9
+     * duration or key down timeout while RKP_WAITing, the long press duration while the delete key is pressed,
+     * and the noise filter for the states that change on the next scan. Idle keys and keys that only wait for
+     * their release have no deadline.
      */
-    bool checkTimeout();
+    void updateDeadline();
 
     /**
      * @brief Sets the event type for the key and resets the activity timestamp.
@@ -361,93 +449,29 @@ private:
     void resetActivityTimer();
 
     /**
-     * @brief Checks if the key press duration exceeds the RKP_T9 threshold.
-     *
-     * This function determines whether the duration for which a key has been held down
-     * surpasses the predefined threshold for RKP_T9 input. It is used to manage input
-     * behavior in RKP_T9 mode by ensuring that prolonged key presses are handled appropriately.
-     *
-     * @return bool `true` if the key press duration exceeds the RKP_T9 threshold, `false` otherwise.
-     */
-    bool isOverT9Duration();
-
-    /**
-     * @brief Checks if the key press duration exceeds the RKP_KEY_DOWN threshold.
-     *
-     * This function determines whether the duration for which a key has been held down
-     * exceeds the predefined threshold for RKP_KEY_DOWN events. It is used to manage input
-     * behavior by identifying if a prolonged key press has occurred.
-     *
-     * @return bool `true` if the key press duration exceeds the RKP_KEY_DOWN threshold, `false` otherwise.
-     */
-    bool isOverKeyDownDuration();
-
-    /**
-     * @brief Checks if the key press duration has exceeded the long press threshold.
-     *
-     * This function determines whether the duration for which a key has been held down
-     * has surpassed the predefined threshold for a long press action. If the duration
-     * exceeds the threshold, it returns true, indicating a long press.
-     *
-     * @return true if the key press duration exceeds the long press threshold, otherwise false.
-     */
-    bool isOverLongPressDuration();
-
-    /**
-     * @brief Analyzes and handles button actions based on the current and new states.
-     *
-     * This function determines the appropriate action when a button is held down, depending on
-     * the specific configuration. If the button is in the same state (`new_state` is the same as
-     * the current state), the function will decide the next step, such as whether to trigger a
-     * long press action or ignore further input.
-     *
-     * @param new_state The new state of the button (true if pressed, false if not).
-     * @return A boolean value indicating if the state has changed or if an action needs to be performed.
+     * @brief Returns the duration of one of the `RustyKeyTimers` in milliseconds.
      */
-    bool analyzeSameState(bool new_state);
+    unsigned long getTimerDuration(uint8_t timer) const;
 
     /**
-     * @brief Checks if the current event is related to a delete action.
-     *
-     * This function determines whether the current keypad event is associated with
-     * a delete action, such as pressing or releasing the delete key.
-     *
-     * @return true if the current event is related to a delete action, otherwise false.
+     * @brief Returns the role of the key in the transition table, one of `RustyKeyRoles`.
      */
-    bool isEventDeleteRelation();
+    uint8_t getRole() const;
 
     /**
-     * @brief Checks if the current event is related to the enter key.
+     * @brief Works out the role of the key from the delete, enter and cursor keys of the keypad.
      *
-     * This function determines whether the current event is associated with the enter key.
-     * It can be used to verify if the event being handled is triggered by pressing or interacting
-     * with the enter key.
-     *
-     * @return `true` if the current event is related to the enter key, `false` otherwise.
+     * Called when the key is created and by the keypad when one of those keys changes, so `check`
+     * doesn't compare the key code with them on every scan.
      */
-    bool isEventEnterRelation();
+    void updateRole();
 
     /**
-     * @brief Compares the specified event with the current event.
-     *
-     * This function checks whether the provided keypad event type `e` matches the current event
-     * being processed. It helps to determine if a specific event is occurring.
-     *
-     * @param e The event type to compare with the current event.
-     * @return true if the specified event matches the current event, otherwise false.
-     */
-    bool isEvent(KeypadEventTypes e);
-
-    /**
-     * @brief Fixes the current state based on the new state.
-     *
-     * This function manages the state transitions for events that may have multiple phases.
-     * It adjusts the current state according to the specified new state, ensuring
-     * proper handling of complex event sequences.
+     * @brief Checks if more than the given time has passed since the last activity.
      *
-     * @param new_state The new state to be set for the current event.
-     * @return true if the state was successfully fixed; otherwise, false.
+     * @param duration The time in milliseconds, capped at `RUSTY_KEYPAD_MAX_KEY_WAIT`.
+     * @return true if the time has passed, otherwise false.
      */
-    bool fixCurrentState(bool new_state);
+    bool isOverDuration(unsigned long duration) const;
 };
 #endif
\ No newline at end of file
@@ -1,8 +1,32 @@
 #include <rusty_key_list.h>
 
+#if defined(RUSTY_KEYPAD_STATIC_ALLOCATION)
+alignas(RustyKey) static unsigned char key_arena[RUSTY_KEYPAD_MAX_KEYS][sizeof(RustyKey)];
+alignas(RustyKeyNode) static unsigned char node_arena[RUSTY_KEYPAD_MAX_KEYS][sizeof(RustyKeyNode)];
+RustyKeyIndex RustyKeyArena::used_keys{0};
+RustyKeyIndex RustyKeyArena::used_nodes{0};
+
+void *RustyKeyArena::allocateKey()
+{
+    return (used_keys < RUSTY_KEYPAD_MAX_KEYS ? key_arena[used_keys++] : nullptr);
+}
+
+void *RustyKeyArena::allocateNode()
+{
+    return (used_nodes < RUSTY_KEYPAD_MAX_KEYS ? node_arena[used_nodes++] : nullptr);
+}
+
+void RustyKeyArena::reset()
+{
+    used_keys = 0;
+    used_nodes = 0;
+}
+#endif
+
 RustyKeyList::RustyKeyList()
 {
     head = nullptr;
+    tail = nullptr;
 }
 
 RustyKeyList::~RustyKeyList()
@@ -15,33 +39,52 @@ RustyKeyNode& RustyKeyNode::operator=(const RustyKeyNode& other) {
     if (this == &other) {
         return *this; 
     }    
+#if defined(RUSTY_KEYPAD_STATIC_ALLOCATION)
+    if (data != nullptr)
+    {
+        data->~RustyKey();
+        new (data) RustyKey(*other.data);
+    }
+#else
     delete data;
     data=nullptr;
     data = new RustyKey(*other.data); 
+#endif
     next = other.next; 
 
     return *this;
 }
 
+#if defined(RUSTY_KEYPAD_STATIC_ALLOCATION)
+RustyKeyNode::RustyKeyNode(const RustyKeyNode& other)
+    : data(new (RustyKeyArena::allocateKey()) RustyKey(*other.data)), next(other.next) {}
+#else
 RustyKeyNode::RustyKeyNode(const RustyKeyNode& other)
     : data(new RustyKey(*other.data)), next(other.next) {}
+#endif
 
-void RustyKeyList::append(const char * key, uint8_t row_pin, uint8_t col_pin)
+RustyKeyNode *RustyKeyList::append(const char * key, bool in_flash, RustyKeyIndex index)
 {
-    RustyKeyNode *newNode = new RustyKeyNode(key, row_pin, col_pin);
+#if defined(RUSTY_KEYPAD_STATIC_ALLOCATION)
+    RustyKeyNode *newNode = new (RustyKeyArena::allocateNode()) RustyKeyNode(key, in_flash, index);
+    if (newNode == nullptr)
+    {
+        return nullptr;
+    }
+#else
+    RustyKeyNode *newNode = new RustyKeyNode(key, in_flash, index);
+#endif
 
     if (head == nullptr)
     {
         head = newNode;
-        return;
     }
-
-    RustyKeyNode *temp = head;
-    while (temp->next != nullptr)
+    else
     {
-        temp = temp->next;
+        tail->next = newNode;
     }
-    temp->next = newNode;
+    tail = newNode;
+    return newNode;
 }
 
 void RustyKeyList::clear()
@@ -50,11 +93,19 @@ void RustyKeyList::clear()
     while (current != nullptr)
     {
         RustyKeyNode *next = current->next;
+#if defined(RUSTY_KEYPAD_STATIC_ALLOCATION)
+        current->~RustyKeyNode();
+#else
         delete current;
+#endif
         current = nullptr;
         current = next;
     }
     head = nullptr;
+    tail = nullptr;
+#if defined(RUSTY_KEYPAD_STATIC_ALLOCATION)
+    RustyKeyArena::reset();
+#endif
 }
 
 void RustyKeyList::disable()
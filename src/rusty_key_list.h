@@ -32,6 +32,47 @@
 #define RUSTY_KEYPAD_LIST_H
 #include <rusty_key.h>
 
+#if defined(RUSTY_KEYPAD_STATIC_ALLOCATION)
+#include <new>
+
+/**
+ * @class RustyKeyArena
+ * @brief Static storage for the keys and their list nodes, used instead of the heap.
+ *
+ * With `RUSTY_KEYPAD_STATIC_ALLOCATION` defined, the keys are constructed in arrays sized for
+ * `RUSTY_KEYPAD_MAX_KEYS` keys at compile time. The arena is handed out from the beginning and
+ * emptied as a whole when the key list is cleared.
+ */
+class RustyKeyArena
+{
+public:
+    /**
+     * @brief Takes the storage for one `RustyKey`.
+     *
+     * @return The storage, or nullptr if the arena is full.
+     */
+    static void *allocateKey();
+
+    /**
+     * @brief Takes the storage for one `RustyKeyNode`.
+     *
+     * @return The storage, or nullptr if the arena is full.
+     */
+    static void *allocateNode();
+
+    /**
+     * @brief Makes the whole arena available again.
+     *
+     * The objects constructed in the arena must have been destroyed before.
+     */
+    static void reset();
+
+private:
+    static RustyKeyIndex used_keys;  /**< Number of keys taken from the arena. */
+    static RustyKeyIndex used_nodes; /**< Number of nodes taken from the arena. */
+};
+#endif
+
 /**
  * @brief Node structure for a linked list of `RustyKey` objects.
  *
@@ -46,15 +87,19 @@ struct RustyKeyNode
     /**
      * @brief Constructor for initializing a `RustyKeyNode` with given parameters.
      *
-     * Constructs a `RustyKeyNode` by creating a new `RustyKey` object with the provided key, row pin,
-     * and column pin. Initializes the `next` pointer to `nullptr`.
+     * Constructs a `RustyKeyNode` by creating a new `RustyKey` object with the provided key.
+     * Initializes the `next` pointer to `nullptr`.
      *
      * @param key The key associated with this node.
-     * @param row_pin The row pin for the `RustyKey` object.
-     * @param col_pin The column pin for the `RustyKey` object.
+     * @param in_flash true if `key` is stored in PROGMEM.
+     * @param index The position of the key in the matrix.
      */
-    RustyKeyNode(const char *key, uint8_t row_pin, uint8_t col_pin)
-        : data(new RustyKey(key, row_pin, col_pin)), next(nullptr) {}
+    RustyKeyNode(const char *key, bool in_flash = false, RustyKeyIndex index = 0)
+#if defined(RUSTY_KEYPAD_STATIC_ALLOCATION)
+        : data(new (RustyKeyArena::allocateKey()) RustyKey(key, in_flash, index)), next(nullptr) {}
+#else
+        : data(new RustyKey(key, in_flash, index)), next(nullptr) {}
+#endif
 
     /**
      * @brief Assignment operator for copying
@@ -85,7 +130,14 @@ struct RustyKeyNode
      */
     ~RustyKeyNode()
     {
+#if defined(RUSTY_KEYPAD_STATIC_ALLOCATION)
+        if (data != nullptr)
+        {
+            data->~RustyKey();
+        }
+#else
         delete data;
+#endif
         data = nullptr;
     }
 };
@@ -101,6 +153,7 @@ class RustyKeyList
 {
 private:
     RustyKeyNode *head; /**< Pointer to the first node in the linked list. */
+    RustyKeyNode *tail; /**< Pointer to the last node in the linked list. */
 
 public:
     /**
@@ -120,14 +173,14 @@ public:
     /**
      * @brief Appends a new `RustyKey` to the list.
      *
-     * Creates a new `RustyKeyNode` with the provided key, row pin, and column pin, and adds it to the
-     * end of the linked list.
+     * Creates a new `RustyKeyNode` with the provided key and adds it to the end of the linked list.
      *
      * @param key The key associated with the new `RustyKey` node.
-     * @param row_pin The row pin for the new `RustyKey` node.
-     * @param col_pin The column pin for the new `RustyKey` node.
+     * @param in_flash true if `key` is stored in PROGMEM.
+     * @param index The position of the key in the matrix.
+     * @return The new node, or nullptr if it could not be created.
      */
-    void append(const char *key, uint8_t row_pin, uint8_t col_pin);
+    RustyKeyNode *append(const char *key, bool in_flash = false, RustyKeyIndex index = 0);
 
     /**
      * @brief Clears all nodes from the list.
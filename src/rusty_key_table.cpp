@@ -0,0 +1,121 @@
+#include <rusty_key_table.h>
+
+static_assert(RUSTY_KEYPAD_KEY_EVENTS == 11, "rusty_key_table lists every KeypadEventTypes value");
+static_assert(RUSTY_KEYPAD_KEY_EVENTS <= RKP_NO_EVENT, "a rule stores the events in 4 bits");
+
+/*
+ * Moves the key to the given event.
+ */
+static constexpr uint16_t rkpGo(uint8_t event, uint8_t action = RKP_ACTION_NONE)
+{
+    return rkpRule(RKP_TIMER_NONE, event, RKP_NO_EVENT, action);
+}
+
+/*
+ * Moves the key to the given event once the timer has expired.
+ */
+static constexpr uint16_t rkpAfter(uint8_t timer, uint8_t event, uint8_t otherwise = RKP_NO_EVENT,
+                                   uint8_t action = RKP_ACTION_NONE)
+{
+    return rkpRule(timer, event, otherwise, action);
+}
+
+/*
+ * A released key returns to idle.
+ */
+static constexpr uint16_t rkpReleased(uint8_t event)
+{
+    return (event == RKP_KEY_IDLE ? rkpGo(RKP_NO_EVENT) : rkpGo(RKP_KEY_IDLE));
+}
+
+/*
+ * A pressed key starts with its first character; character keys in RKP_T9 mode show it at once.
+ */
+static constexpr uint16_t rkpPress(bool t9, uint8_t role)
+{
+    return rkpGo((t9 && role == RKP_ROLE_NORMAL) ? RKP_T9_NEXT_CHAR : RKP_KEY_DOWN, RKP_ACTION_RESET_CHAR);
+}
+
+/*
+ * A released key ends its delete or enter action, or becomes a key up; a long press outside RKP_T9 mode.
+ */
+static constexpr uint16_t rkpRelease(bool t9, uint8_t event)
+{
+    return (event == RKP_PRESS_DELETE || event == RKP_CLEAR_SCREEN)   ? rkpGo(RKP_RELEASE_DELETE)
+           : (event == RKP_PRESS_ENTER || event == RKP_RELEASE_ENTER) ? rkpGo(RKP_RELEASE_ENTER)
+           : t9                                                       ? rkpGo(RKP_KEY_UP)
+                                                                      : rkpAfter(RKP_TIMER_LONG_PRESS, RKP_LONG_PRESS, RKP_KEY_UP);
+}
+
+/*
+ * A key held down in RKP_WAIT: delete and enter act after the T9 duration, character keys in RKP_T9
+ * mode move to their next character, and the other keys repeat after the key down timeout.
+ */
+static constexpr uint16_t rkpWait(bool t9, uint8_t role)
+{
+    return role == RKP_ROLE_DELETE           ? rkpAfter(RKP_TIMER_T9, RKP_PRESS_DELETE)
+           : role == RKP_ROLE_ENTER          ? rkpAfter(RKP_TIMER_T9, RKP_PRESS_ENTER)
+           : (t9 && role == RKP_ROLE_NORMAL) ? rkpAfter(RKP_TIMER_T9, RKP_T9_NEXT_CHAR, RKP_NO_EVENT, RKP_ACTION_NEXT_CHAR)
+                                             : rkpAfter(RKP_TIMER_KEY_DOWN, RKP_KEY_UP);
+}
+
+/*
+ * A key held down settles in RKP_WAIT; a held delete key clears the screen after the long press duration.
+ */
+static constexpr uint16_t rkpHeld(bool t9, uint8_t role, uint8_t event)
+{
+    return event == RKP_WAIT                       ? rkpWait(t9, role)
+           : event == RKP_PRESS_DELETE             ? rkpAfter(RKP_TIMER_LONG_PRESS, RKP_CLEAR_SCREEN)
+           : event == RKP_CLEAR_SCREEN             ? rkpGo(RKP_NO_EVENT)
+           : event == RKP_PRESS_ENTER              ? rkpGo(RKP_NO_EVENT)
+           : event == RKP_RELEASE_ENTER            ? rkpGo(RKP_NO_EVENT)
+           : event == RKP_T9_NEXT_CHAR             ? rkpGo(RKP_KEY_DOWN)
+           : event == RKP_KEY_UP                   ? rkpGo(RKP_KEY_DOWN, RKP_ACTION_RESET_CHAR)
+                                                   : rkpGo(RKP_WAIT);
+}
+
+/*
+ * The rule for one cell of the table.
+ */
+static constexpr uint16_t rkpTransitionRule(bool t9, uint8_t role, uint8_t sample, uint8_t event)
+{
+    return sample == RKP_SAMPLE_RELEASED  ? rkpReleased(event)
+           : sample == RKP_SAMPLE_PRESS   ? rkpPress(t9, role)
+           : sample == RKP_SAMPLE_RELEASE ? rkpRelease(t9, event)
+                                          : rkpHeld(t9, role, event);
+}
+
+#define RKP_EVENT_RULES(t9, role, sample)                        \
+    {                                                            \
+        rkpTransitionRule(t9, role, sample, RKP_KEY_IDLE),       \
+        rkpTransitionRule(t9, role, sample, RKP_KEY_DOWN),       \
+        rkpTransitionRule(t9, role, sample, RKP_KEY_UP),         \
+        rkpTransitionRule(t9, role, sample, RKP_LONG_PRESS),     \
+        rkpTransitionRule(t9, role, sample, RKP_WAIT),           \
+        rkpTransitionRule(t9, role, sample, RKP_PRESS_DELETE),   \
+        rkpTransitionRule(t9, role, sample, RKP_RELEASE_DELETE), \
+        rkpTransitionRule(t9, role, sample, RKP_CLEAR_SCREEN),   \
+        rkpTransitionRule(t9, role, sample, RKP_PRESS_ENTER),    \
+        rkpTransitionRule(t9, role, sample, RKP_RELEASE_ENTER),  \
+        rkpTransitionRule(t9, role, sample, RKP_T9_NEXT_CHAR)    \
+    }
+
+#define RKP_SAMPLE_RULES(t9, role)                      \
+    {                                                   \
+        RKP_EVENT_RULES(t9, role, RKP_SAMPLE_RELEASED), \
+        RKP_EVENT_RULES(t9, role, RKP_SAMPLE_PRESS),    \
+        RKP_EVENT_RULES(t9, role, RKP_SAMPLE_RELEASE),  \
+        RKP_EVENT_RULES(t9, role, RKP_SAMPLE_HELD)      \
+    }
+
+#define RKP_ROLE_RULES(t9)                     \
+    {                                          \
+        RKP_SAMPLE_RULES(t9, RKP_ROLE_NORMAL), \
+        RKP_SAMPLE_RULES(t9, RKP_ROLE_CURSOR), \
+        RKP_SAMPLE_RULES(t9, RKP_ROLE_DELETE), \
+        RKP_SAMPLE_RULES(t9, RKP_ROLE_ENTER)   \
+    }
+
+const uint16_t rusty_key_table[2][4][4][RUSTY_KEYPAD_KEY_EVENTS] PROGMEM = {
+    RKP_ROLE_RULES(false),
+    RKP_ROLE_RULES(true)};
@@ -0,0 +1,188 @@
+/*
+ * RustyKeyTable
+ *
+ * Author: Aras TAŞKIRAN
+ * Email: aras@arastaskiran.com
+ * Date: 2024-09-2024
+ *
+ * Description:
+ *
+ * The state machine of a key as a table. A rule is looked up with the T9 mode,
+ * the role of the key, the sampled state against the current state and the
+ * current event. It names the event the key moves to, and it may make the move
+ * depend on one of the key timers, in which case it also names the event taken
+ * while the timer is still running.
+ *
+ * The table is computed by the compiler from the constexpr functions in
+ * rusty_key_table.cpp and stored in flash, so a key check costs the same table
+ * read whatever state the key is in, and every combination can be listed and
+ * tested.
+ *
+ * License:
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUSTY_KEYPAD_KEY_TABLE_H
+#define RUSTY_KEYPAD_KEY_TABLE_H
+
+#include <stdint.h>
+#include <Arduino.h>
+#include <rusty_key.h>
+
+/**
+ * @enum RustyKeyRoles
+ * @brief The role of a key, given by its first character.
+ */
+typedef enum RustyKeyRoles
+{
+    /** A character key. */
+    RKP_ROLE_NORMAL,
+
+    /** A cursor key, see `setCursorKeys`. */
+    RKP_ROLE_CURSOR,
+
+    /** The delete key, see `useDeleteKey`. */
+    RKP_ROLE_DELETE,
+
+    /** The enter key, see `setEnterKey`. */
+    RKP_ROLE_ENTER
+
+} RustyKeyRoles;
+
+/**
+ * @enum RustyKeySamples
+ * @brief The sampled state of a key compared to its current state.
+ */
+typedef enum RustyKeySamples
+{
+    /** Released, and it was released. */
+    RKP_SAMPLE_RELEASED,
+
+    /** Pressed, and it was released. */
+    RKP_SAMPLE_PRESS,
+
+    /** Released, and it was pressed. */
+    RKP_SAMPLE_RELEASE,
+
+    /** Pressed, and it was pressed. */
+    RKP_SAMPLE_HELD
+
+} RustyKeySamples;
+
+/**
+ * @enum RustyKeyTimers
+ * @brief The timer a rule waits for, measured from the last event of the key.
+ */
+typedef enum RustyKeyTimers
+{
+    /** The rule doesn't wait. */
+    RKP_TIMER_NONE,
+
+    /** The T9 duration. */
+    RKP_TIMER_T9,
+
+    /** The key down timeout. */
+    RKP_TIMER_KEY_DOWN,
+
+    /** The long press duration. */
+    RKP_TIMER_LONG_PRESS
+
+} RustyKeyTimers;
+
+/**
+ * @enum RustyKeyActions
+ * @brief What happens to the character index of the key when a rule moves it to its event.
+ */
+typedef enum RustyKeyActions
+{
+    /** The character index stays. */
+    RKP_ACTION_NONE,
+
+    /** The character index goes back to the first character. */
+    RKP_ACTION_RESET_CHAR,
+
+    /** The character index moves to the next character. */
+    RKP_ACTION_NEXT_CHAR
+
+} RustyKeyActions;
+
+/**
+ * @brief The event of a rule that leaves the key as it is.
+ */
+#define RKP_NO_EVENT 0x0F
+
+/**
+ * @brief Builds a rule.
+ *
+ * @param timer      The timer the rule waits for, one of `RustyKeyTimers`.
+ * @param event      The event taken without a timer, or when the timer has expired.
+ * @param otherwise  The event taken while the timer is running.
+ * @param action     The action taken with `event`, one of `RustyKeyActions`.
+ */
+constexpr uint16_t rkpRule(uint8_t timer, uint8_t event, uint8_t otherwise, uint8_t action)
+{
+    return (uint16_t)(event | (otherwise << 4) | (timer << 8) | (action << 10));
+}
+
+/**
+ * @brief Returns the event taken without a timer, or when the timer of a rule has expired.
+ */
+constexpr uint8_t rkpRuleEvent(uint16_t rule) { return rule & 0x0F; }
+
+/**
+ * @brief Returns the event taken while the timer of a rule is running.
+ */
+constexpr uint8_t rkpRuleOtherwise(uint16_t rule) { return (rule >> 4) & 0x0F; }
+
+/**
+ * @brief Returns the timer of a rule.
+ */
+constexpr uint8_t rkpRuleTimer(uint16_t rule) { return (rule >> 8) & 0x03; }
+
+/**
+ * @brief Returns the action of a rule.
+ */
+constexpr uint8_t rkpRuleAction(uint16_t rule) { return (rule >> 10) & 0x03; }
+
+/**
+ * @brief The rules, indexed by T9 mode, role, sample and current event.
+ */
+extern const uint16_t rusty_key_table[2][4][4][RUSTY_KEYPAD_KEY_EVENTS] PROGMEM;
+
+/**
+ * @brief Returns the rules for a keypad type, indexed by role, sample and current event.
+ *
+ * @param t9 true if the keypad is in RKP_T9 mode.
+ */
+inline const uint16_t (*rkpRules(bool t9))[4][RUSTY_KEYPAD_KEY_EVENTS]
+{
+    return rusty_key_table[t9 ? 1 : 0];
+}
+
+/**
+ * @brief Looks a rule up in the table.
+ *
+ * @param rules  The rules for the keypad type, see `rkpRules`.
+ * @param role   One of `RustyKeyRoles`.
+ * @param sample One of `RustyKeySamples`.
+ * @param event  The current event of the key.
+ */
+inline uint16_t rkpTransition(const uint16_t (*rules)[4][RUSTY_KEYPAD_KEY_EVENTS], uint8_t role, uint8_t sample,
+                              uint8_t event)
+{
+    return pgm_read_word(&rules[role][sample][event]);
+}
+
+#endif
@@ -13,73 +13,151 @@ void RustyKeypad::scan()
         setFactoryConfig();
     }
 
+    disarmWakeup();
+    if (RustyBuzzer::hasPendingUpdate())
+    {
+        RustyBuzzer::update();
+    }
+    if (scanObserver != NULL && notificationSink == NULL)
+    {
+        scanObserver();
+    }
+    if (isIdleScanSkipped())
+    {
+        return;
+    }
+
     interrupted = false;
-    checkBuzzer();
-    RustyKeyNode *temp = KeyList->getHead();
+    text_deferred = true;
+    checkPasswordReveal();
+    char pressed_keys[RUSTY_KEYPAD_MAX_TEXT_LENGTH + 1];
+    uint8_t pressed_count = 0;
+    bool change = scanRows(sampleMatrix(), pressed_keys, pressed_count);
+    checkIdle(change || pressed_count > 0 || hasWaitKey() || !deadlines.isEmpty());
+    pressed_keys[pressed_count] = '\0';
+    if (change && pressed_count > 1 && (multipleKeyListener != NULL || notificationStream != NULL))
+        notifyText(RKP_NOTIFY_MULTIPLE_KEYS, pressed_keys);
+    flushTextChange();
+    if (streamUpdate != NULL)
+    {
+        streamUpdate();
+    }
+    if (selfTestStep != NULL && sampleSource == NULL)
+    {
+        selfTestStep();
+    }
+    if (scanObserver != NULL && notificationSink == NULL)
+    {
+        scanObserver();
+    }
+}
+
+template <int8_t T9>
+bool RustyKeypad::scanKeys(RustyRowBits rows, char *pressed_keys, uint8_t &pressed_count)
+{
     bool change = false;
-    String pressed_keys = "";
-    while (temp != nullptr)
+    bool stop = false;
+    RustyRowBits visited = 0;
+    for (uint8_t row = 0; rows != 0 && !stop; row++, rows >>= 1)
     {
-        if (checkWaitKey(temp->data))
+        if (!(rows & 1U))
         {
-            temp = temp->next;
             continue;
         }
-
-        if (checkKey(temp->data))
+        RustyKeyNode *temp = row_heads[row];
+        for (uint8_t col = 0; col < getColCount() && temp != nullptr; col++, temp = temp->next)
         {
-            change = !interrupted;
-        }
-        if (interrupted)
-            break;
-        if (temp->data->isPressed())
-        {
-            pressed_keys += String(temp->data->getKeyCode());
-            if (getType() == RKP_T9)
+            if (checkWaitKey(temp->data))
             {
-                setWaitKey(temp->data);
+                continue;
+            }
+
+            if (checkKey(temp->data, (key_bits[row] >> col) & 1U))
+            {
+                change = !interrupted;
+            }
+            if (interrupted)
+            {
+                stop = true;
                 break;
             }
+            if (temp->data->isPressed())
+            {
+                if (pressed_count < RUSTY_KEYPAD_MAX_TEXT_LENGTH)
+                {
+                    pressed_keys[pressed_count++] = temp->data->getKeyCode();
+                }
+                if (T9 > 0 || (T9 < 0 && getType() == RKP_T9))
+                {
+                    setWaitKey(temp->data);
+                    stop = true;
+                    break;
+                }
+            }
         }
-
-        temp = temp->next;
+        updateRowState(row);
+        visited |= (RustyRowBits)(1U << row);
     }
-    if (!change)
-        return;
-    if (pressed_keys.length() > 1 && multipleKeyListener != NULL)
-        multipleKeyListener(pressed_keys);
+    maskSkippedRows(visited);
+    return change;
+}
+
+#if defined(RUSTY_KEYPAD_GENERIC_SCAN)
+bool (*BaseRustyKeypad::scanRows)(RustyRowBits, char *, uint8_t &){&RustyKeypad::scanKeys<-1>};
+#else
+bool (*BaseRustyKeypad::scanRows)(RustyRowBits, char *, uint8_t &){&RustyKeypad::scanKeys<0>};
+#endif
+
+void BaseRustyKeypad::selectScanRoutine()
+{
+#if defined(RUSTY_KEYPAD_GENERIC_SCAN)
+    scanRows = &RustyKeypad::scanKeys<-1>;
+#else
+    scanRows = (keypad_type == RKP_T9 ? &RustyKeypad::scanKeys<1> : &RustyKeypad::scanKeys<0>);
+#endif
+    RustyKey::selectRules(keypad_type == RKP_T9);
 }
 
-bool RustyKeypad::checkKey(RustyKey *key)
+bool RustyKeypad::checkKey(RustyKey *key, bool pressed)
 {
-    if (!key->check())
+    if (!key->check(pressed))
     {
         return false;
     }
+#if defined(RUSTY_KEYPAD_LATENCY)
+    RustyLatency::record(key->getIndex(), key->getCurrentEvent());
+#endif
     switch (key->getCurrentEvent())
     {
     case KeypadEventTypes::RKP_KEY_DOWN:
-        if (keyDownListener != NULL)
+        if (keyDownListener != NULL || notificationStream != NULL)
         {
-            keyDownListener(key->getKeyCode());
+            notifyKey(RKP_NOTIFY_KEY_DOWN, key->getKeyCode());
         }
         beepBuzzer(1);
         break;
     case KeypadEventTypes::RKP_T9_NEXT_CHAR:
-        textChangeListener(getKeypadData() + String(key->getKeyCode()));
+        markTextPreview(key->getKeyCode());
         break;
     case KeypadEventTypes::RKP_KEY_UP:
-        appendKey(key->getKeyCode());
-        if (keyUpListener != NULL)
+        if (isCursorKey(key->getFirstKeyCode()))
+        {
+            moveCursor(key->getFirstKeyCode());
+        }
+        else
+        {
+            appendKey(key->getKeyCode());
+        }
+        if (keyUpListener != NULL || notificationObserver != NULL || notificationStream != NULL)
         {
-            keyUpListener(key->getKeyCode());
+            notifyKey(RKP_NOTIFY_KEY_UP, key->getKeyCode());
         }
         resetWaitKey();
         break;
     case KeypadEventTypes::RKP_LONG_PRESS:
-        if (longPressListener != NULL)
+        if (longPressListener != NULL || notificationStream != NULL)
         {
-            longPressListener(key->getKeyCode());
+            notifyKey(RKP_NOTIFY_LONG_PRESS, key->getKeyCode());
         }
         resetWaitKey();
         break;
@@ -87,9 +165,9 @@ bool RustyKeypad::checkKey(RustyKey *key)
     case KeypadEventTypes::RKP_PRESS_DELETE:
         setWaitKey(key);
         deleteChar();
-        if (onDeleteListener != NULL)
+        if (onDeleteListener != NULL || notificationStream != NULL)
         {
-            onDeleteListener(getDeleteKey());
+            notifyKey(RKP_NOTIFY_DELETE, getDeleteKey());
         }
         beepBuzzer(2);
         break;
@@ -102,9 +180,11 @@ bool RustyKeypad::checkKey(RustyKey *key)
         break;
     case KeypadEventTypes::RKP_PRESS_ENTER:
         setWaitKey(key);
-        if (onEnterListener != NULL)
+        checkCredential();
+        if (onEnterListener != NULL || notificationObserver != NULL || notificationStream != NULL)
         {
-            onEnterListener(getKeypadData());
+            char text[RUSTY_KEYPAD_MAX_TEXT_LENGTH + 2];
+            notifyText(RKP_NOTIFY_ENTER, getEnterText(text));
         }
         beepBuzzer(10);
         break;
@@ -34,9 +34,11 @@
 #define RUSTY_KEYPAD_H
 
 #include <base_keypad.h>
+#include <rusty_footprint.h>
 
 class RustyKeypad : public BaseRustyKeypad
 {
+    friend class BaseRustyKeypad;
 
 public:
     /**
@@ -50,6 +52,21 @@ public:
     static void scan();
 
 private:
+    /**
+     * @brief Checks the keys of the given rows; the routines behind `scanRows`.
+     *
+     * The routine is compiled once per value of `T9`, so the loop over the keys carries no type check:
+     * `1` for RKP_T9, where the first pressed key is waited for and ends the scan, `0` for the other
+     * types, and `-1` for the generic routine that asks `getType()` for every pressed key.
+     *
+     * @param rows          A bit per row to check.
+     * @param pressed_keys  Receives the codes of the pressed keys.
+     * @param pressed_count The number of codes in `pressed_keys`.
+     * @return true if a key changed its event, otherwise false.
+     */
+    template <int8_t T9>
+    static bool scanKeys(RustyRowBits rows, char *pressed_keys, uint8_t &pressed_count);
+
     /**
      * @brief Analyzes the state of a given key for any changes.
      *
@@ -59,8 +76,9 @@ private:
      * behavior accordingly.
      *
      * @param key A pointer to the `RustyKey` object to be analyzed.
+     * @param pressed The state of the key read by `sampleMatrix()`.
      * @return `true` if there are changes in the key's state; otherwise, `false`.
      */
-    static bool checkKey(RustyKey *key);
+    static bool checkKey(RustyKey *key, bool pressed);
 };
 #endif
\ No newline at end of file
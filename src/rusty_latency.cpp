@@ -0,0 +1,118 @@
+#include <rusty_latency.h>
+
+#if defined(RUSTY_KEYPAD_LATENCY)
+
+uint16_t RustyLatency::histogram[RUSTY_KEYPAD_LATENCY_EVENTS][RUSTY_KEYPAD_LATENCY_BUCKETS]{};
+unsigned long RustyLatency::max_us[RUSTY_KEYPAD_LATENCY_EVENTS]{};
+unsigned long RustyLatency::edge_us[RUSTY_KEYPAD_MAX_KEYS]{};
+uint8_t RustyLatency::edge_pending[(RUSTY_KEYPAD_MAX_KEYS + 7) / 8]{};
+unsigned long RustyLatency::sample_us{0};
+
+uint16_t RustyLatency::getCount(KeypadEventTypes event, uint8_t bucket)
+{
+    if (event >= RUSTY_KEYPAD_LATENCY_EVENTS || bucket >= RUSTY_KEYPAD_LATENCY_BUCKETS)
+    {
+        return 0;
+    }
+    return histogram[event][bucket];
+}
+
+uint32_t RustyLatency::getTotal(KeypadEventTypes event)
+{
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < RUSTY_KEYPAD_LATENCY_BUCKETS; i++)
+    {
+        total += getCount(event, i);
+    }
+    return total;
+}
+
+unsigned long RustyLatency::getBucketLimit(uint8_t bucket)
+{
+    if (bucket >= 31)
+    {
+        return 0xFFFFFFFFUL;
+    }
+    return (1UL << (bucket + 1));
+}
+
+unsigned long RustyLatency::getMax(KeypadEventTypes event)
+{
+    return (event < RUSTY_KEYPAD_LATENCY_EVENTS ? max_us[event] : 0);
+}
+
+unsigned long RustyLatency::getPercentile(KeypadEventTypes event, uint8_t percent)
+{
+    uint32_t total = getTotal(event);
+    if (total == 0)
+    {
+        return 0;
+    }
+    if (percent > 100)
+    {
+        percent = 100;
+    }
+    uint32_t target = (total * percent + 99) / 100;
+    uint32_t seen = 0;
+    for (uint8_t i = 0; i < RUSTY_KEYPAD_LATENCY_BUCKETS - 1; i++)
+    {
+        seen += histogram[event][i];
+        if (seen >= target)
+        {
+            unsigned long limit = getBucketLimit(i);
+            return (max_us[event] < limit ? max_us[event] : limit);
+        }
+    }
+    return max_us[event];
+}
+
+void RustyLatency::reset()
+{
+    memset(histogram, 0, sizeof(histogram));
+    memset(max_us, 0, sizeof(max_us));
+}
+
+void RustyLatency::startSample()
+{
+    sample_us = micros();
+}
+
+void RustyLatency::sampleKey(RustyKeyIndex index, bool changed)
+{
+    uint8_t mask = (uint8_t)(1U << (index & 7));
+    uint8_t &pending = edge_pending[index >> 3];
+    if (!changed)
+    {
+        pending &= (uint8_t)~mask;
+        return;
+    }
+    if (!(pending & mask))
+    {
+        pending |= mask;
+        edge_us[index] = sample_us;
+    }
+}
+
+void RustyLatency::record(RustyKeyIndex index, KeypadEventTypes event)
+{
+    if (event == RKP_KEY_IDLE || event == RKP_WAIT || event >= RUSTY_KEYPAD_LATENCY_EVENTS)
+    {
+        return;
+    }
+    unsigned long latency = micros() - edge_us[index];
+    uint8_t bucket = 0;
+    for (unsigned long rest = latency >> 1; rest != 0 && bucket < RUSTY_KEYPAD_LATENCY_BUCKETS - 1; rest >>= 1)
+    {
+        bucket++;
+    }
+    if (histogram[event][bucket] < 0xFFFF)
+    {
+        histogram[event][bucket]++;
+    }
+    if (latency > max_us[event])
+    {
+        max_us[event] = latency;
+    }
+}
+
+#endif
@@ -0,0 +1,158 @@
+/*
+ * RustyLatency Class
+ *
+ * Author: Aras TAŞKIRAN
+ * Email: aras@arastaskiran.com
+ * Date: 2024-09-2024
+ *
+ * Description:
+ *
+ * Measures how long it takes from the moment a key changes on the matrix until
+ * the keypad hands the resulting event to the listeners. The time starts with
+ * the first scan that samples the new state of the key, so the key filter, the
+ * hold times and the T9 delays are all part of it.
+ *
+ * With RUSTY_KEYPAD_LATENCY defined, every event is counted in a histogram of
+ * its event type. Bucket n holds the latencies from 2^n to 2^(n+1)
+ * microseconds, so a few hundred bytes cover everything from a fast scan to a
+ * long press, and the percentiles can be read while the device runs.
+ *
+ * License:
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUSTY_KEYPAD_LATENCY_H
+#define RUSTY_KEYPAD_LATENCY_H
+
+#if defined(RUSTY_KEYPAD_LATENCY)
+
+#include <stdint.h>
+#include <Arduino.h>
+#include <rusty_key.h>
+
+/**
+ * @brief Number of log2 buckets in each histogram.
+ *
+ * The last bucket also counts every latency above its range. The default of 22 buckets ends at
+ * about 2 seconds, which covers the long press and the T9 durations.
+ */
+#ifndef RUSTY_KEYPAD_LATENCY_BUCKETS
+#define RUSTY_KEYPAD_LATENCY_BUCKETS 22
+#endif
+
+#if RUSTY_KEYPAD_LATENCY_BUCKETS < 1 || RUSTY_KEYPAD_LATENCY_BUCKETS > 32
+#error "RUSTY_KEYPAD_LATENCY_BUCKETS must be between 1 and 32"
+#endif
+
+/**
+ * @brief Number of event types with a histogram.
+ */
+#define RUSTY_KEYPAD_LATENCY_EVENTS RUSTY_KEYPAD_KEY_EVENTS
+
+/**
+ * @class RustyLatency
+ * @brief Histograms of the time from a key edge to its event, per event type.
+ *
+ * The histograms are written by the scan. They are not protected against concurrent access; when
+ * the keypad is scanned by `RustyScanTask`, read them between `RustyScanTask::lock()` and
+ * `RustyScanTask::unlock()`.
+ */
+class RustyLatency
+{
+    friend class RustyKey;
+    friend class BaseRustyKeypad;
+    friend class RustyKeypad;
+
+public:
+    /**
+     * @brief Returns the number of events counted in a bucket.
+     *
+     * @param event  The event type.
+     * @param bucket The bucket, 0 to `RUSTY_KEYPAD_LATENCY_BUCKETS - 1`.
+     * @return The number of events, it stops at 65535.
+     */
+    static uint16_t getCount(KeypadEventTypes event, uint8_t bucket);
+
+    /**
+     * @brief Returns the number of events of a type counted in all buckets.
+     *
+     * @param event The event type.
+     */
+    static uint32_t getTotal(KeypadEventTypes event);
+
+    /**
+     * @brief Returns the upper limit of a bucket in microseconds.
+     *
+     * Bucket n counts the latencies below `2^(n+1)` microseconds that didn't fit into bucket n - 1.
+     *
+     * @param bucket The bucket.
+     */
+    static unsigned long getBucketLimit(uint8_t bucket);
+
+    /**
+     * @brief Returns the longest latency seen for an event type in microseconds.
+     *
+     * @param event The event type.
+     */
+    static unsigned long getMax(KeypadEventTypes event);
+
+    /**
+     * @brief Returns the latency under which the given share of the events stayed.
+     *
+     * The result is the upper limit of the bucket holding the percentile, or the longest latency
+     * seen when that bucket is the last one, so it never underestimates.
+     *
+     * @param event   The event type.
+     * @param percent The share of the events, 1 to 100.
+     * @return The latency in microseconds, or 0 if no event of this type has been counted.
+     */
+    static unsigned long getPercentile(KeypadEventTypes event, uint8_t percent);
+
+    /**
+     * @brief Clears all histograms.
+     */
+    static void reset();
+
+private:
+    /**
+     * @brief Stores the time of the current scan; the keys compare their state right after it.
+     */
+    static void startSample();
+
+    /**
+     * @brief Remembers when a key was first seen in a new state.
+     *
+     * @param index   The index of the key.
+     * @param changed true if the sampled state differs from the state of the key.
+     */
+    static void sampleKey(RustyKeyIndex index, bool changed);
+
+    /**
+     * @brief Counts an event of a key, measured from the last edge of the key until now.
+     *
+     * @param index The index of the key.
+     * @param event The event type; idle and wait are not counted.
+     */
+    static void record(RustyKeyIndex index, KeypadEventTypes event);
+
+    static uint16_t histogram[RUSTY_KEYPAD_LATENCY_EVENTS][RUSTY_KEYPAD_LATENCY_BUCKETS];
+    static unsigned long max_us[RUSTY_KEYPAD_LATENCY_EVENTS];
+    static unsigned long edge_us[RUSTY_KEYPAD_MAX_KEYS];
+    static uint8_t edge_pending[(RUSTY_KEYPAD_MAX_KEYS + 7) / 8];
+    static unsigned long sample_us;
+};
+
+#endif
+#endif
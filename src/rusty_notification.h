@@ -0,0 +1,113 @@
+/*
+ * RustyKeypadNotification
+ *
+ * Author: Aras TAŞKIRAN
+ * Email: aras@arastaskiran.com
+ * Date: 2024-09-2024
+ *
+ * Description:
+ *
+ * Every listener call of the keypad is described by a notification. Normally the
+ * listener is called right away, but when the keys are scanned in a task of their
+ * own, the notifications are copied into a queue and the listeners run later in
+ * the application task. The text is copied as well, so a notification stays valid
+ * after the keypad has moved on.
+ *
+ * License:
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUSTY_KEYPAD_NOTIFICATION_H
+#define RUSTY_KEYPAD_NOTIFICATION_H
+
+#include <stdint.h>
+#include <rusty_text_buffer.h>
+
+/**
+ * @enum KeypadNotifyTypes
+ * @brief Identifies the listener a notification is meant for.
+ */
+typedef enum KeypadNotifyTypes
+{
+    /** The text has changed, see `addTextChangeListener`. */
+    RKP_NOTIFY_TEXT_CHANGE,
+
+    /** A key has been pressed, see `addKeyDownListener`. */
+    RKP_NOTIFY_KEY_DOWN,
+
+    /** A key has been released, see `addKeyUpListener`. */
+    RKP_NOTIFY_KEY_UP,
+
+    /** A key has been held down, see `addLongPressListener`. */
+    RKP_NOTIFY_LONG_PRESS,
+
+    /** Several keys are pressed together, see `addMultipleKeyListener`. */
+    RKP_NOTIFY_MULTIPLE_KEYS,
+
+    /** The enter key has been pressed, see `addEnterActionListener`. */
+    RKP_NOTIFY_ENTER,
+
+    /** The delete key has been pressed, see `addDeleteActionListener`. */
+    RKP_NOTIFY_DELETE,
+
+    /** The cursor has moved, see `addCursorMoveListener`. */
+    RKP_NOTIFY_CURSOR_MOVE,
+
+    /** A credential has been checked, see `addCredentialListener`. */
+    RKP_NOTIFY_CREDENTIAL,
+
+    /** The idle state has changed, see `addIdleListener`. */
+    RKP_NOTIFY_IDLE,
+
+    /** The self-test found a fault, see `addFaultListener`. */
+    RKP_NOTIFY_FAULT
+
+} KeypadNotifyTypes;
+
+/**
+ * @enum RustyTextChanges
+ * @brief What happened to the text since the last text change notification, a bit each.
+ */
+typedef enum RustyTextChanges
+{
+    /** A character was added. */
+    RKP_TEXT_INSERT = 0x01,
+
+    /** A character was deleted. */
+    RKP_TEXT_DELETE = 0x02,
+
+    /** The text was cleared. */
+    RKP_TEXT_CLEAR = 0x04,
+
+    /** A revealed password character was masked again. */
+    RKP_TEXT_CONCEAL = 0x08,
+
+    /** The text shows the RKP_T9 character that is being selected. */
+    RKP_TEXT_PREVIEW = 0x10
+
+} RustyTextChanges;
+
+/**
+ * @brief A listener call, copied so that it can be delivered later.
+ */
+struct RustyKeypadNotification
+{
+    uint8_t type;                                  /**< One of `KeypadNotifyTypes`. */
+    char key;                                      /**< The key of key notifications. */
+    uint16_t value;                                /**< Text changes, cursor position, credential id, idle state or fault lines. */
+    char text[RUSTY_KEYPAD_MAX_TEXT_LENGTH + 2];   /**< The text of text notifications, with room for a T9 preview character. */
+};
+
+#endif
@@ -0,0 +1,107 @@
+#include <rusty_recorder.h>
+
+Print *RustyRecorder::output{nullptr};
+RustyRowBits RustyRecorder::sample[MAX_KEYPAD_MATRIX_SIZE];
+uint8_t RustyRecorder::row_count{0};
+unsigned long RustyRecorder::last_ts{0};
+uint32_t RustyRecorder::run{0};
+uint32_t RustyRecorder::run_delta{0};
+bool RustyRecorder::run_changed{false};
+uint32_t RustyRecorder::scans{0};
+
+void RustyRecorder::start(Print &out)
+{
+    stop();
+    output = &out;
+    row_count = BaseRustyKeypad::getRowCount();
+    last_ts = millis();
+    run = 0;
+    scans = 0;
+    memset(sample, 0, sizeof(sample));
+
+    output->write((const uint8_t *)"RKR", 3);
+    output->write((uint8_t)RUSTY_KEYPAD_RECORDING_VERSION);
+    output->write(row_count);
+    output->write(BaseRustyKeypad::getColCount());
+    output->write((uint8_t)sizeof(RustyRowBits));
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        output->write((uint8_t)(last_ts >> (8 * i)));
+    }
+    BaseRustyKeypad::sampleObserver = &RustyRecorder::observe;
+}
+
+void RustyRecorder::stop()
+{
+    if (output == nullptr)
+    {
+        return;
+    }
+    flush();
+    BaseRustyKeypad::sampleObserver = NULL;
+    output = nullptr;
+}
+
+void RustyRecorder::flush()
+{
+    if (output == nullptr || run == 0)
+    {
+        return;
+    }
+    writeVarint((run << 1) | (run_changed ? 1U : 0U));
+    writeVarint(run_delta);
+    if (run_changed)
+    {
+        for (uint8_t i = 0; i < row_count; i++)
+        {
+            for (uint8_t b = 0; b < sizeof(RustyRowBits); b++)
+            {
+                output->write((uint8_t)(sample[i] >> (8 * b)));
+            }
+        }
+    }
+    run = 0;
+}
+
+bool RustyRecorder::isRecording()
+{
+    return output != nullptr;
+}
+
+uint32_t RustyRecorder::getScanCount()
+{
+    return scans;
+}
+
+void RustyRecorder::observe(const RustyRowBits *rows, uint8_t count)
+{
+    unsigned long now = millis();
+    uint32_t delta = now - last_ts;
+    last_ts = now;
+    scans++;
+    if (count > row_count)
+    {
+        count = row_count;
+    }
+    bool changed = (memcmp(rows, sample, count * sizeof(RustyRowBits)) != 0);
+    if (run > 0 && !changed && delta == run_delta && run < 0x7FFFFFFFUL)
+    {
+        run++;
+        return;
+    }
+    flush();
+    memcpy(sample, rows, count * sizeof(RustyRowBits));
+    run = 1;
+    run_delta = delta;
+    run_changed = changed;
+}
+
+void RustyRecorder::writeVarint(uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        output->write((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    output->write((uint8_t)value);
+}
@@ -0,0 +1,124 @@
+/*
+ * RustyRecorder Class
+ *
+ * Author: Aras TAŞKIRAN
+ * Email: aras@arastaskiran.com
+ * Date: 2024-09-2024
+ *
+ * Description:
+ *
+ * Bugs like a missed T9 commit or a phantom long press depend on the exact
+ * times at which the keys were sampled, and can't be reproduced by pressing the
+ * keys again. RustyRecorder writes every raw matrix sample of scan() with its
+ * time to a Print, e.g. Serial or a file. RustyReplay reads the recording back
+ * and feeds it to the keys, so the same events come out again, on the device or
+ * on a PC many times faster than real time (see extras/replay).
+ *
+ * The recording is run-length encoded: consecutive scans with the same sample
+ * and the same distance in time are stored as a single entry, so an idle keypad
+ * scanned at a steady rate costs a few bytes.
+ *
+ * License:
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUSTY_KEYPAD_RECORDER_H
+#define RUSTY_KEYPAD_RECORDER_H
+
+#include <stdint.h>
+#include <Arduino.h>
+#include <base_keypad.h>
+
+/**
+ * @brief Version of the recording format.
+ */
+#define RUSTY_KEYPAD_RECORDING_VERSION 1
+
+/**
+ * @brief Size of the recording header in bytes.
+ */
+#define RUSTY_KEYPAD_RECORDING_HEADER_SIZE 11
+
+/**
+ * @class RustyRecorder
+ * @brief Records the raw matrix samples of the keypad.
+ *
+ * A recording starts with the header: the characters "RKR", the format version, the number of rows,
+ * the number of columns, the bytes per row and the time of `start()` in milliseconds (32 bits).
+ * Each entry that follows is a varint holding `scans << 1 | changed`, a varint with the milliseconds
+ * between two scans of the entry (and between the previous scan and the first one), and, if
+ * `changed` is set, the new sample with the given bytes per row. All numbers are little endian, the
+ * varints carry 7 bits per byte with the high bit set on all bytes but the last.
+ *
+ * Start the recording right after `keyboardSetup()`, so that a replay which sets the keypad up the
+ * same way at the time of the header starts from the same state.
+ */
+class RustyRecorder
+{
+public:
+    /**
+     * @brief Writes the header and starts recording every sample.
+     *
+     * A recording in progress is stopped first.
+     *
+     * @param out The output of the recording. It must stay valid until `stop()`.
+     */
+    static void start(Print &out);
+
+    /**
+     * @brief Writes the last entry and stops recording.
+     */
+    static void stop();
+
+    /**
+     * @brief Writes the entry that is still being counted.
+     *
+     * Entries are written when the sample or the scan period changes; call this to get the
+     * recording up to date, e.g. before the device is switched off.
+     */
+    static void flush();
+
+    /**
+     * @brief Checks if a recording is in progress.
+     */
+    static bool isRecording();
+
+    /**
+     * @brief Returns the number of scans recorded since `start()`.
+     */
+    static uint32_t getScanCount();
+
+private:
+    /**
+     * @brief Counts a sample into the current entry or starts a new entry; set as `sampleObserver`.
+     */
+    static void observe(const RustyRowBits *rows, uint8_t count);
+
+    /**
+     * @brief Writes a number as a varint.
+     */
+    static void writeVarint(uint32_t value);
+
+    static Print *output;
+    static RustyRowBits sample[MAX_KEYPAD_MATRIX_SIZE];
+    static uint8_t row_count;
+    static unsigned long last_ts;
+    static uint32_t run;
+    static uint32_t run_delta;
+    static bool run_changed;
+    static uint32_t scans;
+};
+
+#endif
@@ -0,0 +1,139 @@
+#include <rusty_replay.h>
+
+const uint8_t *RustyReplay::data{nullptr};
+size_t RustyReplay::length{0};
+size_t RustyReplay::position{0};
+RustyRowBits RustyReplay::current[MAX_KEYPAD_MATRIX_SIZE];
+unsigned long RustyReplay::time{0};
+uint32_t RustyReplay::run_left{0};
+uint32_t RustyReplay::run_delta{0};
+uint32_t RustyReplay::scans{0};
+uint8_t RustyReplay::rows{0};
+uint8_t RustyReplay::cols{0};
+uint8_t RustyReplay::row_bytes{0};
+
+bool RustyReplay::begin(const uint8_t *recording, size_t size)
+{
+    end();
+    if (size < RUSTY_KEYPAD_RECORDING_HEADER_SIZE || memcmp(recording, "RKR", 3) != 0 ||
+        recording[3] != RUSTY_KEYPAD_RECORDING_VERSION || recording[6] == 0 || recording[6] > 4)
+    {
+        return false;
+    }
+    data = recording;
+    length = size;
+    rows = recording[4];
+    cols = recording[5];
+    row_bytes = recording[6];
+    time = 0;
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        time |= (unsigned long)recording[7 + i] << (8 * i);
+    }
+    position = RUSTY_KEYPAD_RECORDING_HEADER_SIZE;
+    run_left = 0;
+    scans = 0;
+    memset(current, 0, sizeof(current));
+    BaseRustyKeypad::sampleSource = &RustyReplay::sample;
+    return true;
+}
+
+bool RustyReplay::next()
+{
+    if (data == nullptr)
+    {
+        return false;
+    }
+    if (run_left == 0)
+    {
+        uint32_t entry;
+        if (!readVarint(entry) || !readVarint(run_delta) || (entry >> 1) == 0)
+        {
+            end();
+            return false;
+        }
+        run_left = entry >> 1;
+        if (entry & 1U)
+        {
+            if (length - position < (size_t)rows * row_bytes)
+            {
+                end();
+                return false;
+            }
+            for (uint8_t i = 0; i < rows; i++)
+            {
+                uint32_t bits = 0;
+                for (uint8_t b = 0; b < row_bytes; b++)
+                {
+                    bits |= (uint32_t)data[position++] << (8 * b);
+                }
+                if (i < MAX_KEYPAD_MATRIX_SIZE)
+                {
+                    current[i] = (RustyRowBits)bits;
+                }
+            }
+        }
+    }
+    run_left--;
+    time += run_delta;
+    scans++;
+    return true;
+}
+
+void RustyReplay::end()
+{
+    if (data == nullptr)
+    {
+        return;
+    }
+    BaseRustyKeypad::sampleSource = NULL;
+    data = nullptr;
+}
+
+bool RustyReplay::isReplaying()
+{
+    return data != nullptr;
+}
+
+unsigned long RustyReplay::getTime()
+{
+    return time;
+}
+
+uint32_t RustyReplay::getScanCount()
+{
+    return scans;
+}
+
+uint8_t RustyReplay::getRowCount()
+{
+    return rows;
+}
+
+uint8_t RustyReplay::getColCount()
+{
+    return cols;
+}
+
+void RustyReplay::sample(RustyRowBits *out, uint8_t row_count)
+{
+    for (uint8_t i = 0; i < row_count; i++)
+    {
+        out[i] = (i < rows && i < MAX_KEYPAD_MATRIX_SIZE ? current[i] : 0);
+    }
+}
+
+bool RustyReplay::readVarint(uint32_t &value)
+{
+    value = 0;
+    for (uint8_t shift = 0; shift < 35 && position < length; shift += 7)
+    {
+        uint8_t byte = data[position++];
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+        {
+            return true;
+        }
+    }
+    return false;
+}
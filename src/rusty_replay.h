@@ -0,0 +1,136 @@
+/*
+ * RustyReplay Class
+ *
+ * Author: Aras TAŞKIRAN
+ * Email: aras@arastaskiran.com
+ * Date: 2024-09-2024
+ *
+ * Description:
+ *
+ * Plays a recording of RustyRecorder back through the keypad. The recorded
+ * samples replace the pins, and the caller runs the clock: for every recorded
+ * scan it sets millis() to getTime() and calls scan(). With the keypad set up
+ * as it was on the device, the keys go through exactly the same states and the
+ * same listeners are called at the same times.
+ *
+ * License:
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUSTY_KEYPAD_REPLAY_H
+#define RUSTY_KEYPAD_REPLAY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <Arduino.h>
+#include <base_keypad.h>
+#include <rusty_recorder.h>
+
+/**
+ * @class RustyReplay
+ * @brief Feeds a recording of matrix samples to the keypad.
+ *
+ * A replay loop looks like this, where `setClock()` is whatever sets `millis()` on the platform:
+ *
+ * @code
+ * RustyReplay::begin(data, length);
+ * setClock(RustyReplay::getTime());
+ * RustyKeypad::keyboardSetup(...);   // as on the device
+ * RustyKeypad::enable();
+ * while (RustyReplay::next())
+ * {
+ *     setClock(RustyReplay::getTime());
+ *     RustyKeypad::scan();
+ * }
+ * @endcode
+ */
+class RustyReplay
+{
+public:
+    /**
+     * @brief Checks the header of a recording and takes over the samples of the keypad.
+     *
+     * @param recording The recording. It must stay valid until the replay ends.
+     * @param size      The size of the recording in bytes.
+     * @return false if the data doesn't start with a valid header, otherwise true.
+     */
+    static bool begin(const uint8_t *recording, size_t size);
+
+    /**
+     * @brief Moves to the next recorded scan.
+     *
+     * @return false at the end of the recording, which also ends the replay.
+     */
+    static bool next();
+
+    /**
+     * @brief Ends the replay; the keypad reads the pins again.
+     */
+    static void end();
+
+    /**
+     * @brief Checks if a replay is in progress.
+     */
+    static bool isReplaying();
+
+    /**
+     * @brief Returns the time of the current scan in milliseconds.
+     *
+     * After `begin()` this is the time the recording was started.
+     */
+    static unsigned long getTime();
+
+    /**
+     * @brief Returns the number of scans replayed since `begin()`.
+     */
+    static uint32_t getScanCount();
+
+    /**
+     * @brief Returns the number of rows of the recorded keypad.
+     */
+    static uint8_t getRowCount();
+
+    /**
+     * @brief Returns the number of columns of the recorded keypad.
+     */
+    static uint8_t getColCount();
+
+private:
+    /**
+     * @brief Copies the current sample into the keypad; set as `sampleSource`.
+     */
+    static void sample(RustyRowBits *out, uint8_t row_count);
+
+    /**
+     * @brief Reads a varint.
+     *
+     * @return false if the recording ends in the middle of the number.
+     */
+    static bool readVarint(uint32_t &value);
+
+    static const uint8_t *data;
+    static size_t length;
+    static size_t position;
+    static RustyRowBits current[MAX_KEYPAD_MATRIX_SIZE];
+    static unsigned long time;
+    static uint32_t run_left;
+    static uint32_t run_delta;
+    static uint32_t scans;
+    static uint8_t rows;
+    static uint8_t cols;
+    static uint8_t row_bytes;
+};
+
+#endif
@@ -0,0 +1,247 @@
+#include <rusty_scan_task.h>
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+
+static TaskHandle_t scan_task{nullptr};
+static QueueHandle_t notification_queue{nullptr};
+static SemaphoreHandle_t keypad_mutex{nullptr};
+#if defined(RUSTY_KEYPAD_STATIC_ALLOCATION)
+static StaticTask_t scan_task_buffer;
+static StackType_t scan_task_stack[RUSTY_KEYPAD_SCAN_TASK_STACK_SIZE / sizeof(StackType_t)];
+static StaticQueue_t notification_queue_buffer;
+static uint8_t notification_queue_storage[RUSTY_KEYPAD_NOTIFICATION_QUEUE_SIZE * sizeof(RustyKeypadNotification)];
+static StaticSemaphore_t keypad_mutex_buffer;
+#endif
+
+static void scanTaskMain(void *arg)
+{
+    TickType_t last_wake = xTaskGetTickCount();
+    TickType_t period = pdMS_TO_TICKS(*(unsigned long *)arg);
+    if (period == 0)
+    {
+        period = 1;
+    }
+    while (true)
+    {
+        RustyScanTask::lock();
+        RustyKeypad::scan();
+        RustyScanTask::unlock();
+        vTaskDelayUntil(&last_wake, period);
+    }
+}
+#elif !defined(ARDUINO)
+#include <thread>
+#include <mutex>
+#include <chrono>
+
+static std::thread scan_thread;
+static std::mutex queue_mutex;
+static std::recursive_mutex keypad_mutex;
+static RustyKeypadNotification notification_queue[RUSTY_KEYPAD_NOTIFICATION_QUEUE_SIZE];
+static uint8_t queue_head{0};
+static uint8_t queue_length{0};
+#endif
+
+unsigned long RustyScanTask::scan_period{5};
+uint16_t RustyScanTask::dropped{0};
+#if defined(ARDUINO)
+volatile bool RustyScanTask::running{false};
+#else
+std::atomic<bool> RustyScanTask::running{false};
+#endif
+
+bool RustyScanTask::start(unsigned long period, int8_t core, uint8_t priority, uint32_t stack_size)
+{
+#if defined(RUSTY_KEYPAD_HAS_SCAN_TASK)
+    if (running)
+    {
+        return false;
+    }
+    scan_period = period;
+    dropped = 0;
+#if defined(ESP32)
+    if (keypad_mutex == nullptr)
+    {
+#if defined(RUSTY_KEYPAD_STATIC_ALLOCATION)
+        keypad_mutex = xSemaphoreCreateRecursiveMutexStatic(&keypad_mutex_buffer);
+        notification_queue = xQueueCreateStatic(RUSTY_KEYPAD_NOTIFICATION_QUEUE_SIZE, sizeof(RustyKeypadNotification),
+                                                notification_queue_storage, &notification_queue_buffer);
+#else
+        keypad_mutex = xSemaphoreCreateRecursiveMutex();
+        notification_queue = xQueueCreate(RUSTY_KEYPAD_NOTIFICATION_QUEUE_SIZE, sizeof(RustyKeypadNotification));
+#endif
+        if (keypad_mutex == nullptr || notification_queue == nullptr)
+        {
+            return false;
+        }
+    }
+    BaseRustyKeypad::notificationSink = &RustyScanTask::post;
+    running = true;
+#if defined(RUSTY_KEYPAD_STATIC_ALLOCATION)
+    (void)stack_size;
+    scan_task = xTaskCreateStaticPinnedToCore(scanTaskMain, "rusty_keypad", RUSTY_KEYPAD_SCAN_TASK_STACK_SIZE,
+                                              &scan_period, priority, scan_task_stack, &scan_task_buffer,
+                                              (core < 0 ? tskNO_AFFINITY : core));
+    BaseType_t created = (scan_task != nullptr ? pdPASS : pdFAIL);
+#else
+    BaseType_t created = xTaskCreatePinnedToCore(scanTaskMain, "rusty_keypad", stack_size, &scan_period, priority,
+                                                 &scan_task, (core < 0 ? tskNO_AFFINITY : core));
+#endif
+    if (created != pdPASS)
+    {
+        running = false;
+        BaseRustyKeypad::notificationSink = NULL;
+        return false;
+    }
+#else
+    (void)core;
+    (void)priority;
+    (void)stack_size;
+    BaseRustyKeypad::notificationSink = &RustyScanTask::post;
+    running = true;
+    scan_thread = std::thread([]()
+                              {
+        std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+        while (running)
+        {
+            scanOnce();
+            next += std::chrono::milliseconds(scan_period);
+            std::this_thread::sleep_until(next);
+        } });
+#endif
+    return true;
+#else
+    return false;
+#endif
+}
+
+void RustyScanTask::stop()
+{
+    if (!running)
+    {
+        return;
+    }
+#if defined(ESP32)
+    lock();
+    vTaskDelete(scan_task);
+    scan_task = nullptr;
+    running = false;
+    BaseRustyKeypad::notificationSink = NULL;
+    unlock();
+#elif !defined(ARDUINO)
+    running = false;
+    scan_thread.join();
+    BaseRustyKeypad::notificationSink = NULL;
+#endif
+}
+
+bool RustyScanTask::isRunning()
+{
+    return running;
+}
+
+uint8_t RustyScanTask::dispatch()
+{
+    RustyKeypadNotification notification;
+    uint8_t count = 0;
+    while (take(notification))
+    {
+        lock();
+        BaseRustyKeypad::dispatchNotification(notification);
+        if (BaseRustyKeypad::scanObserver != NULL)
+        {
+            BaseRustyKeypad::scanObserver();
+        }
+        unlock();
+        count++;
+    }
+    if (count == 0 && BaseRustyKeypad::scanObserver != NULL)
+    {
+        lock();
+        BaseRustyKeypad::scanObserver();
+        unlock();
+    }
+    return count;
+}
+
+void RustyScanTask::lock()
+{
+#if defined(ESP32)
+    if (keypad_mutex != nullptr)
+    {
+        xSemaphoreTakeRecursive(keypad_mutex, portMAX_DELAY);
+    }
+#elif !defined(ARDUINO)
+    keypad_mutex.lock();
+#endif
+}
+
+void RustyScanTask::unlock()
+{
+#if defined(ESP32)
+    if (keypad_mutex != nullptr)
+    {
+        xSemaphoreGiveRecursive(keypad_mutex);
+    }
+#elif !defined(ARDUINO)
+    keypad_mutex.unlock();
+#endif
+}
+
+uint16_t RustyScanTask::getDroppedNotifications()
+{
+#if !defined(ARDUINO)
+    std::lock_guard<std::mutex> guard(queue_mutex);
+#endif
+    return dropped;
+}
+
+bool RustyScanTask::post(const RustyKeypadNotification &notification)
+{
+#if defined(ESP32)
+    if (xQueueSend(notification_queue, &notification, 0) == pdTRUE)
+    {
+        return true;
+    }
+#elif !defined(ARDUINO)
+    std::lock_guard<std::mutex> guard(queue_mutex);
+    if (queue_length < RUSTY_KEYPAD_NOTIFICATION_QUEUE_SIZE)
+    {
+        notification_queue[(queue_head + queue_length) % RUSTY_KEYPAD_NOTIFICATION_QUEUE_SIZE] = notification;
+        queue_length++;
+        return true;
+    }
+#endif
+    dropped++;
+    return false;
+}
+
+bool RustyScanTask::take(RustyKeypadNotification &notification)
+{
+#if defined(ESP32)
+    return (notification_queue != nullptr && xQueueReceive(notification_queue, &notification, 0) == pdTRUE);
+#elif !defined(ARDUINO)
+    std::lock_guard<std::mutex> guard(queue_mutex);
+    if (queue_length == 0)
+    {
+        return false;
+    }
+    notification = notification_queue[queue_head];
+    queue_head = (queue_head + 1) % RUSTY_KEYPAD_NOTIFICATION_QUEUE_SIZE;
+    queue_length--;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void RustyScanTask::scanOnce()
+{
+    lock();
+    RustyKeypad::scan();
+    unlock();
+}
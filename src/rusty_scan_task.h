@@ -0,0 +1,174 @@
+/*
+ * RustyScanTask Class
+ *
+ * Author: Aras TAŞKIRAN
+ * Email: aras@arastaskiran.com
+ * Date: 2024-09-2024
+ *
+ * Description:
+ *
+ * When loop() is busy with the network or a display, scan() isn't called often
+ * enough and short key presses get lost. On the ESP32 the keypad can be scanned
+ * by a FreeRTOS task of its own, pinned to a core of your choice, at a fixed rate.
+ * The listeners don't run in that task: their notifications are posted to a queue
+ * and delivered by dispatch(), which is called from loop() as before. On a PC
+ * build (no ARDUINO define) a std::thread takes the place of the task, so the
+ * same code can be exercised on Linux.
+ *
+ * License:
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUSTY_KEYPAD_SCAN_TASK_H
+#define RUSTY_KEYPAD_SCAN_TASK_H
+
+#include <rusty_keypad.h>
+#if !defined(ARDUINO)
+#include <atomic>
+#endif
+
+/**
+ * @brief Defined when the platform can run the scan in a task of its own.
+ */
+#if defined(ESP32) || !defined(ARDUINO)
+#define RUSTY_KEYPAD_HAS_SCAN_TASK
+#endif
+
+/**
+ * @brief Number of notifications that can wait for `dispatch()`.
+ */
+#ifndef RUSTY_KEYPAD_NOTIFICATION_QUEUE_SIZE
+#define RUSTY_KEYPAD_NOTIFICATION_QUEUE_SIZE 16
+#endif
+
+/**
+ * @brief Stack size of the scan task in bytes when `RUSTY_KEYPAD_STATIC_ALLOCATION` is defined.
+ *
+ * The stack is then a static array, and the `stack_size` argument of `start()` is ignored.
+ */
+#ifndef RUSTY_KEYPAD_SCAN_TASK_STACK_SIZE
+#define RUSTY_KEYPAD_SCAN_TASK_STACK_SIZE 4096
+#endif
+
+/**
+ * @class RustyScanTask
+ * @brief Scans the keypad in a task of its own and queues the listener calls.
+ *
+ * Example usage:
+ * @code
+ * void setup()
+ * {
+ *     RustyKeypad::addTextChangeListener(textChange);
+ *     RustyKeypad::enable();
+ *     RustyScanTask::start(5, 0);   // every 5 ms on core 0
+ * }
+ *
+ * void loop()
+ * {
+ *     RustyScanTask::dispatch();    // instead of RustyKeypad::scan()
+ *     updateNetwork();
+ * }
+ * @endcode
+ *
+ * @note While the task runs, don't call `RustyKeypad::scan()`. Other `RustyKeypad` functions called
+ *       outside of the listeners have to be wrapped in `lock()` and `unlock()`.
+ */
+class RustyScanTask
+{
+public:
+    /**
+     * @brief Starts the scan task.
+     *
+     * @param period     The scan period in milliseconds.
+     * @param core       The core the task is pinned to, -1 for any core. Ignored on the PC.
+     * @param priority   The FreeRTOS priority of the task. Ignored on the PC.
+     * @param stack_size The stack size of the task in bytes. Ignored on the PC and with static allocation.
+     * @return false if the task is already running or could not be created, otherwise true.
+     */
+    static bool start(unsigned long period = 5, int8_t core = 1, uint8_t priority = 2, uint32_t stack_size = 4096);
+
+    /**
+     * @brief Stops the scan task.
+     *
+     * The notifications still in the queue are kept; `dispatch()` delivers them.
+     */
+    static void stop();
+
+    /**
+     * @brief Checks if the scan task is running.
+     *
+     * @return true if the keys are scanned by the task, otherwise false.
+     */
+    static bool isRunning();
+
+    /**
+     * @brief Delivers the queued notifications to the listeners.
+     *
+     * Call this function from the application task, typically in `loop()`. The listeners are called
+     * while the keypad is locked, so they can use the `RustyKeypad` functions freely.
+     *
+     * @return The number of notifications delivered.
+     */
+    static uint8_t dispatch();
+
+    /**
+     * @brief Locks the keypad against the scan task.
+     *
+     * The lock is recursive, a task may take it more than once.
+     */
+    static void lock();
+
+    /**
+     * @brief Releases the lock taken by `lock()`.
+     */
+    static void unlock();
+
+    /**
+     * @brief Returns the number of notifications lost because the queue was full.
+     *
+     * @return The count since the task was started.
+     */
+    static uint16_t getDroppedNotifications();
+
+private:
+    /**
+     * @brief Puts a notification into the queue; installed as the notification sink of the keypad.
+     *
+     * @return false if the queue is full, otherwise true.
+     */
+    static bool post(const RustyKeypadNotification &notification);
+
+    /**
+     * @brief Takes the oldest notification from the queue.
+     *
+     * @return false if the queue is empty, otherwise true.
+     */
+    static bool take(RustyKeypadNotification &notification);
+
+    /**
+     * @brief Scans the keypad once while holding the lock.
+     */
+    static void scanOnce();
+
+    static unsigned long scan_period;   /**< The scan period in milliseconds. */
+    static uint16_t dropped;            /**< Notifications lost because the queue was full. */
+#if defined(ARDUINO)
+    static volatile bool running;       /**< Whether the task is running. */
+#else
+    static std::atomic<bool> running;   /**< Whether the thread is running; read by the thread itself. */
+#endif
+};
+
+#endif
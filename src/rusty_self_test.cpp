@@ -0,0 +1,286 @@
+#include <rusty_self_test.h>
+
+bool RustySelfTest::running{false};
+uint16_t RustySelfTest::step_interval{RUSTY_KEYPAD_SELF_TEST_MILLIS};
+unsigned long RustySelfTest::stuck_timeout{RUSTY_KEYPAD_STUCK_KEY_MILLIS};
+unsigned long RustySelfTest::step_ts{0};
+unsigned long RustySelfTest::window_ts{0};
+uint8_t RustySelfTest::phase{0};
+uint8_t RustySelfTest::sample_row{0};
+RustyRowBits RustySelfTest::held_bits[MAX_KEYPAD_MATRIX_SIZE];
+RustyRowBits RustySelfTest::stuck_bits[MAX_KEYPAD_MATRIX_SIZE];
+RustyRowBits RustySelfTest::last_bits[MAX_KEYPAD_MATRIX_SIZE];
+RustyRowBits RustySelfTest::seen_rows{0};
+RustyRowBits RustySelfTest::seen_cols{0};
+RustyRowBits RustySelfTest::open_rows{0};
+RustyRowBits RustySelfTest::open_cols{0};
+RustyRowBits RustySelfTest::shorted_rows{0};
+RustyRowBits RustySelfTest::shorted_cols{0};
+RustyRowBits RustySelfTest::active_cols{0};
+uint16_t RustySelfTest::presses{0};
+uint16_t RustySelfTest::faults{0};
+uint32_t RustySelfTest::rounds{0};
+
+void RustySelfTest::begin(uint16_t interval)
+{
+    step_interval = interval;
+    rounds = 0;
+    reset();
+    running = true;
+    BaseRustyKeypad::selfTestStep = &RustySelfTest::step;
+}
+
+void RustySelfTest::end()
+{
+    running = false;
+    BaseRustyKeypad::selfTestStep = NULL;
+}
+
+bool RustySelfTest::isRunning()
+{
+    return running;
+}
+
+void RustySelfTest::setStuckKeyTimeout(unsigned long timeout)
+{
+    stuck_timeout = timeout;
+}
+
+void RustySelfTest::reset()
+{
+    unsigned long now = millis();
+    step_ts = now;
+    window_ts = now;
+    phase = 0;
+    sample_row = 0;
+    memset(held_bits, 0xFF, sizeof(held_bits));
+    memset(stuck_bits, 0, sizeof(stuck_bits));
+    memset(last_bits, 0, sizeof(last_bits));
+    seen_rows = 0;
+    seen_cols = 0;
+    open_rows = 0;
+    open_cols = 0;
+    shorted_rows = 0;
+    shorted_cols = 0;
+    active_cols = 0;
+    presses = 0;
+    faults = 0;
+}
+
+uint16_t RustySelfTest::getFaultCount()
+{
+    return faults;
+}
+
+uint32_t RustySelfTest::getRoundCount()
+{
+    return rounds;
+}
+
+void RustySelfTest::step()
+{
+    unsigned long now = millis();
+    sampleRow(now);
+    if ((now - step_ts) < step_interval)
+    {
+        return;
+    }
+    step_ts = now;
+
+    uint8_t rows = BaseRustyKeypad::row_size;
+    uint8_t cols = BaseRustyKeypad::col_size;
+    if (phase < rows)
+    {
+        if (BaseRustyKeypad::pins_mode == INPUT_PULLUP && isQuiet())
+        {
+            testRow(phase);
+        }
+    }
+    else if (phase < rows + cols)
+    {
+        if (isQuiet())
+        {
+            testColumn(phase - rows);
+        }
+    }
+    else
+    {
+        testIdleColumns();
+    }
+    if (++phase > rows + cols)
+    {
+        phase = 0;
+        rounds++;
+    }
+}
+
+void RustySelfTest::sampleRow(unsigned long now)
+{
+    uint8_t row = sample_row;
+    RustyRowBits bits = BaseRustyKeypad::pressed_bits[row];
+    held_bits[row] &= bits;
+    stuck_bits[row] &= bits;
+    RustyRowBits pressed = bits & ~last_bits[row];
+    last_bits[row] = bits;
+    if (pressed != 0)
+    {
+        seen_rows |= (RustyRowBits)(1U << row);
+        seen_cols |= pressed;
+        if (++presses >= RUSTY_KEYPAD_OPEN_LINE_PRESSES)
+        {
+            checkOpenLines();
+        }
+    }
+    if (++sample_row < BaseRustyKeypad::row_size)
+    {
+        return;
+    }
+    sample_row = 0;
+    if ((now - window_ts) >= stuck_timeout)
+    {
+        checkStuckKeys();
+        window_ts = now;
+    }
+}
+
+void RustySelfTest::checkStuckKeys()
+{
+    for (uint8_t i = 0; i < BaseRustyKeypad::row_size; i++)
+    {
+        RustyRowBits stuck = held_bits[i] & ~stuck_bits[i];
+        for (uint8_t j = 0; stuck != 0 && j < BaseRustyKeypad::col_size; j++)
+        {
+            if (stuck & (RustyRowBits)(1U << j))
+            {
+                report(RKP_FAULT_STUCK_KEY, i, j);
+            }
+        }
+        stuck_bits[i] |= held_bits[i];
+        held_bits[i] = (RustyRowBits)~0U;
+    }
+}
+
+void RustySelfTest::checkOpenLines()
+{
+    for (uint8_t i = 0; i < BaseRustyKeypad::row_size; i++)
+    {
+        RustyRowBits bit = (RustyRowBits)(1U << i);
+        if (!(seen_rows & bit) && !(open_rows & bit))
+        {
+            open_rows |= bit;
+            report(RKP_FAULT_OPEN_ROW, i, 0);
+        }
+    }
+    for (uint8_t j = 0; j < BaseRustyKeypad::col_size; j++)
+    {
+        RustyRowBits bit = (RustyRowBits)(1U << j);
+        if (!(seen_cols & bit) && !(open_cols & bit))
+        {
+            open_cols |= bit;
+            report(RKP_FAULT_OPEN_COLUMN, j, 0);
+        }
+    }
+    seen_rows = 0;
+    seen_cols = 0;
+    presses = 0;
+}
+
+void RustySelfTest::testRow(uint8_t row)
+{
+    uint8_t *pins = BaseRustyKeypad::row_out_pins;
+    uint8_t count = BaseRustyKeypad::row_size;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (i != row)
+        {
+            pinMode(pins[i], INPUT_PULLUP);
+        }
+    }
+    digitalWrite(pins[row], LOW);
+    for (uint8_t i = 0; i < count; i++)
+    {
+        RustyRowBits bit = (RustyRowBits)(1U << i);
+        if (i != row && digitalRead(pins[i]) == LOW && !(shorted_rows & bit))
+        {
+            shorted_rows |= bit | (RustyRowBits)(1U << row);
+            report(RKP_FAULT_ROW_SHORT, row, i);
+        }
+    }
+    digitalWrite(pins[row], HIGH);
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (i != row)
+        {
+            pinMode(pins[i], OUTPUT);
+            digitalWrite(pins[i], HIGH);
+        }
+    }
+}
+
+void RustySelfTest::testColumn(uint8_t col)
+{
+    uint8_t *pins = BaseRustyKeypad::col_in_pins;
+    uint8_t *rows = BaseRustyKeypad::row_out_pins;
+    uint8_t active = (BaseRustyKeypad::pins_mode == INPUT_PULLUP ? LOW : HIGH);
+    // A key pressed during the test must not connect the driven column to a driven row.
+    for (uint8_t i = 0; i < BaseRustyKeypad::row_size; i++)
+    {
+        pinMode(rows[i], BaseRustyKeypad::pins_mode);
+    }
+    pinMode(pins[col], OUTPUT);
+    digitalWrite(pins[col], active);
+    for (uint8_t j = 0; j < BaseRustyKeypad::col_size; j++)
+    {
+        RustyRowBits bit = (RustyRowBits)(1U << j);
+        if (j != col && digitalRead(pins[j]) == active && !(shorted_cols & bit))
+        {
+            shorted_cols |= bit | (RustyRowBits)(1U << col);
+            report(RKP_FAULT_COLUMN_SHORT, col, j);
+        }
+    }
+    pinMode(pins[col], BaseRustyKeypad::pins_mode);
+    for (uint8_t i = 0; i < BaseRustyKeypad::row_size; i++)
+    {
+        pinMode(rows[i], OUTPUT);
+        digitalWrite(rows[i], (BaseRustyKeypad::pins_mode == INPUT_PULLUP ? HIGH : LOW));
+    }
+}
+
+void RustySelfTest::testIdleColumns()
+{
+    uint8_t active = (BaseRustyKeypad::pins_mode == INPUT_PULLUP ? LOW : HIGH);
+    for (uint8_t j = 0; j < BaseRustyKeypad::col_size; j++)
+    {
+        RustyRowBits bit = (RustyRowBits)(1U << j);
+        if (digitalRead(BaseRustyKeypad::col_in_pins[j]) == active && !(active_cols & bit))
+        {
+            active_cols |= bit;
+            report(RKP_FAULT_COLUMN_ACTIVE, j, 0);
+        }
+    }
+}
+
+bool RustySelfTest::isQuiet()
+{
+    if (BaseRustyKeypad::busy_rows != 0 || BaseRustyKeypad::waitKey != nullptr)
+    {
+        return false;
+    }
+    for (uint8_t i = 0; i < BaseRustyKeypad::row_size; i++)
+    {
+        if (BaseRustyKeypad::key_bits[i] != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void RustySelfTest::report(uint8_t type, uint8_t a, uint8_t b)
+{
+    faults++;
+    if (BaseRustyKeypad::faultListener != NULL || BaseRustyKeypad::notificationStream != NULL)
+    {
+        BaseRustyKeypad::notify(RKP_NOTIFY_FAULT, (char)type, (uint16_t)(a | (b << 8)), "");
+    }
+}
@@ -0,0 +1,216 @@
+/*
+ * RustySelfTest Class
+ *
+ * Author: Aras TAŞKIRAN
+ * Email: aras@arastaskiran.com
+ * Date: 2024-09-2024
+ *
+ * Description:
+ *
+ * A key that reads as pressed for hours, or two rows shorted together, looks
+ * like normal input to the keypad. RustySelfTest checks the matrix in the
+ * background, a small step after a scan: it drives the rows and columns in
+ * test patterns while no key is pressed to find shorted lines and columns held
+ * at the active level, watches for keys that never get released, and reports
+ * the lines that never see a press while the others do as possibly open.
+ * Every fault goes to the listener set with addFaultListener().
+ *
+ * License:
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUSTY_KEYPAD_SELF_TEST_H
+#define RUSTY_KEYPAD_SELF_TEST_H
+
+#include <stdint.h>
+#include <Arduino.h>
+#include <base_keypad.h>
+
+/**
+ * @brief The default time between two pin tests of the self-test, in milliseconds.
+ */
+#ifndef RUSTY_KEYPAD_SELF_TEST_MILLIS
+#define RUSTY_KEYPAD_SELF_TEST_MILLIS 100
+#endif
+
+/**
+ * @brief The default time a key has to stay pressed to be reported as stuck, in milliseconds.
+ */
+#ifndef RUSTY_KEYPAD_STUCK_KEY_MILLIS
+#define RUSTY_KEYPAD_STUCK_KEY_MILLIS 600000UL
+#endif
+
+/**
+ * @brief The number of key presses after which a line that had none is reported as open.
+ */
+#ifndef RUSTY_KEYPAD_OPEN_LINE_PRESSES
+#define RUSTY_KEYPAD_OPEN_LINE_PRESSES 200
+#endif
+
+/**
+ * @enum RustyFaultTypes
+ * @brief The faults reported by `RustySelfTest`, with the meaning of the two lines passed along.
+ */
+typedef enum RustyFaultTypes
+{
+    /** The key at row `a` and column `b` has been pressed for a whole stuck key timeout. */
+    RKP_FAULT_STUCK_KEY,
+
+    /** Rows `a` and `b` are shorted together. */
+    RKP_FAULT_ROW_SHORT,
+
+    /** Columns `a` and `b` are shorted together. */
+    RKP_FAULT_COLUMN_SHORT,
+
+    /** Column `a` reads as active while no row is driven. */
+    RKP_FAULT_COLUMN_ACTIVE,
+
+    /** Row `a` never had a key pressed while the other rows did; it may be open. */
+    RKP_FAULT_OPEN_ROW,
+
+    /** Column `a` never had a key pressed while the other columns did; it may be open. */
+    RKP_FAULT_OPEN_COLUMN
+
+} RustyFaultTypes;
+
+/**
+ * @class RustySelfTest
+ * @brief Tests the key matrix a little at a time after the scans.
+ *
+ * After every scan one row of the debounced key state is checked for stuck keys and new presses,
+ * which costs a few instructions. Once per interval one pin test is made in this order: each row
+ * against the other rows, each column against the other columns, then all columns with no row
+ * driven. The row and column tests only run while no key is pressed and no key is busy, and the row
+ * tests need `INPUT_PULLUP` pins. A pin test costs about as much as an idle scan, so with the default
+ * interval of 100 ms it adds a few percent to a keypad scanned every few milliseconds.
+ *
+ * An open line can't be seen on the pins with pull-up inputs, as it reads like a released key, so it
+ * is reported from use: when `RUSTY_KEYPAD_OPEN_LINE_PRESSES` keys have been pressed and a line had
+ * none of them. Stuck keys are watched in windows of the stuck key timeout, so a key is reported at
+ * the end of the first window it stays pressed for, at most two timeouts after it was pressed. A
+ * column held at the active level also makes its keys look stuck. The self-test is skipped while
+ * `RustyReplay` feeds the keys.
+ */
+class RustySelfTest
+{
+public:
+    /**
+     * @brief Starts the self-test.
+     *
+     * @param interval The milliseconds between two pin tests.
+     */
+    static void begin(uint16_t interval = RUSTY_KEYPAD_SELF_TEST_MILLIS);
+
+    /**
+     * @brief Stops the self-test.
+     */
+    static void end();
+
+    /**
+     * @brief Checks if the self-test is running.
+     */
+    static bool isRunning();
+
+    /**
+     * @brief Sets how long a key has to stay pressed to be reported as stuck.
+     *
+     * @param timeout The time in milliseconds. Default is `RUSTY_KEYPAD_STUCK_KEY_MILLIS`.
+     */
+    static void setStuckKeyTimeout(unsigned long timeout);
+
+    /**
+     * @brief Forgets the reported faults, so that they are reported again when they are found.
+     */
+    static void reset();
+
+    /**
+     * @brief Returns the number of faults reported since `begin()` or `reset()`.
+     */
+    static uint16_t getFaultCount();
+
+    /**
+     * @brief Returns the number of complete rounds of pin tests since `begin()`.
+     */
+    static uint32_t getRoundCount();
+
+private:
+    /**
+     * @brief Runs the work of one scan; set as `selfTestStep`.
+     */
+    static void step();
+
+    /**
+     * @brief Checks one row of the debounced key state for stuck keys and new presses.
+     */
+    static void sampleRow(unsigned long now);
+
+    /**
+     * @brief Reports the keys that stayed pressed for the whole stuck key timeout.
+     */
+    static void checkStuckKeys();
+
+    /**
+     * @brief Reports the lines that had no key pressed while the other lines did.
+     */
+    static void checkOpenLines();
+
+    /**
+     * @brief Drives a row and reads the other rows as inputs.
+     */
+    static void testRow(uint8_t row);
+
+    /**
+     * @brief Drives a column and reads the other columns; the rows are released to inputs meanwhile.
+     */
+    static void testColumn(uint8_t col);
+
+    /**
+     * @brief Reads the columns while no row is driven.
+     */
+    static void testIdleColumns();
+
+    /**
+     * @brief Checks if the keys are all released, so the lines can be driven.
+     */
+    static bool isQuiet();
+
+    /**
+     * @brief Sends a fault to the fault listener.
+     */
+    static void report(uint8_t type, uint8_t a, uint8_t b);
+
+    static bool running;
+    static uint16_t step_interval;
+    static unsigned long stuck_timeout;
+    static unsigned long step_ts;
+    static unsigned long window_ts;
+    static uint8_t phase;
+    static uint8_t sample_row;
+    static RustyRowBits held_bits[MAX_KEYPAD_MATRIX_SIZE];
+    static RustyRowBits stuck_bits[MAX_KEYPAD_MATRIX_SIZE];
+    static RustyRowBits last_bits[MAX_KEYPAD_MATRIX_SIZE];
+    static RustyRowBits seen_rows;
+    static RustyRowBits seen_cols;
+    static RustyRowBits open_rows;
+    static RustyRowBits open_cols;
+    static RustyRowBits shorted_rows;
+    static RustyRowBits shorted_cols;
+    static RustyRowBits active_cols;
+    static uint16_t presses;
+    static uint16_t faults;
+    static uint32_t rounds;
+};
+
+#endif
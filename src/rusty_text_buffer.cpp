@@ -0,0 +1,100 @@
+#include <rusty_text_buffer.h>
+
+RustyTextBuffer::RustyTextBuffer()
+{
+    clear();
+}
+
+bool RustyTextBuffer::insert(char c)
+{
+    if (gap_start == gap_end)
+    {
+        return false;
+    }
+    buffer[gap_start++] = c;
+    return true;
+}
+
+bool RustyTextBuffer::erase()
+{
+    if (gap_start == 0)
+    {
+        return false;
+    }
+    gap_start--;
+    return true;
+}
+
+bool RustyTextBuffer::moveLeft()
+{
+    if (gap_start == 0)
+    {
+        return false;
+    }
+    buffer[--gap_end] = buffer[--gap_start];
+    return true;
+}
+
+bool RustyTextBuffer::moveRight()
+{
+    if (gap_end == RUSTY_KEYPAD_MAX_TEXT_LENGTH)
+    {
+        return false;
+    }
+    buffer[gap_start++] = buffer[gap_end++];
+    return true;
+}
+
+void RustyTextBuffer::clear()
+{
+    gap_start = 0;
+    gap_end = RUSTY_KEYPAD_MAX_TEXT_LENGTH;
+}
+
+uint8_t RustyTextBuffer::length() const
+{
+    return gap_start + (RUSTY_KEYPAD_MAX_TEXT_LENGTH - gap_end);
+}
+
+uint8_t RustyTextBuffer::cursor() const
+{
+    return gap_start;
+}
+
+char RustyTextBuffer::charAt(uint8_t index) const
+{
+    if (index < gap_start)
+    {
+        return buffer[index];
+    }
+    if (index >= length())
+    {
+        return '\0';
+    }
+    return buffer[index + (gap_end - gap_start)];
+}
+
+void RustyTextBuffer::copyTo(char *out) const
+{
+    memcpy(out, buffer, gap_start);
+    memcpy(out + gap_start, buffer + gap_end, RUSTY_KEYPAD_MAX_TEXT_LENGTH - gap_end);
+    out[length()] = '\0';
+}
+
+String RustyTextBuffer::toString() const
+{
+    char text[RUSTY_KEYPAD_MAX_TEXT_LENGTH + 1];
+    copyTo(text);
+    return String(text);
+}
+
+bool RustyTextBuffer::equals(const char *text, size_t len) const
+{
+    if (len != length())
+    {
+        return false;
+    }
+    size_t tail = RUSTY_KEYPAD_MAX_TEXT_LENGTH - gap_end;
+    return memcmp(text, buffer, gap_start) == 0 &&
+           memcmp(text + gap_start, buffer + gap_end, tail) == 0;
+}
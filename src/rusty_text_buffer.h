@@ -0,0 +1,187 @@
+/*
+ * RustyTextBuffer Class
+ *
+ * Author: Aras TAŞKIRAN
+ * Email: aras@arastaskiran.com
+ * Date: 2024-09-2024
+ *
+ * Description:
+ *
+ * The text typed on the keypad is stored in this class. It is a small gap buffer:
+ * the free space of the buffer always sits at the cursor, so inserting or deleting
+ * a character in the middle of the text doesn't shift the rest of it.
+ * Moving the cursor moves a single character across the gap.
+ *
+ * License:
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUSTY_KEYPAD_TEXT_BUFFER_H
+#define RUSTY_KEYPAD_TEXT_BUFFER_H
+
+#include <stdint.h>
+#include <Arduino.h>
+
+/**
+ * @brief Defines the capacity of the statically allocated text buffers.
+ *
+ * The text buffer and the buffers that shadow it, such as the password mask, are sized at
+ * compile time with this value so that they never have to be reallocated while typing.
+ * `setMaxTextLength()` is clamped to this capacity.
+ *
+ * @note Define this macro before including the library to change the capacity.
+ */
+#ifndef RUSTY_KEYPAD_MAX_TEXT_LENGTH
+#define RUSTY_KEYPAD_MAX_TEXT_LENGTH 32
+#endif
+
+#if RUSTY_KEYPAD_MAX_TEXT_LENGTH > 254
+#error "RUSTY_KEYPAD_MAX_TEXT_LENGTH must be smaller than 255"
+#endif
+
+/**
+ * @brief The type of the text passed to the listeners and returned by `getKeypadData()`.
+ *
+ * It is `String` by default. With `RUSTY_KEYPAD_STATIC_ALLOCATION` defined it is a `const char *`
+ * pointing into a static buffer of the keypad, which stays valid until the next call that returns
+ * a text; copy it if it has to be kept.
+ */
+#if defined(RUSTY_KEYPAD_STATIC_ALLOCATION)
+typedef const char *RustyText;
+#else
+typedef String RustyText;
+#endif
+
+/**
+ * @brief Returns the characters of a `RustyText`.
+ */
+inline const char *rustyTextChars(const String &text) { return text.c_str(); }
+
+/**
+ * @brief Returns the characters of a `RustyText`.
+ */
+inline const char *rustyTextChars(const char *text) { return text; }
+
+/**
+ * @class RustyTextBuffer
+ * @brief A fixed capacity gap buffer holding the keypad text.
+ *
+ * The characters before the cursor are stored at the beginning of the buffer and the characters
+ * after the cursor at its end. Every edit happens at the cursor, so inserting, deleting and moving
+ * the cursor by one position are all constant time operations.
+ */
+class RustyTextBuffer
+{
+public:
+    /**
+     * @brief Constructs an empty text buffer with the cursor at position 0.
+     */
+    RustyTextBuffer();
+
+    /**
+     * @brief Inserts a character at the cursor position.
+     *
+     * The cursor is moved behind the inserted character.
+     *
+     * @param c The character to insert.
+     * @return true if the character was inserted, false if the buffer is full.
+     */
+    bool insert(char c);
+
+    /**
+     * @brief Deletes the character before the cursor.
+     *
+     * @return true if a character was deleted, false if the cursor is at the beginning of the text.
+     */
+    bool erase();
+
+    /**
+     * @brief Moves the cursor one character to the left.
+     *
+     * @return true if the cursor was moved, false if it is already at the beginning of the text.
+     */
+    bool moveLeft();
+
+    /**
+     * @brief Moves the cursor one character to the right.
+     *
+     * @return true if the cursor was moved, false if it is already at the end of the text.
+     */
+    bool moveRight();
+
+    /**
+     * @brief Removes all characters and moves the cursor to position 0.
+     */
+    void clear();
+
+    /**
+     * @brief Returns the number of characters in the buffer.
+     */
+    uint8_t length() const;
+
+    /**
+     * @brief Returns the cursor position, which is the number of characters before the cursor.
+     */
+    uint8_t cursor() const;
+
+    /**
+     * @brief Returns the character at the given text position.
+     *
+     * @param index Position of the character, counted from the beginning of the text.
+     * @return The character, or '\0' if the index is out of range.
+     */
+    char charAt(uint8_t index) const;
+
+    /**
+     * @brief Copies the text into a contiguous, null-terminated array.
+     *
+     * @param out Destination array. It must hold at least `length() + 1` characters.
+     */
+    void copyTo(char *out) const;
+
+    /**
+     * @brief Returns the text as a `String`.
+     *
+     * The text is assembled in a single step, so the resulting `String` is allocated only once.
+     */
+    String toString() const;
+
+    /**
+     * @brief Compares the text with the given characters without assembling it.
+     *
+     * @param text The characters to compare with.
+     * @param len  The number of characters in `text`.
+     * @return true if the text is equal to `text`, otherwise false.
+     */
+    bool equals(const char *text, size_t len) const;
+
+private:
+    /**
+     * @brief Storage of the buffer, with the gap between `gap_start` and `gap_end`.
+     */
+    char buffer[RUSTY_KEYPAD_MAX_TEXT_LENGTH];
+
+    /**
+     * @brief First free position of the gap, which is also the cursor position.
+     */
+    uint8_t gap_start;
+
+    /**
+     * @brief First position after the gap, where the text after the cursor begins.
+     */
+    uint8_t gap_end;
+};
+
+#endif
@@ -0,0 +1,84 @@
+#include <rusty_trace.h>
+
+#if defined(RUSTY_KEYPAD_TRACE)
+
+RustyTraceRecord RustyTrace::records[RUSTY_KEYPAD_TRACE_SIZE];
+uint16_t RustyTrace::head{0};
+uint16_t RustyTrace::count{0};
+uint32_t RustyTrace::lost{0};
+unsigned long RustyTrace::last_ts{0};
+
+void RustyTrace::record(uint8_t kind, uint8_t code, uint8_t key)
+{
+    unsigned long now = millis();
+    if (count == 0)
+    {
+        last_ts = now;
+    }
+    unsigned long delta = now - last_ts;
+    last_ts = now;
+    if (delta > 0xFFFFUL)
+    {
+        push((uint16_t)(delta >> 16), (uint8_t)(RKP_TRACE_GAP << 4), 0);
+    }
+    push((uint16_t)delta, (uint8_t)((kind << 4) | (code & 0x0F)), key);
+}
+
+void RustyTrace::push(uint16_t delta, uint8_t type, uint8_t key)
+{
+    RustyTraceRecord &slot = records[(head + count) % RUSTY_KEYPAD_TRACE_SIZE];
+    slot.delta = delta;
+    slot.type = type;
+    slot.key = key;
+    if (count < RUSTY_KEYPAD_TRACE_SIZE)
+    {
+        count++;
+        return;
+    }
+    head = (head + 1) % RUSTY_KEYPAD_TRACE_SIZE;
+    lost++;
+}
+
+void RustyTrace::dump(Print &out)
+{
+    out.write((const uint8_t *)"RKT", 3);
+    out.write((uint8_t)RUSTY_KEYPAD_TRACE_VERSION);
+    writeNumber(out, count, 2);
+    writeNumber(out, RUSTY_KEYPAD_TRACE_SIZE, 2);
+    writeNumber(out, lost, 4);
+    writeNumber(out, last_ts, 4);
+    for (uint16_t i = 0; i < count; i++)
+    {
+        const RustyTraceRecord &slot = records[(head + i) % RUSTY_KEYPAD_TRACE_SIZE];
+        writeNumber(out, slot.delta, 2);
+        out.write(slot.type);
+        out.write(slot.key);
+    }
+}
+
+void RustyTrace::clear()
+{
+    head = 0;
+    count = 0;
+    lost = 0;
+}
+
+uint16_t RustyTrace::getCount()
+{
+    return count;
+}
+
+uint32_t RustyTrace::getLostCount()
+{
+    return lost;
+}
+
+void RustyTrace::writeNumber(Print &out, uint32_t value, uint8_t size)
+{
+    for (uint8_t i = 0; i < size; i++)
+    {
+        out.write((uint8_t)(value >> (8 * i)));
+    }
+}
+
+#endif
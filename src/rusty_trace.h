@@ -0,0 +1,163 @@
+/*
+ * RustyTrace Class
+ *
+ * Author: Aras TAŞKIRAN
+ * Email: aras@arastaskiran.com
+ * Date: 2024-09-2024
+ *
+ * Description:
+ *
+ * When a keystroke goes missing in the field, the listeners alone can't tell
+ * whether the key was never seen, was rejected by the debounce filter or was
+ * handled and then lost by the application. With RUSTY_KEYPAD_TRACE defined the
+ * keypad keeps a small ring of binary records in RAM: every event change of a
+ * key, every sampled edge (also the ones rejected by the filter) and every
+ * listener call, each with its time and the key it belongs to.
+ *
+ * RustyTrace::dump() writes the ring to a Print, e.g. Serial, and
+ * extras/tools/rusty_trace.py turns the dump into a readable timeline.
+ *
+ * License:
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUSTY_KEYPAD_TRACE_H
+#define RUSTY_KEYPAD_TRACE_H
+
+#if defined(RUSTY_KEYPAD_TRACE)
+
+#include <stdint.h>
+#include <Arduino.h>
+
+/**
+ * @brief Number of records kept in the trace ring.
+ *
+ * Every record takes 4 bytes. When the ring is full the oldest record is overwritten.
+ */
+#ifndef RUSTY_KEYPAD_TRACE_SIZE
+#define RUSTY_KEYPAD_TRACE_SIZE 64
+#endif
+
+#if RUSTY_KEYPAD_TRACE_SIZE < 1 || RUSTY_KEYPAD_TRACE_SIZE > 65535
+#error "RUSTY_KEYPAD_TRACE_SIZE must be between 1 and 65535"
+#endif
+
+/**
+ * @brief Version of the dump format written by `RustyTrace::dump()`.
+ */
+#define RUSTY_KEYPAD_TRACE_VERSION 1
+
+/**
+ * @enum RustyTraceKinds
+ * @brief The kind of a trace record, stored in the high nibble of its type byte.
+ */
+typedef enum RustyTraceKinds
+{
+    /** Extends the time gap of the next record by `delta * 65536` ms, it has no other meaning. */
+    RKP_TRACE_GAP,
+
+    /** A key changed its event; the low nibble is the new `KeypadEventTypes`. */
+    RKP_TRACE_EVENT,
+
+    /** A key changed its state; the low nibble is 1 for pressed, 0 for released. */
+    RKP_TRACE_EDGE,
+
+    /** A state change was ignored by the key filter; the low nibble is the sampled state. */
+    RKP_TRACE_FILTERED,
+
+    /** A listener was called; the low nibble is the `KeypadNotifyTypes` and the key is its key or value. */
+    RKP_TRACE_LISTENER
+
+} RustyTraceKinds;
+
+/**
+ * @brief One record of the trace ring.
+ */
+struct RustyTraceRecord
+{
+    uint16_t delta; /**< Milliseconds since the previous record. */
+    uint8_t type;   /**< `RustyTraceKinds` in the high nibble and its code in the low nibble. */
+    uint8_t key;    /**< Index of the key in the matrix, or the key code of listener records. */
+};
+
+/**
+ * @class RustyTrace
+ * @brief A RAM ring of keypad records that can be dumped for later analysis.
+ *
+ * The records are written by the keypad itself. The ring is not protected against concurrent
+ * access; when the keypad is scanned by `RustyScanTask`, dump it between `RustyScanTask::lock()`
+ * and `RustyScanTask::unlock()`.
+ */
+class RustyTrace
+{
+public:
+    /**
+     * @brief Adds a record to the ring.
+     *
+     * @param kind One of `RustyTraceKinds`.
+     * @param code The code of the record, 0 to 15.
+     * @param key  The key index or key code the record belongs to.
+     */
+    static void record(uint8_t kind, uint8_t code, uint8_t key);
+
+    /**
+     * @brief Writes the trace to the given output in binary.
+     *
+     * The dump starts with a 16-byte header: the characters "RKT", the format version, the number
+     * of records (16 bits), the capacity of the ring (16 bits), the number of overwritten records
+     * (32 bits) and the time of the newest record in milliseconds (32 bits). The records follow,
+     * oldest first, 4 bytes each. All numbers are little endian.
+     *
+     * The ring is not cleared, call `clear()` for that.
+     *
+     * @param out The output, e.g. `Serial`.
+     */
+    static void dump(Print &out);
+
+    /**
+     * @brief Removes all records.
+     */
+    static void clear();
+
+    /**
+     * @brief Returns the number of records in the ring.
+     */
+    static uint16_t getCount();
+
+    /**
+     * @brief Returns the number of records overwritten since the last `clear()`.
+     */
+    static uint32_t getLostCount();
+
+private:
+    /**
+     * @brief Appends a record, overwriting the oldest one when the ring is full.
+     */
+    static void push(uint16_t delta, uint8_t type, uint8_t key);
+
+    /**
+     * @brief Writes a number in little endian order.
+     */
+    static void writeNumber(Print &out, uint32_t value, uint8_t size);
+
+    static RustyTraceRecord records[RUSTY_KEYPAD_TRACE_SIZE];
+    static uint16_t head;
+    static uint16_t count;
+    static uint32_t lost;
+    static unsigned long last_ts;
+};
+
+#endif
+#endif
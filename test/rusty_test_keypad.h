@@ -0,0 +1,206 @@
+/*
+ * Shared helpers for the host tests.
+ *
+ * The tests are built for the PC with the Arduino stand-in of
+ * extras/replay/host (see test/README). This header models a 4x3 key matrix
+ * on the stand-in pins, moves the virtual clock, and records every listener
+ * call into a string, so a test can press keys, scan for a while and compare
+ * what the keypad reported.
+ */
+#ifndef RUSTY_TEST_KEYPAD_H
+#define RUSTY_TEST_KEYPAD_H
+
+#include <Arduino.h>
+#include <rusty_keypad.h>
+#include <stdio.h>
+#include <string>
+
+static const char *const test_keys[4 * 3] = {
+    "1", "2ABC", "3DEF",
+    "4GHI", "5JKL", "6MNO",
+    "7PQRS", "8TUV", "9WXYZ",
+    "*", "0 ", "#"};
+static const uint8_t test_row_pins[4] = {2, 3, 4, 5};
+static const uint8_t test_col_pins[3] = {6, 7, 8};
+
+static bool test_pressed[4][3];
+static std::string test_log;
+
+/*
+ * A column reads LOW when a pressed key joins it to a row driven LOW. A row
+ * switched to an input reads LOW when a pressed key joins it to a column
+ * driven LOW, and HIGH otherwise.
+ */
+inline int testDigitalRead(uint8_t pin)
+{
+    for (uint8_t c = 0; c < 3; c++)
+    {
+        if (pin != test_col_pins[c])
+        {
+            continue;
+        }
+        if (getPinMode(pin) == OUTPUT)
+        {
+            return getPinLevel(pin);
+        }
+        for (uint8_t r = 0; r < 4; r++)
+        {
+            if (test_pressed[r][c] && getPinMode(test_row_pins[r]) == OUTPUT && getPinLevel(test_row_pins[r]) == LOW)
+            {
+                return LOW;
+            }
+        }
+        return HIGH;
+    }
+    for (uint8_t r = 0; r < 4; r++)
+    {
+        if (pin != test_row_pins[r])
+        {
+            continue;
+        }
+        if (getPinMode(pin) == OUTPUT)
+        {
+            return getPinLevel(pin);
+        }
+        for (uint8_t c = 0; c < 3; c++)
+        {
+            if (test_pressed[r][c] && getPinMode(test_col_pins[c]) == OUTPUT && getPinLevel(test_col_pins[c]) == LOW)
+            {
+                return LOW;
+            }
+        }
+        return HIGH;
+    }
+    return HIGH;
+}
+
+inline void testLog(const char *format, const char *value)
+{
+    char line[64];
+    snprintf(line, sizeof(line), format, value);
+    test_log += line;
+}
+
+inline void testOnKeyDown(char key)
+{
+    char text[2] = {key, '\0'};
+    testLog("down %s;", text);
+}
+
+inline void testOnKeyUp(char key)
+{
+    char text[2] = {key, '\0'};
+    testLog("up %s;", text);
+}
+
+inline void testOnLongPress(char key)
+{
+    char text[2] = {key, '\0'};
+    testLog("long %s;", text);
+}
+
+inline void testOnDelete(char key)
+{
+    char text[2] = {key, '\0'};
+    testLog("delete %s;", text);
+}
+
+inline void testOnText(RustyText text)
+{
+    testLog("text %s;", rustyTextChars(text));
+}
+
+inline void testOnEnter(RustyText text)
+{
+    testLog("enter %s;", rustyTextChars(text));
+}
+
+/*
+ * Sets the keypad up like a fresh sketch: the 4x3 layout, the given type, '*'
+ * as the delete key and no enter key, with every listener recording into
+ * test_log.
+ */
+inline void testKeypadSetup(KeypadTypes type = RKP_INTEGER)
+{
+    setClock(1000);
+    setDigitalSource(testDigitalRead);
+    memset(test_pressed, 0, sizeof(test_pressed));
+    RustyKeypad::disable();
+    RustyKeypad::keyboardSetup(test_keys, test_row_pins, test_col_pins, 4, 3);
+    RustyKeypad::setType(type);
+    RustyKeypad::useDeleteKey('*');
+    RustyKeypad::ignoreEnterKey();
+    RustyKeypad::ignoreCursorKeys();
+    RustyKeypad::setPasswordMask(false);
+    RustyKeypad::setInputMask(nullptr);
+    RustyKeypad::setCredentialTable(nullptr);
+    RustyKeypad::addKeyDownListener(testOnKeyDown);
+    RustyKeypad::addKeyUpListener(testOnKeyUp);
+    RustyKeypad::addLongPressListener(testOnLongPress);
+    RustyKeypad::addDeleteActionListener(testOnDelete);
+    RustyKeypad::addTextChangeListener(testOnText);
+    RustyKeypad::addEnterActionListener(testOnEnter);
+    RustyKeypad::enable();
+    test_log.clear();
+}
+
+/*
+ * Scans every `step` milliseconds for `duration` milliseconds of virtual time.
+ */
+inline void testRun(unsigned long duration, unsigned long step = 5)
+{
+    for (unsigned long start = millis(); millis() - start < duration;)
+    {
+        delay(step);
+        RustyKeypad::scan();
+    }
+}
+
+inline bool testFindKey(char key, uint8_t &row, uint8_t &col)
+{
+    for (uint8_t i = 0; i < 12; i++)
+    {
+        if (test_keys[i][0] == key)
+        {
+            row = i / 3;
+            col = i % 3;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline void testSetKey(char key, bool pressed)
+{
+    uint8_t row, col;
+    if (testFindKey(key, row, col))
+    {
+        test_pressed[row][col] = pressed;
+    }
+}
+
+/*
+ * Presses a key for 100 ms and releases it for 100 ms, scanning all the time.
+ */
+inline void testTap(char key, unsigned long hold = 100, unsigned long pause = 100)
+{
+    testSetKey(key, true);
+    testRun(hold);
+    testSetKey(key, false);
+    testRun(pause);
+}
+
+inline void testType(const char *keys)
+{
+    for (; *keys != '\0'; keys++)
+    {
+        testTap(*keys);
+    }
+}
+
+inline std::string testText()
+{
+    return std::string(rustyTextChars(RustyKeypad::getKeypadData()));
+}
+
+#endif
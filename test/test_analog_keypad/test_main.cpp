@@ -0,0 +1,228 @@
+#include <unity.h>
+#include <rusty_test_keypad.h>
+#include <rusty_analog_keypad.h>
+#include <vector>
+
+#define TEST_ANALOG_PIN 14
+#define TEST_IDLE_LEVEL 1023
+
+/*
+ * The ladder levels 80 counts apart, key 0 at 40 and key 11 at 920; '5' is key 4 at 360.
+ */
+static uint16_t test_levels[4 * 3];
+
+/*
+ * The ADC readings, repeated in a loop; a sample takes RUSTY_KEYPAD_ANALOG_OVERSAMPLING of them.
+ */
+static std::vector<uint16_t> test_readings;
+static size_t test_reading;
+
+static int testAnalogRead(uint8_t pin)
+{
+    TEST_ASSERT_EQUAL(TEST_ANALOG_PIN, pin);
+    return test_readings[test_reading++ % test_readings.size()];
+}
+
+static void testReadings(std::vector<uint16_t> readings)
+{
+    test_readings = readings;
+    test_reading = 0;
+}
+
+/*
+ * Samples that each settle at one of the values, in turn.
+ */
+static void testSamples(std::vector<uint16_t> values)
+{
+    std::vector<uint16_t> readings;
+    for (uint16_t value : values)
+    {
+        readings.insert(readings.end(), RUSTY_KEYPAD_ANALOG_OVERSAMPLING, value);
+    }
+    testReadings(readings);
+}
+
+static void testLevel(uint16_t value)
+{
+    testSamples({value});
+}
+
+/*
+ * Holds the ladder at a key level for a while, then releases it.
+ */
+static void testAnalogTap(uint16_t value)
+{
+    testLevel(value);
+    testRun(100);
+    testLevel(TEST_IDLE_LEVEL);
+    testRun(100);
+}
+
+void setUp()
+{
+    testKeypadSetup(RKP_INTEGER);
+    RustyAnalogKeypad::keyboardSetup(test_keys, 4, 3);
+    for (uint8_t i = 0; i < 4 * 3; i++)
+    {
+        test_levels[i] = (uint16_t)(40 + 80 * i);
+    }
+    setAnalogSource(testAnalogRead);
+    testLevel(TEST_IDLE_LEVEL);
+    TEST_ASSERT_TRUE(RustyAnalogKeypad::begin(TEST_ANALOG_PIN, test_levels, TEST_IDLE_LEVEL));
+    test_log.clear();
+}
+
+void tearDown()
+{
+    RustyAnalogKeypad::end();
+    setAnalogSource(nullptr);
+}
+
+void test_settled_level_presses_its_key()
+{
+    testAnalogTap(360);
+    TEST_ASSERT_EQUAL_STRING("5", testText().c_str());
+    TEST_ASSERT_EQUAL(RKP_NO_KEY_INDEX, RustyAnalogKeypad::getCurrentKey());
+    // Up to the midpoints with the neighbouring levels, at 320 and 400.
+    testAnalogTap(399);
+    testAnalogTap(320);
+    testAnalogTap(400);
+    TEST_ASSERT_EQUAL_STRING("5556", testText().c_str());
+    testAnalogTap(319);
+    TEST_ASSERT_EQUAL_STRING("55564", testText().c_str());
+}
+
+void test_bounce_across_neighbouring_bands_presses_no_other_key()
+{
+    // Settled samples at '4', '5' and '6' in turn, never the same key twice in a row.
+    testSamples({280, 360, 440, 360});
+    testRun(200);
+    TEST_ASSERT_EQUAL(RKP_NO_KEY_INDEX, RustyAnalogKeypad::getCurrentKey());
+    TEST_ASSERT_EQUAL_STRING("", test_log.c_str());
+
+    // Two samples of a neighbour in a row aren't enough either.
+    testSamples({360, 360, 360, 280, 280});
+    testRun(200);
+    testLevel(TEST_IDLE_LEVEL);
+    testRun(100);
+    TEST_ASSERT_EQUAL_STRING("5", testText().c_str());
+    TEST_ASSERT_EQUAL(std::string::npos, test_log.find("4;"));
+}
+
+void test_bounce_keeps_the_pressed_key()
+{
+    testLevel(360);
+    testRun(100);
+    TEST_ASSERT_EQUAL(4, RustyAnalogKeypad::getCurrentKey());
+    testSamples({360, 440, 360, 280});
+    testRun(200);
+    TEST_ASSERT_EQUAL(4, RustyAnalogKeypad::getCurrentKey());
+    testLevel(TEST_IDLE_LEVEL);
+    testRun(100);
+    TEST_ASSERT_EQUAL_STRING("5", testText().c_str());
+}
+
+void test_spread_over_the_tolerance_is_ignored()
+{
+    // The average is 360, but the readings spread 10 counts.
+    testReadings({355, 365, 360, 360});
+    testRun(200);
+    TEST_ASSERT_EQUAL(360, RustyAnalogKeypad::getLastValue());
+    TEST_ASSERT_EQUAL(RKP_NO_KEY_INDEX, RustyAnalogKeypad::getCurrentKey());
+
+    // A spread of exactly the tolerance is accepted.
+    testReadings({356, 356 + RUSTY_KEYPAD_ANALOG_TOLERANCE, 360, 360});
+    testRun(100);
+    TEST_ASSERT_EQUAL(4, RustyAnalogKeypad::getCurrentKey());
+}
+
+void test_uncalibrated_key_is_never_read()
+{
+    test_levels[4] = RKP_ANALOG_NO_LEVEL;
+    TEST_ASSERT_TRUE(RustyAnalogKeypad::begin(TEST_ANALOG_PIN, test_levels, TEST_IDLE_LEVEL));
+    TEST_ASSERT_EQUAL(RKP_ANALOG_NO_LEVEL, RustyAnalogKeypad::getLevels()[4]);
+    TEST_ASSERT_NOT_EQUAL(4, RustyAnalogKeypad::getKey(360));
+    TEST_ASSERT_EQUAL(3, RustyAnalogKeypad::getKey(319));
+    TEST_ASSERT_EQUAL(5, RustyAnalogKeypad::getKey(361));
+    // The window around a level is the smaller half gap to its neighbours, 40 counts for '4'.
+    testAnalogTap(330);
+    testAnalogTap(310);
+    testAnalogTap(430);
+    TEST_ASSERT_EQUAL_STRING("46", testText().c_str());
+}
+
+void test_keypad_without_levels_reads_no_key()
+{
+    TEST_ASSERT_TRUE(RustyAnalogKeypad::begin(TEST_ANALOG_PIN, nullptr, TEST_IDLE_LEVEL));
+    for (uint8_t i = 0; i < 4 * 3; i++)
+    {
+        TEST_ASSERT_EQUAL(RKP_ANALOG_NO_LEVEL, RustyAnalogKeypad::getLevels()[i]);
+    }
+    TEST_ASSERT_EQUAL(RKP_NO_KEY_INDEX, RustyAnalogKeypad::getKey(0));
+    testAnalogTap(360);
+    TEST_ASSERT_EQUAL_STRING("", test_log.c_str());
+}
+
+void test_begin_refuses_levels_that_are_too_close()
+{
+    test_levels[5] = (uint16_t)(test_levels[4] + RUSTY_KEYPAD_ANALOG_TOLERANCE - 1);
+    TEST_ASSERT_FALSE(RustyAnalogKeypad::begin(TEST_ANALOG_PIN, test_levels, TEST_IDLE_LEVEL));
+    // The keys are read anyway.
+    TEST_ASSERT_TRUE(RustyAnalogKeypad::isRunning());
+
+    test_levels[5] = (uint16_t)(test_levels[4] + RUSTY_KEYPAD_ANALOG_TOLERANCE);
+    TEST_ASSERT_TRUE(RustyAnalogKeypad::begin(TEST_ANALOG_PIN, test_levels, TEST_IDLE_LEVEL));
+
+    test_levels[5] = 440;
+    test_levels[11] = TEST_IDLE_LEVEL - 3;
+    TEST_ASSERT_FALSE(RustyAnalogKeypad::begin(TEST_ANALOG_PIN, test_levels, TEST_IDLE_LEVEL));
+}
+
+void test_calibrate_key_rejects_bad_measurements()
+{
+    // Beyond the keys.
+    TEST_ASSERT_FALSE(RustyAnalogKeypad::calibrateKey(4 * 3));
+
+    // Samples of 350 and 370 in turn: the readings are steady, the samples aren't.
+    testSamples({350, 370});
+    TEST_ASSERT_FALSE(RustyAnalogKeypad::calibrateKey(4));
+    TEST_ASSERT_EQUAL(360, RustyAnalogKeypad::getLevels()[4]);
+
+    // Too close to the level of '4', and to the idle level.
+    testLevel(283);
+    TEST_ASSERT_FALSE(RustyAnalogKeypad::calibrateKey(4));
+    testLevel(TEST_IDLE_LEVEL - 2);
+    TEST_ASSERT_FALSE(RustyAnalogKeypad::calibrateKey(4));
+    TEST_ASSERT_EQUAL(360, RustyAnalogKeypad::getLevels()[4]);
+
+    // Its own old level doesn't count.
+    testLevel(364);
+    TEST_ASSERT_TRUE(RustyAnalogKeypad::calibrateKey(4));
+    TEST_ASSERT_EQUAL(364, RustyAnalogKeypad::getLevels()[4]);
+    TEST_ASSERT_EQUAL(4, RustyAnalogKeypad::getKey(364));
+}
+
+void test_calibrate_idle_rejects_a_key_level()
+{
+    testLevel(923);
+    TEST_ASSERT_FALSE(RustyAnalogKeypad::calibrateIdle());
+    TEST_ASSERT_EQUAL(TEST_IDLE_LEVEL, RustyAnalogKeypad::getIdleLevel());
+    testLevel(1000);
+    TEST_ASSERT_TRUE(RustyAnalogKeypad::calibrateIdle());
+    TEST_ASSERT_EQUAL(1000, RustyAnalogKeypad::getIdleLevel());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_settled_level_presses_its_key);
+    RUN_TEST(test_bounce_across_neighbouring_bands_presses_no_other_key);
+    RUN_TEST(test_bounce_keeps_the_pressed_key);
+    RUN_TEST(test_spread_over_the_tolerance_is_ignored);
+    RUN_TEST(test_uncalibrated_key_is_never_read);
+    RUN_TEST(test_keypad_without_levels_reads_no_key);
+    RUN_TEST(test_begin_refuses_levels_that_are_too_close);
+    RUN_TEST(test_calibrate_key_rejects_bad_measurements);
+    RUN_TEST(test_calibrate_idle_rejects_a_key_level);
+    return UNITY_END();
+}
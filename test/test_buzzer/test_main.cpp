@@ -0,0 +1,70 @@
+#include <unity.h>
+#include <rusty_test_keypad.h>
+
+#define TEST_BUZZER_PIN 9
+
+static std::string test_edges;
+static uint8_t test_buzzer_level;
+
+/*
+ * Scans every millisecond and writes every change of the buzzer pin as "+ms level".
+ */
+static void testRunBuzzer(unsigned long duration)
+{
+    for (unsigned long start = millis(); millis() - start < duration;)
+    {
+        delay(1);
+        RustyKeypad::scan();
+        if (getPinLevel(TEST_BUZZER_PIN) != test_buzzer_level)
+        {
+            test_buzzer_level = getPinLevel(TEST_BUZZER_PIN);
+            test_edges += std::to_string(millis()) + (test_buzzer_level == HIGH ? " on;" : " off;");
+        }
+    }
+}
+
+void setUp()
+{
+    testKeypadSetup(RKP_INTEGER);
+    RustyKeypad::enableBuzzer(TEST_BUZZER_PIN, 50);
+    test_edges.clear();
+    test_buzzer_level = LOW;
+}
+
+void tearDown()
+{
+    RustyKeypad::disableBuzzer();
+}
+
+void test_key_down_beep_ends_while_the_key_is_held()
+{
+    testSetKey('5', true);
+    testRunBuzzer(500);
+    TEST_ASSERT_EQUAL_STRING("1021 on;1071 off;", test_edges.c_str());
+    TEST_ASSERT_FALSE(RustyBuzzer::isPlaying());
+    TEST_ASSERT_FALSE(RustyBuzzer::hasPendingUpdate());
+    testSetKey('5', false);
+    testRunBuzzer(100);
+    TEST_ASSERT_EQUAL(LOW, getPinLevel(TEST_BUZZER_PIN));
+}
+
+void test_delete_beeps_twice_across_scans()
+{
+    testType("12");
+    test_edges.clear();
+    testSetKey('*', true);
+    testRunBuzzer(1000);
+    testSetKey('*', false);
+    testRunBuzzer(300);
+    // The key down beep, then two beeps for the delete after the T9 duration.
+    TEST_ASSERT_EQUAL_STRING("1401 on;1451 off;2023 on;2073 off;2123 on;2173 off;", test_edges.c_str());
+    TEST_ASSERT_EQUAL_STRING("1", testText().c_str());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_key_down_beep_ends_while_the_key_is_held);
+    RUN_TEST(test_delete_beeps_twice_across_scans);
+    return UNITY_END();
+}
@@ -0,0 +1,138 @@
+#include <unity.h>
+#include <rusty_test_keypad.h>
+#include <rusty_coroutine.h>
+
+#if !defined(RUSTY_KEYPAD_HAS_COROUTINES)
+#error "test_coroutine needs a C++20 compiler, run it with `pio test -e native_cpp20`"
+#endif
+
+static char test_key;
+static RustyLine test_line;
+static unsigned long test_resumed_at;
+static bool test_done;
+
+static RustyTask waitKey(unsigned long timeout)
+{
+    test_key = co_await RustyAwait::nextKey(timeout);
+    test_done = true;
+}
+
+static RustyTask waitLine(unsigned long timeout)
+{
+    test_line = co_await RustyAwait::readLine(timeout);
+    test_done = true;
+}
+
+static RustyTask waitDelay(unsigned long duration)
+{
+    co_await RustyAwait::delay(duration);
+    test_resumed_at = millis();
+    test_done = true;
+}
+
+void setUp()
+{
+    testKeypadSetup(RKP_INTEGER);
+    test_key = 'x';
+    test_line.entered = false;
+    test_line.text[0] = '\0';
+    test_resumed_at = 0;
+    test_done = false;
+}
+
+void tearDown()
+{
+    testRun(5000);
+}
+
+void test_next_key_resumes_with_the_released_key()
+{
+    TEST_ASSERT_TRUE(waitKey(0).isStarted());
+    TEST_ASSERT_EQUAL(1, RustyAwait::getWaitingCount());
+    testRun(1000);
+    TEST_ASSERT_FALSE(test_done);
+    testTap('5');
+    TEST_ASSERT_TRUE(test_done);
+    TEST_ASSERT_EQUAL('5', test_key);
+    TEST_ASSERT_EQUAL(0, RustyAwait::getWaitingCount());
+}
+
+void test_next_key_resumes_with_nul_on_timeout()
+{
+    waitKey(300);
+    testRun(250);
+    TEST_ASSERT_FALSE(test_done);
+    testRun(100);
+    TEST_ASSERT_TRUE(test_done);
+    TEST_ASSERT_EQUAL('\0', test_key);
+}
+
+void test_read_line_ends_on_enter()
+{
+    RustyKeypad::setEnterKey('#');
+    waitLine(10000);
+    testType("12");
+    TEST_ASSERT_FALSE(test_done);
+    testTap('#', 800);
+    TEST_ASSERT_TRUE(test_done);
+    TEST_ASSERT_TRUE(test_line.entered);
+    TEST_ASSERT_EQUAL_STRING("12", test_line.text);
+}
+
+void test_read_line_returns_the_typed_text_on_timeout()
+{
+    RustyKeypad::setEnterKey('#');
+    waitLine(1000);
+    testType("34");
+    TEST_ASSERT_FALSE(test_done);
+    testRun(700);
+    TEST_ASSERT_TRUE(test_done);
+    TEST_ASSERT_FALSE(test_line.entered);
+    TEST_ASSERT_EQUAL_STRING("34", test_line.text);
+}
+
+void test_delay_resumes_after_the_duration_while_keys_work()
+{
+    unsigned long start = millis();
+    waitDelay(500);
+    testType("7");
+    TEST_ASSERT_FALSE(test_done);
+    testRun(400);
+    TEST_ASSERT_TRUE(test_done);
+    TEST_ASSERT_GREATER_OR_EQUAL(start + 500, test_resumed_at);
+    TEST_ASSERT_LESS_OR_EQUAL(start + 505, test_resumed_at);
+    TEST_ASSERT_EQUAL_STRING("7", testText().c_str());
+}
+
+void test_zero_delay_does_not_suspend()
+{
+    waitDelay(0);
+    TEST_ASSERT_TRUE(test_done);
+    TEST_ASSERT_EQUAL(0, RustyAwait::getWaitingCount());
+}
+
+void test_coroutine_does_not_start_when_the_pool_is_exhausted()
+{
+    for (uint8_t i = 0; i < RUSTY_KEYPAD_COROUTINE_FRAMES; i++)
+    {
+        TEST_ASSERT_TRUE(waitKey(1000).isStarted());
+    }
+    TEST_ASSERT_FALSE(waitKey(1000).isStarted());
+    TEST_ASSERT_EQUAL(RUSTY_KEYPAD_COROUTINE_FRAMES, RustyAwait::getWaitingCount());
+    testRun(1100);
+    TEST_ASSERT_EQUAL(0, RustyAwait::getWaitingCount());
+    TEST_ASSERT_TRUE(waitKey(1000).isStarted());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_next_key_resumes_with_the_released_key);
+    RUN_TEST(test_next_key_resumes_with_nul_on_timeout);
+    RUN_TEST(test_read_line_ends_on_enter);
+    RUN_TEST(test_read_line_returns_the_typed_text_on_timeout);
+    RUN_TEST(test_delay_resumes_after_the_duration_while_keys_work);
+    RUN_TEST(test_zero_delay_does_not_suspend);
+    RUN_TEST(test_coroutine_does_not_start_when_the_pool_is_exhausted);
+    return UNITY_END();
+}
@@ -0,0 +1,142 @@
+#include <unity.h>
+#include <rusty_test_keypad.h>
+
+#define TEST_SALT 0x5EED1234UL
+
+/*
+ * 0x17 starts at slot 3 and wraps around to slot 0, 0x20 starts at slot 0 and
+ * moves on to slot 1. 0x21 starts at slot 1 but sits behind the empty slot 2,
+ * where a lookup never reaches it.
+ */
+static const uint32_t chain_hashes[4] = {0x17, 0x20, 0, 0x21};
+static const uint16_t chain_ids[4] = {1, 2, RKP_CREDENTIAL_NONE, 3};
+static const RustyCredentialTable chain_table = {0, 4, chain_hashes, chain_ids};
+
+/*
+ * Five hashes that all start at slot 0 of 16. The fifth is past the slots a
+ * lookup reads, where the generator never puts a PIN.
+ */
+static const uint32_t full_hashes[16] = {0x10, 0x20, 0x30, 0x40, 0x50};
+static const uint16_t full_ids[16] = {1, 2, 3, 4, 5};
+static const RustyCredentialTable full_table = {0, 16, full_hashes, full_ids};
+
+static uint32_t pin_hashes[4];
+static uint16_t pin_ids[4];
+static RustyCredentialTable pin_table = {TEST_SALT, 4, pin_hashes, pin_ids};
+
+static void addPin(uint16_t id, const char *pin)
+{
+    uint32_t hash = RustyCredentials::hash(TEST_SALT, pin);
+    uint16_t slot = hash & 3;
+    while (pin_hashes[slot] != 0)
+    {
+        slot = (slot + 1) & 3;
+    }
+    pin_hashes[slot] = hash;
+    pin_ids[slot] = id;
+}
+
+static void testOnCredential(uint16_t id)
+{
+    char text[8];
+    snprintf(text, sizeof(text), "%u", id);
+    testLog("credential %s;", text);
+}
+
+void setUp()
+{
+    memset(pin_hashes, 0, sizeof(pin_hashes));
+    memset(pin_ids, 0xFF, sizeof(pin_ids));
+    addPin(1, "1234");
+    addPin(2, "6789");
+    testKeypadSetup(RKP_INTEGER);
+    RustyKeypad::setEnterKey('#');
+    RustyKeypad::addCredentialListener(testOnCredential);
+}
+
+void tearDown()
+{
+}
+
+void test_hash_matches_the_generator()
+{
+    // Values printed by extras/tools/rusty_credentials.py for the same salt.
+    TEST_ASSERT_EQUAL_HEX32(0x57126846, RustyCredentials::hash(TEST_SALT, "1234"));
+    TEST_ASSERT_EQUAL_HEX32(0x0d0c1a50, RustyCredentials::hash(TEST_SALT, "6789"));
+}
+
+void test_find_follows_the_probe_chain()
+{
+    TEST_ASSERT_EQUAL(1, RustyCredentials::find(&chain_table, 0x17));
+    TEST_ASSERT_EQUAL(2, RustyCredentials::find(&chain_table, 0x20));
+    TEST_ASSERT_EQUAL(RKP_CREDENTIAL_NONE, RustyCredentials::find(&chain_table, 0x30));
+}
+
+void test_find_stops_matching_at_an_empty_slot()
+{
+    TEST_ASSERT_EQUAL(RKP_CREDENTIAL_NONE, RustyCredentials::find(&chain_table, 0x21));
+}
+
+void test_find_reads_a_fixed_number_of_slots()
+{
+    TEST_ASSERT_EQUAL(4, RUSTY_KEYPAD_CREDENTIAL_PROBES);
+    TEST_ASSERT_EQUAL(4, RustyCredentials::find(&full_table, 0x40));
+    TEST_ASSERT_EQUAL(RKP_CREDENTIAL_NONE, RustyCredentials::find(&full_table, 0x50));
+}
+
+void test_find_without_a_table()
+{
+    TEST_ASSERT_EQUAL(RKP_CREDENTIAL_NONE, RustyCredentials::find(nullptr, 0x10));
+}
+
+void test_credential_is_reported_before_a_masked_enter()
+{
+    RustyKeypad::setCredentialTable(&pin_table);
+    testType("6789");
+    test_log.clear();
+    testTap('#', 800);
+    TEST_ASSERT_EQUAL_STRING("down #;credential 2;enter ****;text ;", test_log.c_str());
+}
+
+void test_unknown_code_is_reported()
+{
+    RustyKeypad::setCredentialTable(&pin_table);
+    testType("1235");
+    test_log.clear();
+    testTap('#', 800);
+    TEST_ASSERT_EQUAL_STRING("down #;credential 65535;enter ****;text ;", test_log.c_str());
+}
+
+void test_code_edited_in_the_middle_is_hashed_again()
+{
+    RustyKeypad::setCredentialTable(&pin_table);
+    RustyKeypad::setCursorKeys('7', '9');
+    testType("124");
+    testType("7");
+    testType("3");
+    TEST_ASSERT_EQUAL_STRING("1234", testText().c_str());
+    TEST_ASSERT_EQUAL(1, RustyKeypad::findCredential());
+}
+
+void test_enter_is_plain_without_a_table()
+{
+    testType("6789");
+    test_log.clear();
+    testTap('#', 800);
+    TEST_ASSERT_EQUAL_STRING("down #;enter 6789;text ;", test_log.c_str());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_hash_matches_the_generator);
+    RUN_TEST(test_find_follows_the_probe_chain);
+    RUN_TEST(test_find_stops_matching_at_an_empty_slot);
+    RUN_TEST(test_find_reads_a_fixed_number_of_slots);
+    RUN_TEST(test_find_without_a_table);
+    RUN_TEST(test_credential_is_reported_before_a_masked_enter);
+    RUN_TEST(test_unknown_code_is_reported);
+    RUN_TEST(test_code_edited_in_the_middle_is_hashed_again);
+    RUN_TEST(test_enter_is_plain_without_a_table);
+    return UNITY_END();
+}
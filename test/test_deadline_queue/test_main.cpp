@@ -0,0 +1,90 @@
+#include <unity.h>
+#include <rusty_test_keypad.h>
+
+void setUp()
+{
+    testKeypadSetup(RKP_INTEGER);
+}
+
+void tearDown()
+{
+}
+
+void test_released_keypad_has_no_deadline()
+{
+    testRun(100);
+    TEST_ASSERT_FALSE(RustyKeypad::hasPendingDeadline());
+}
+
+void test_earliest_deadline_comes_first()
+{
+    testSetKey('5', true);
+    testRun(100);
+    unsigned long first = RustyKeypad::getNextDeadline();
+    testSetKey('1', true);
+    testRun(100);
+    TEST_ASSERT_EQUAL(first, RustyKeypad::getNextDeadline());
+    testSetKey('5', false);
+    testRun(50);
+    TEST_ASSERT_TRUE(RustyKeypad::hasPendingDeadline());
+    TEST_ASSERT_TRUE((long)(RustyKeypad::getNextDeadline() - first) > 0);
+}
+
+void test_deadline_fires_on_time()
+{
+    testSetKey('5', true);
+    testRun(100);
+    unsigned long deadline = RustyKeypad::getNextDeadline();
+    test_log.clear();
+    testRun(deadline - millis() - 10, 1);
+    TEST_ASSERT_EQUAL_STRING("", test_log.c_str());
+    testRun(20, 1);
+    TEST_ASSERT_EQUAL_STRING("up 5;text 5;", test_log.c_str());
+}
+
+void test_passed_deadline_is_kept_until_the_key_moves_on()
+{
+    testSetKey('5', true);
+    testRun(100);
+    unsigned long deadline = RustyKeypad::getNextDeadline();
+    delay(deadline - millis() + 10);
+    TEST_ASSERT_TRUE(RustyKeypad::hasPendingDeadline());
+    TEST_ASSERT_EQUAL(deadline, RustyKeypad::getNextDeadline());
+    TEST_ASSERT_EQUAL(0, RustyKeypad::getSleepDuration());
+    RustyKeypad::scan();
+    TEST_ASSERT_TRUE((long)(RustyKeypad::getNextDeadline() - millis()) > 0);
+}
+
+void test_deadline_survives_a_long_pause_between_scans()
+{
+    testSetKey('5', true);
+    testSetKey('1', true);
+    testRun(100);
+    test_log.clear();
+    delay(40000);
+    RustyKeypad::scan();
+    TEST_ASSERT_EQUAL_STRING("up 1;up 5;text 15;", test_log.c_str());
+    TEST_ASSERT_TRUE((long)(RustyKeypad::getNextDeadline() - millis()) > 0);
+}
+
+void test_deadline_survives_the_wrap_of_millis()
+{
+    setClock((unsigned long)-1 - 500);
+    testSetKey('5', true);
+    testRun(100);
+    test_log.clear();
+    testRun(2000);
+    TEST_ASSERT_EQUAL_STRING("up 5;text 5;down 5;", test_log.c_str());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_released_keypad_has_no_deadline);
+    RUN_TEST(test_earliest_deadline_comes_first);
+    RUN_TEST(test_deadline_fires_on_time);
+    RUN_TEST(test_passed_deadline_is_kept_until_the_key_moves_on);
+    RUN_TEST(test_deadline_survives_a_long_pause_between_scans);
+    RUN_TEST(test_deadline_survives_the_wrap_of_millis);
+    return UNITY_END();
+}
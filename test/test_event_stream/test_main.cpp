@@ -0,0 +1,218 @@
+#include <unity.h>
+#include <rusty_test_keypad.h>
+#include <rusty_event_stream.h>
+#include <vector>
+
+/*
+ * Hands the bytes written by the stream back to the decoder, like a serial
+ * link between the device and the host.
+ */
+struct TestLoopback : public Stream
+{
+    std::string bytes;
+    size_t position = 0;
+    size_t write(uint8_t b) override
+    {
+        bytes += (char)b;
+        return 1;
+    }
+    using Print::write;
+    int available() override { return (int)(bytes.size() - position); }
+    int read() override { return available() > 0 ? (uint8_t)bytes[position++] : -1; }
+    int peek() override { return available() > 0 ? (uint8_t)bytes[position] : -1; }
+};
+
+struct TestFrame
+{
+    uint8_t sequence;
+    uint16_t time;
+    std::string records;
+};
+
+static TestLoopback link_bytes;
+static std::vector<TestFrame> frames;
+static uint16_t bad_frames;
+
+static uint16_t testCrc16(const std::string &data)
+{
+    uint16_t crc = 0xFFFF;
+    for (char c : data)
+    {
+        crc ^= (uint16_t)(uint8_t)c << 8;
+        for (uint8_t i = 0; i < 8; i++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/*
+ * Writes the records of a frame as "type:bytes" words and checks that they
+ * fill the frame exactly, with 1 to 3 bytes each.
+ */
+static std::string testRecords(const std::string &records)
+{
+    std::string words;
+    char word[8];
+    size_t offset = 0;
+    while (offset < records.size())
+    {
+        uint8_t head = (uint8_t)records[offset++];
+        uint8_t size = head >> 4;
+        TEST_ASSERT_TRUE(size >= 1 && size <= 3);
+        TEST_ASSERT_LESS_OR_EQUAL(records.size(), offset + size);
+        snprintf(word, sizeof(word), "%u:", head & 0x0F);
+        words += word;
+        for (uint8_t i = 0; i < size; i++)
+        {
+            snprintf(word, sizeof(word), "%02x", (uint8_t)records[offset++]);
+            words += word;
+        }
+        words += ' ';
+    }
+    return words;
+}
+
+/*
+ * Reads the link like the host decoder: frames start at a sync byte, and a
+ * frame with a bad CRC is dropped one byte at a time to find the next one.
+ */
+static void testDecode()
+{
+    std::string buffer;
+    while (link_bytes.available() > 0)
+    {
+        buffer += (char)link_bytes.read();
+    }
+    size_t start = 0;
+    while ((start = buffer.find((char)RUSTY_KEYPAD_STREAM_SYNC, start)) != std::string::npos)
+    {
+        if (buffer.size() - start < 5)
+        {
+            break;
+        }
+        uint8_t length = (uint8_t)buffer[start + 1];
+        size_t size = 7 + length;
+        if (buffer.size() - start < size)
+        {
+            break;
+        }
+        std::string body = buffer.substr(start + 1, 4 + length);
+        uint16_t crc = (uint8_t)buffer[start + size - 2] | (uint16_t)(uint8_t)buffer[start + size - 1] << 8;
+        if (testCrc16(body) != crc)
+        {
+            bad_frames++;
+            start++;
+            continue;
+        }
+        TEST_ASSERT_LESS_OR_EQUAL(RUSTY_KEYPAD_STREAM_FRAME_SIZE, length);
+        frames.push_back({(uint8_t)body[1], (uint16_t)((uint8_t)body[2] | (uint8_t)body[3] << 8), body.substr(4)});
+        testRecords(frames.back().records);
+        start += size;
+    }
+}
+
+void setUp()
+{
+    testKeypadSetup(RKP_INTEGER);
+    link_bytes.bytes.clear();
+    link_bytes.position = 0;
+    frames.clear();
+    bad_frames = 0;
+    RustyEventStream::begin(link_bytes);
+}
+
+void tearDown()
+{
+    RustyEventStream::end();
+    RustyKeypad::setIdleTimeout(30000);
+}
+
+void test_crc_is_ccitt_false()
+{
+    TEST_ASSERT_EQUAL_HEX16(0x29B1, testCrc16("123456789"));
+}
+
+void test_tap_is_sent_frame_by_frame()
+{
+    testTap('5');
+    testDecode();
+    TEST_ASSERT_EQUAL(0, bad_frames);
+    TEST_ASSERT_EQUAL(2, frames.size());
+    // Key down 53 after the 20 ms filter; then key up and the text change: insert, 1 character, '5'.
+    TEST_ASSERT_EQUAL(0, frames[0].sequence);
+    TEST_ASSERT_EQUAL(1025, frames[0].time);
+    TEST_ASSERT_EQUAL_STRING("1:35 ", testRecords(frames[0].records).c_str());
+    TEST_ASSERT_EQUAL(1, frames[1].sequence);
+    TEST_ASSERT_EQUAL_STRING("2:35 0:010135 ", testRecords(frames[1].records).c_str());
+    TEST_ASSERT_EQUAL(2, RustyEventStream::getSequence());
+    TEST_ASSERT_EQUAL(9 + 13, link_bytes.bytes.size());
+}
+
+void test_interval_packs_records_into_full_frames()
+{
+    RustyEventStream::begin(link_bytes, 60000);
+    testType("123456789");
+    testDecode();
+    // A tap is a key down, a key up and a text change record of 2 + 2 + 4 bytes; 4 taps fill a frame.
+    TEST_ASSERT_EQUAL(2, frames.size());
+    TEST_ASSERT_EQUAL(32, frames[0].records.size());
+    TEST_ASSERT_EQUAL(32, frames[1].records.size());
+    RustyEventStream::end();
+    testDecode();
+    TEST_ASSERT_EQUAL(0, bad_frames);
+    TEST_ASSERT_EQUAL(3, frames.size());
+    TEST_ASSERT_EQUAL_STRING("1:39 2:39 0:010939 ", testRecords(frames[2].records).c_str());
+    TEST_ASSERT_FALSE(RustyEventStream::isStreaming());
+}
+
+void test_sequence_wraps_after_255()
+{
+    // Every tap takes a frame for its key down and one for its key up.
+    for (uint16_t i = 0; i < 130; i++)
+    {
+        testTap('5');
+    }
+    testDecode();
+    TEST_ASSERT_EQUAL(0, bad_frames);
+    TEST_ASSERT_GREATER_THAN(256, frames.size());
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        TEST_ASSERT_EQUAL((uint8_t)i, frames[i].sequence);
+    }
+    TEST_ASSERT_EQUAL((uint8_t)frames.size(), RustyEventStream::getSequence());
+}
+
+void test_decoder_resyncs_after_a_corrupted_frame()
+{
+    testTap('5');
+    testTap('6');
+    size_t first = link_bytes.bytes.size();
+    testTap('7');
+    std::string good = link_bytes.bytes;
+
+    // Noise with a sync byte before the first frame, and a flipped bit in the key down record of '7'.
+    link_bytes.bytes = std::string("\x00\x7E\x02\x00", 4) + good;
+    link_bytes.bytes[4 + first + 5 + 1] ^= 0x01;
+    testDecode();
+    TEST_ASSERT_GREATER_OR_EQUAL(2, bad_frames);
+    TEST_ASSERT_EQUAL(5, frames.size());
+    const uint8_t expected[] = {0, 1, 2, 3, 5};
+    for (uint8_t i = 0; i < 5; i++)
+    {
+        TEST_ASSERT_EQUAL(expected[i], frames[i].sequence);
+    }
+    TEST_ASSERT_EQUAL_STRING("2:37 0:010337 ", testRecords(frames[4].records).c_str());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_crc_is_ccitt_false);
+    RUN_TEST(test_tap_is_sent_frame_by_frame);
+    RUN_TEST(test_interval_packs_records_into_full_frames);
+    RUN_TEST(test_sequence_wraps_after_255);
+    RUN_TEST(test_decoder_resyncs_after_a_corrupted_frame);
+    return UNITY_END();
+}
@@ -0,0 +1,149 @@
+#include <unity.h>
+#include <rusty_test_keypad.h>
+
+static RustyInputMask date;
+
+void setUp()
+{
+    testKeypadSetup(RKP_INTEGER);
+    date.compile("##/##/####");
+    date.setRange(0, 1, 31);
+    date.setRange(1, 1, 12);
+}
+
+void tearDown()
+{
+    RustyKeypad::setInputMask(nullptr);
+}
+
+/*
+ * Feeds the keys to the mask like the keypad does; the literals have to match.
+ */
+static bool acceptAll(const RustyInputMask &mask, const char *keys)
+{
+    uint16_t values[RUSTY_KEYPAD_MAX_MASK_FIELDS] = {0};
+    for (uint8_t i = 0; keys[i] != '\0'; i++)
+    {
+        if (mask.isLiteral(i))
+        {
+            if (keys[i] != mask.getLiteral(i))
+            {
+                return false;
+            }
+            continue;
+        }
+        if (!mask.accept(i, keys[i], values[mask.getField(i)]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void test_compile_splits_fields_at_literals()
+{
+    TEST_ASSERT_EQUAL(10, date.length());
+    TEST_ASSERT_TRUE(date.isLiteral(2));
+    TEST_ASSERT_EQUAL('/', date.getLiteral(5));
+    TEST_ASSERT_EQUAL(0, date.getField(1));
+    TEST_ASSERT_EQUAL(1, date.getField(3));
+    TEST_ASSERT_EQUAL(2, date.getField(9));
+}
+
+void test_compile_rejects_oversized_patterns()
+{
+    RustyInputMask mask;
+    TEST_ASSERT_FALSE(mask.compile("#################"));
+    TEST_ASSERT_EQUAL(0, mask.length());
+    TEST_ASSERT_FALSE(mask.compile("#.#.#.#.#.#.#.#.#"));
+    TEST_ASSERT_TRUE(mask.compile("#.#.#.#.#.#.#.#"));
+}
+
+void test_escaped_placeholder_is_a_literal()
+{
+    RustyInputMask mask;
+    TEST_ASSERT_TRUE(mask.compile("\\##"));
+    TEST_ASSERT_TRUE(mask.isLiteral(0));
+    TEST_ASSERT_EQUAL('#', mask.getLiteral(0));
+    TEST_ASSERT_FALSE(mask.isLiteral(1));
+}
+
+void test_kinds_accept_their_keys()
+{
+    RustyInputMask mask;
+    mask.compile("#XA?");
+    TEST_ASSERT_TRUE(acceptAll(mask, "9fZ*"));
+    TEST_ASSERT_FALSE(acceptAll(mask, "a"));
+    TEST_ASSERT_FALSE(acceptAll(mask, "1G"));
+    TEST_ASSERT_FALSE(acceptAll(mask, "119"));
+}
+
+void test_range_checks_every_prefix()
+{
+    TEST_ASSERT_TRUE(acceptAll(date, "31"));
+    TEST_ASSERT_FALSE(acceptAll(date, "4"));
+    TEST_ASSERT_FALSE(acceptAll(date, "32"));
+    TEST_ASSERT_FALSE(acceptAll(date, "00"));
+    TEST_ASSERT_FALSE(acceptAll(date, "31/13"));
+    TEST_ASSERT_TRUE(acceptAll(date, "31/12/2024"));
+}
+
+void test_range_on_the_last_field_of_the_bit_mask()
+{
+    RustyInputMask mask;
+    TEST_ASSERT_TRUE(mask.compile("#.#.#.#.#.#.#.#"));
+    TEST_ASSERT_TRUE(mask.setRange(RUSTY_KEYPAD_MAX_MASK_FIELDS - 1, 2, 5));
+    TEST_ASSERT_TRUE(acceptAll(mask, "9.9.9.9.9.9.9.3"));
+    TEST_ASSERT_FALSE(acceptAll(mask, "9.9.9.9.9.9.9.7"));
+    TEST_ASSERT_FALSE(mask.setRange(RUSTY_KEYPAD_MAX_MASK_FIELDS, 0, 1));
+}
+
+void test_range_is_refused_for_long_fields()
+{
+    RustyInputMask mask;
+    mask.compile("######");
+    TEST_ASSERT_FALSE(mask.setRange(0, 0, 1));
+    mask.compile("#####");
+    TEST_ASSERT_TRUE(mask.setRange(0, 0, 1));
+}
+
+void test_keypad_inserts_literals_and_skips_rejected_keys()
+{
+    RustyKeypad::setInputMask(&date);
+    testType("431");
+    TEST_ASSERT_EQUAL_STRING("31/", testText().c_str());
+    testType("0612");
+    TEST_ASSERT_EQUAL_STRING("31/06/12", testText().c_str());
+}
+
+void test_keypad_deletes_across_literals()
+{
+    RustyKeypad::setInputMask(&date);
+    testType("3106");
+    TEST_ASSERT_EQUAL_STRING("31/06/", testText().c_str());
+    testTap('*', 800);
+    TEST_ASSERT_EQUAL_STRING("31/0", testText().c_str());
+    testType("9");
+    TEST_ASSERT_EQUAL_STRING("31/09/", testText().c_str());
+    testTap('*', 800);
+    testTap('*', 800);
+    testType("2");
+    TEST_ASSERT_EQUAL_STRING("31/", testText().c_str());
+    testType("1");
+    TEST_ASSERT_EQUAL_STRING("31/1", testText().c_str());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_compile_splits_fields_at_literals);
+    RUN_TEST(test_compile_rejects_oversized_patterns);
+    RUN_TEST(test_escaped_placeholder_is_a_literal);
+    RUN_TEST(test_kinds_accept_their_keys);
+    RUN_TEST(test_range_checks_every_prefix);
+    RUN_TEST(test_range_on_the_last_field_of_the_bit_mask);
+    RUN_TEST(test_range_is_refused_for_long_fields);
+    RUN_TEST(test_keypad_inserts_literals_and_skips_rejected_keys);
+    RUN_TEST(test_keypad_deletes_across_literals);
+    return UNITY_END();
+}
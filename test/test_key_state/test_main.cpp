@@ -0,0 +1,103 @@
+#include <unity.h>
+#include <rusty_test_keypad.h>
+
+/*
+ * Opens the protected reset(), which interrupts the scan that called the listener.
+ */
+struct TestKeypad : RustyKeypad
+{
+    using BaseRustyKeypad::reset;
+};
+
+static bool reset_on_down;
+
+static void testResetOnDown(char key)
+{
+    testOnKeyDown(key);
+    if (reset_on_down)
+    {
+        TestKeypad::reset();
+    }
+}
+
+void setUp()
+{
+    testKeypadSetup(RKP_INTEGER);
+    reset_on_down = false;
+}
+
+void tearDown()
+{
+}
+
+void test_pressed_keys_follow_the_debounced_state()
+{
+    testSetKey('5', true);
+    RustyKeypad::scan();
+    TEST_ASSERT_FALSE(RustyKeypad::isKeyPressed('5'));
+    testRun(50);
+    TEST_ASSERT_TRUE(RustyKeypad::isKeyPressed('5'));
+    TEST_ASSERT_TRUE(RustyKeypad::isKeyPressed(1, 1));
+    TEST_ASSERT_TRUE(RustyKeypad::isAnyKeyPressed());
+    testSetKey('5', false);
+    testRun(50);
+    TEST_ASSERT_FALSE(RustyKeypad::isKeyPressed('5'));
+    TEST_ASSERT_FALSE(RustyKeypad::isAnyKeyPressed());
+}
+
+/*
+ * '1' is on the first row; its listener interrupts the scan, so the row of '5'
+ * isn't checked in that scan.
+ */
+static void testInterruptedScan(bool hold_five)
+{
+    RustyKeypad::addKeyDownListener(testResetOnDown);
+    testSetKey('5', true);
+    testRun(50);
+    reset_on_down = true;
+    testSetKey('1', true);
+    testSetKey('5', hold_five);
+    while (test_log.find("down 1;") == std::string::npos)
+    {
+        delay(5);
+        RustyKeypad::scan();
+    }
+}
+
+void test_release_behind_an_interrupted_scan_is_seen()
+{
+    testInterruptedScan(false);
+    TEST_ASSERT_FALSE(RustyKeypad::isKeyPressed('5'));
+    TEST_ASSERT_FALSE(RustyKeypad::isKeyPressed(1, 1));
+    TEST_ASSERT_TRUE(RustyKeypad::isKeyPressed('1'));
+}
+
+void test_key_held_behind_an_interrupted_scan_stays_pressed()
+{
+    testInterruptedScan(true);
+    TEST_ASSERT_TRUE(RustyKeypad::isKeyPressed('5'));
+    TEST_ASSERT_TRUE(RustyKeypad::isKeyPressed('1'));
+}
+
+void test_keys_take_their_role_from_the_current_delete_key()
+{
+    RustyKeypad::useDeleteKey('#');
+    testType("12");
+    testTap('#', 800);
+    TEST_ASSERT_EQUAL_STRING("1", testText().c_str());
+    testTap('*', 800);
+    TEST_ASSERT_EQUAL_STRING("1*", testText().c_str());
+    RustyKeypad::ignoreDeleteKey();
+    testTap('#', 800);
+    TEST_ASSERT_EQUAL_STRING("1*#", testText().c_str());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_pressed_keys_follow_the_debounced_state);
+    RUN_TEST(test_release_behind_an_interrupted_scan_is_seen);
+    RUN_TEST(test_key_held_behind_an_interrupted_scan_stays_pressed);
+    RUN_TEST(test_keys_take_their_role_from_the_current_delete_key);
+    return UNITY_END();
+}
@@ -0,0 +1,284 @@
+#include <unity.h>
+#include <rusty_keypad.h>
+#include <rusty_key_table.h>
+
+/*
+ * The outcome of one key check: what check() returns, the event it sets
+ * (RKP_NO_EVENT if it sets none) and what happens to the character index.
+ */
+struct TestStep
+{
+    bool result;
+    uint8_t event;
+    uint8_t action;
+};
+
+/*
+ * The branches of RustyKey::check() before the transition table, with
+ * analyzeState, analyzeSameState, fixCurrentState and checkTimeout kept as
+ * they were. The key starts with a due deadline, so a key that stays as it is
+ * is analyzed too. `expired` holds one bit per RustyKeyTimers value; setting
+ * an event or the next character restarts every timer.
+ */
+struct TestOldKey
+{
+    bool t9;
+    uint8_t role;
+    bool current_state;
+    uint8_t current_event;
+    uint8_t expired;
+    TestStep step;
+
+    bool isOver(uint8_t timer) const { return (expired >> timer) & 1U; }
+
+    void setEvent(uint8_t e)
+    {
+        current_event = e;
+        step.event = e;
+        expired = 0;
+    }
+
+    void nextCharIndex()
+    {
+        step.action = RKP_ACTION_NEXT_CHAR;
+        expired = 0;
+    }
+
+    bool isEventDeleteRelation() const
+    {
+        return current_event == RKP_PRESS_DELETE || current_event == RKP_CLEAR_SCREEN;
+    }
+
+    bool isEventEnterRelation() const
+    {
+        return current_event == RKP_PRESS_ENTER || current_event == RKP_RELEASE_ENTER;
+    }
+
+    bool checkTimeout()
+    {
+        if (role == RKP_ROLE_DELETE)
+        {
+            if (isOver(RKP_TIMER_T9))
+            {
+                setEvent(RKP_PRESS_DELETE);
+                return true;
+            }
+        }
+        else if (role == RKP_ROLE_ENTER)
+        {
+            if (isOver(RKP_TIMER_T9))
+            {
+                setEvent(RKP_PRESS_ENTER);
+                return true;
+            }
+        }
+        else if (t9 && role != RKP_ROLE_CURSOR)
+        {
+            if (isOver(RKP_TIMER_T9))
+            {
+                nextCharIndex();
+                setEvent(RKP_T9_NEXT_CHAR);
+                return true;
+            }
+            return false;
+        }
+        else if (isOver(RKP_TIMER_KEY_DOWN))
+        {
+            setEvent(RKP_KEY_UP);
+            return true;
+        }
+        return false;
+    }
+
+    void analyzeState()
+    {
+        if (isEventDeleteRelation())
+        {
+            setEvent(RKP_RELEASE_DELETE);
+            return;
+        }
+        else if (isEventEnterRelation())
+        {
+            setEvent(RKP_RELEASE_ENTER);
+            return;
+        }
+        else if (t9)
+        {
+            setEvent(RKP_KEY_UP);
+            return;
+        }
+        else if (isOver(RKP_TIMER_LONG_PRESS))
+        {
+            setEvent(RKP_LONG_PRESS);
+            return;
+        }
+        setEvent(RKP_KEY_UP);
+    }
+
+    bool fixCurrentState(bool new_state)
+    {
+        if (isEventDeleteRelation())
+        {
+            if (isOver(RKP_TIMER_LONG_PRESS) && current_event != RKP_CLEAR_SCREEN)
+            {
+                setEvent(RKP_CLEAR_SCREEN);
+                return true;
+            }
+            return false;
+        }
+        else if (isEventEnterRelation())
+        {
+            if (!new_state)
+            {
+                setEvent(RKP_KEY_IDLE);
+            }
+            return !new_state;
+        }
+        else if (current_event == RKP_T9_NEXT_CHAR)
+        {
+            setEvent(RKP_KEY_DOWN);
+            return true;
+        }
+        else if (current_event == RKP_KEY_UP)
+        {
+            step.action = RKP_ACTION_RESET_CHAR;
+            setEvent(RKP_KEY_DOWN);
+            return true;
+        }
+        setEvent(RKP_WAIT);
+        return !current_state ? false : checkTimeout();
+    }
+
+    bool analyzeSameState(bool new_state)
+    {
+        if (new_state && current_event != RKP_WAIT)
+        {
+            return fixCurrentState(new_state);
+        }
+        else if (!new_state && current_event != RKP_KEY_IDLE)
+        {
+            setEvent(RKP_KEY_IDLE);
+        }
+        return !current_state ? false : checkTimeout();
+    }
+
+    bool check(bool new_state)
+    {
+        if (new_state == current_state)
+        {
+            return analyzeSameState(new_state);
+        }
+        current_state = new_state;
+        if (!new_state)
+        {
+            analyzeState();
+            return true;
+        }
+        step.action = RKP_ACTION_RESET_CHAR;
+        if (t9 && role == RKP_ROLE_NORMAL)
+        {
+            setEvent(RKP_T9_NEXT_CHAR);
+            return true;
+        }
+        setEvent(RKP_KEY_DOWN);
+        return true;
+    }
+};
+
+static TestStep oldStep(bool t9, uint8_t role, uint8_t sample, uint8_t event, uint8_t expired)
+{
+    TestOldKey key = {t9, role, (sample & 2U) != 0, event, expired, {false, RKP_NO_EVENT, RKP_ACTION_NONE}};
+    key.step.result = key.check((sample & 1U) != 0);
+    return key.step;
+}
+
+/*
+ * What RustyKey::check() makes of the rule it looks up.
+ */
+static TestStep tableStep(bool t9, uint8_t role, uint8_t sample, uint8_t event, uint8_t expired)
+{
+    uint16_t rule = rkpTransition(rkpRules(t9), role, sample, event);
+    TestStep step = {false, rkpRuleEvent(rule), rkpRuleAction(rule)};
+    if (rkpRuleTimer(rule) != RKP_TIMER_NONE && !((expired >> rkpRuleTimer(rule)) & 1U))
+    {
+        step.event = rkpRuleOtherwise(rule);
+        step.action = RKP_ACTION_NONE;
+    }
+    if (step.event == RKP_NO_EVENT)
+    {
+        step.action = RKP_ACTION_NONE;
+        return step;
+    }
+    step.result = (step.event != RKP_KEY_IDLE && step.event != RKP_WAIT);
+    return step;
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+/*
+ * Every T9 mode, role, sample, event and combination of expired timers.
+ */
+static void testAllCells(bool t9)
+{
+    char cell[64];
+    for (uint8_t role = RKP_ROLE_NORMAL; role <= RKP_ROLE_ENTER; role++)
+    {
+        for (uint8_t sample = RKP_SAMPLE_RELEASED; sample <= RKP_SAMPLE_HELD; sample++)
+        {
+            for (uint8_t event = 0; event < RUSTY_KEYPAD_KEY_EVENTS; event++)
+            {
+                for (uint8_t expired = 0; expired < 16; expired += 2)
+                {
+                    TestStep old_step = oldStep(t9, role, sample, event, expired);
+                    TestStep table_step = tableStep(t9, role, sample, event, expired);
+                    snprintf(cell, sizeof(cell), "role %u sample %u event %u expired 0x%x", role, sample, event,
+                             expired);
+                    TEST_ASSERT_EQUAL_MESSAGE(old_step.result, table_step.result, cell);
+                    TEST_ASSERT_EQUAL_MESSAGE(old_step.event, table_step.event, cell);
+                    TEST_ASSERT_EQUAL_MESSAGE(old_step.action, table_step.action, cell);
+                }
+            }
+        }
+    }
+}
+
+void test_table_matches_the_old_branches()
+{
+    testAllCells(false);
+}
+
+void test_t9_table_matches_the_old_branches()
+{
+    testAllCells(true);
+}
+
+void test_rules_wait_for_one_timer()
+{
+    // A held T9 key moves to its next character after the T9 duration and waits before it.
+    uint16_t rule = rkpTransition(rkpRules(true), RKP_ROLE_NORMAL, RKP_SAMPLE_HELD, RKP_WAIT);
+    TEST_ASSERT_EQUAL(RKP_TIMER_T9, rkpRuleTimer(rule));
+    TEST_ASSERT_EQUAL(RKP_T9_NEXT_CHAR, rkpRuleEvent(rule));
+    TEST_ASSERT_EQUAL(RKP_NO_EVENT, rkpRuleOtherwise(rule));
+    TEST_ASSERT_EQUAL(RKP_ACTION_NEXT_CHAR, rkpRuleAction(rule));
+
+    // A released key outside RKP_T9 mode is a long press or a key up.
+    rule = rkpTransition(rkpRules(false), RKP_ROLE_NORMAL, RKP_SAMPLE_RELEASE, RKP_WAIT);
+    TEST_ASSERT_EQUAL(RKP_TIMER_LONG_PRESS, rkpRuleTimer(rule));
+    TEST_ASSERT_EQUAL(RKP_LONG_PRESS, rkpRuleEvent(rule));
+    TEST_ASSERT_EQUAL(RKP_KEY_UP, rkpRuleOtherwise(rule));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_table_matches_the_old_branches);
+    RUN_TEST(test_t9_table_matches_the_old_branches);
+    RUN_TEST(test_rules_wait_for_one_timer);
+    return UNITY_END();
+}
@@ -0,0 +1,113 @@
+#include <unity.h>
+#include <rusty_test_keypad.h>
+
+#if !defined(RUSTY_KEYPAD_LATENCY)
+#error "test_latency needs -DRUSTY_KEYPAD_LATENCY, see the native environment of platformio.example"
+#endif
+
+/*
+ * The host clock counts whole milliseconds, so every latency is a multiple
+ * of 1000 us: the time from the first scan that saw the edge until the scan
+ * that delivered the event.
+ */
+
+void setUp()
+{
+    testKeypadSetup(RKP_INTEGER);
+    RustyLatency::reset();
+}
+
+void tearDown()
+{
+}
+
+/*
+ * Sets the keypad up, waits `idle` ms, then taps '5' while scanning every
+ * `step` ms. Right after the setup the key filter holds the press back; the
+ * histograms are kept.
+ */
+static void testTapAfter(unsigned long idle, unsigned long step = 1)
+{
+    testKeypadSetup(RKP_INTEGER);
+    testRun(idle, step);
+    testSetKey('5', true);
+    testRun(100, step);
+    testSetKey('5', false);
+    testRun(200, step);
+}
+
+void test_bucket_limits_double()
+{
+    TEST_ASSERT_EQUAL(2, RustyLatency::getBucketLimit(0));
+    TEST_ASSERT_EQUAL(32768, RustyLatency::getBucketLimit(14));
+    TEST_ASSERT_EQUAL(0x80000000UL, RustyLatency::getBucketLimit(30));
+    TEST_ASSERT_EQUAL(0xFFFFFFFFUL, RustyLatency::getBucketLimit(31));
+}
+
+void test_key_down_waits_for_the_filter()
+{
+    testTapAfter(0);
+    TEST_ASSERT_EQUAL(1, RustyLatency::getTotal(RKP_KEY_DOWN));
+    TEST_ASSERT_EQUAL(1, RustyLatency::getCount(RKP_KEY_DOWN, 14));
+    TEST_ASSERT_EQUAL(RUSTY_KEYPAD_KEY_FILTER_MILLIS * 1000UL, RustyLatency::getMax(RKP_KEY_DOWN));
+    // The release comes after the filter time, it is delivered by the scan that sees it.
+    TEST_ASSERT_EQUAL(1, RustyLatency::getCount(RKP_KEY_UP, 0));
+    TEST_ASSERT_EQUAL(0, RustyLatency::getMax(RKP_KEY_UP));
+}
+
+void test_settled_key_is_delivered_by_the_scan_that_sees_it()
+{
+    testTapAfter(100);
+    TEST_ASSERT_EQUAL(1, RustyLatency::getCount(RKP_KEY_DOWN, 0));
+    TEST_ASSERT_EQUAL(0, RustyLatency::getMax(RKP_KEY_DOWN));
+}
+
+void test_percentile_is_the_limit_of_its_bucket()
+{
+    testTapAfter(100);
+    for (uint8_t i = 0; i < 9; i++)
+    {
+        testTapAfter(0);
+    }
+    TEST_ASSERT_EQUAL(10, RustyLatency::getTotal(RKP_KEY_DOWN));
+    TEST_ASSERT_EQUAL(2, RustyLatency::getPercentile(RKP_KEY_DOWN, 10));
+    // The limit of bucket 14 is 32768 us, the longest latency seen is less.
+    TEST_ASSERT_EQUAL(20000, RustyLatency::getPercentile(RKP_KEY_DOWN, 11));
+    TEST_ASSERT_EQUAL(20000, RustyLatency::getPercentile(RKP_KEY_DOWN, 100));
+    TEST_ASSERT_EQUAL(20000, RustyLatency::getPercentile(RKP_KEY_DOWN, 200));
+}
+
+void test_last_bucket_counts_everything_above()
+{
+    testSetKey('5', true);
+    RustyKeypad::scan();
+    delay(3000);
+    RustyKeypad::scan();
+    TEST_ASSERT_EQUAL(1, RustyLatency::getCount(RKP_KEY_DOWN, RUSTY_KEYPAD_LATENCY_BUCKETS - 1));
+    TEST_ASSERT_EQUAL(3000000, RustyLatency::getMax(RKP_KEY_DOWN));
+    TEST_ASSERT_EQUAL(3000000, RustyLatency::getPercentile(RKP_KEY_DOWN, 50));
+}
+
+void test_empty_and_unknown_histograms_read_zero()
+{
+    TEST_ASSERT_EQUAL(0, RustyLatency::getPercentile(RKP_KEY_DOWN, 50));
+    testTapAfter(0);
+    TEST_ASSERT_EQUAL(0, RustyLatency::getCount(RKP_KEY_DOWN, RUSTY_KEYPAD_LATENCY_BUCKETS));
+    TEST_ASSERT_EQUAL(0, RustyLatency::getTotal(RKP_KEY_IDLE));
+    TEST_ASSERT_EQUAL(0, RustyLatency::getMax((KeypadEventTypes)RUSTY_KEYPAD_LATENCY_EVENTS));
+    RustyLatency::reset();
+    TEST_ASSERT_EQUAL(0, RustyLatency::getTotal(RKP_KEY_DOWN));
+    TEST_ASSERT_EQUAL(0, RustyLatency::getMax(RKP_KEY_DOWN));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_bucket_limits_double);
+    RUN_TEST(test_key_down_waits_for_the_filter);
+    RUN_TEST(test_settled_key_is_delivered_by_the_scan_that_sees_it);
+    RUN_TEST(test_percentile_is_the_limit_of_its_bucket);
+    RUN_TEST(test_last_bucket_counts_everything_above);
+    RUN_TEST(test_empty_and_unknown_histograms_read_zero);
+    return UNITY_END();
+}
@@ -0,0 +1,121 @@
+#include <unity.h>
+#include <rusty_test_keypad.h>
+#include <limits.h>
+
+void setUp()
+{
+    testKeypadSetup(RKP_INTEGER);
+}
+
+void tearDown()
+{
+    RustyKeypad::setFloatChar('*');
+}
+
+static void testDelete(uint8_t count)
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        testTap('*', 800);
+    }
+}
+
+void test_integer_is_accumulated_while_typed()
+{
+    testType("1250");
+    TEST_ASSERT_EQUAL(1250, RustyKeypad::getIntegerValue());
+    testDelete(1);
+    TEST_ASSERT_EQUAL(125, RustyKeypad::getIntegerValue());
+}
+
+void test_other_keys_are_kept_in_the_text_but_skipped()
+{
+    testType("12#3");
+    TEST_ASSERT_EQUAL_STRING("12#3", testText().c_str());
+    TEST_ASSERT_EQUAL(123, RustyKeypad::getIntegerValue());
+    testDelete(2);
+    TEST_ASSERT_EQUAL_STRING("12", testText().c_str());
+    TEST_ASSERT_EQUAL(12, RustyKeypad::getIntegerValue());
+}
+
+void test_float_key_types_the_separator()
+{
+    testKeypadSetup(RKP_FLOAT);
+    testType("12*345");
+    TEST_ASSERT_EQUAL_STRING("12.345", testText().c_str());
+    TEST_ASSERT_EQUAL(12, RustyKeypad::getIntegerValue());
+    TEST_ASSERT_EQUAL(1234, RustyKeypad::getFixedValue(2));
+    TEST_ASSERT_EQUAL(1234500, RustyKeypad::getFixedValue(5));
+    testDelete(4);
+    TEST_ASSERT_EQUAL_STRING("12", testText().c_str());
+    TEST_ASSERT_EQUAL(1200, RustyKeypad::getFixedValue(2));
+}
+
+void test_second_separator_is_skipped()
+{
+    testKeypadSetup(RKP_FLOAT);
+    testType("1*2*3");
+    TEST_ASSERT_EQUAL_STRING("1.2.3", testText().c_str());
+    TEST_ASSERT_EQUAL(123, RustyKeypad::getFixedValue(2));
+    testDelete(2);
+    TEST_ASSERT_EQUAL(120, RustyKeypad::getFixedValue(2));
+}
+
+void test_tenth_decimal_is_cut_off_not_an_overflow()
+{
+    testKeypadSetup(RKP_FLOAT);
+    testType("0*1234567891");
+    TEST_ASSERT_FALSE(RustyKeypad::isNumberOverflow());
+    TEST_ASSERT_EQUAL(123456789, RustyKeypad::getFixedValue(9));
+    testDelete(1);
+    TEST_ASSERT_EQUAL(123456789, RustyKeypad::getFixedValue(9));
+    testDelete(1);
+    TEST_ASSERT_EQUAL(123456780, RustyKeypad::getFixedValue(9));
+}
+
+void test_decimals_that_no_longer_fit_are_cut_off()
+{
+    testKeypadSetup(RKP_FLOAT);
+    char text[32];
+    snprintf(text, sizeof(text), "%ld*78", LONG_MAX / 10);
+    testType(text);
+    TEST_ASSERT_FALSE(RustyKeypad::isNumberOverflow());
+    TEST_ASSERT_EQUAL(LONG_MAX / 10, RustyKeypad::getIntegerValue());
+    TEST_ASSERT_EQUAL(LONG_MAX, RustyKeypad::getFixedValue(1));
+}
+
+void test_integer_part_that_doesnt_fit_overflows()
+{
+    char text[32];
+    snprintf(text, sizeof(text), "%ld0", LONG_MAX);
+    testType(text);
+    TEST_ASSERT_TRUE(RustyKeypad::isNumberOverflow());
+    TEST_ASSERT_EQUAL(LONG_MAX, RustyKeypad::getIntegerValue());
+    testDelete(1);
+    TEST_ASSERT_FALSE(RustyKeypad::isNumberOverflow());
+    TEST_ASSERT_EQUAL(LONG_MAX, RustyKeypad::getIntegerValue());
+}
+
+void test_float_key_cannot_be_the_enter_key()
+{
+    RustyKeypad::setEnterKey('0');
+    TEST_ASSERT_FALSE(RustyKeypad::setFloatChar('0'));
+    TEST_ASSERT_TRUE(RustyKeypad::setFloatChar('9'));
+    RustyKeypad::setType(RKP_FLOAT);
+    testType("19");
+    TEST_ASSERT_EQUAL_STRING("1.", testText().c_str());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_integer_is_accumulated_while_typed);
+    RUN_TEST(test_other_keys_are_kept_in_the_text_but_skipped);
+    RUN_TEST(test_float_key_types_the_separator);
+    RUN_TEST(test_second_separator_is_skipped);
+    RUN_TEST(test_tenth_decimal_is_cut_off_not_an_overflow);
+    RUN_TEST(test_decimals_that_no_longer_fit_are_cut_off);
+    RUN_TEST(test_integer_part_that_doesnt_fit_overflows);
+    RUN_TEST(test_float_key_cannot_be_the_enter_key);
+    return UNITY_END();
+}
@@ -0,0 +1,73 @@
+#include <unity.h>
+#include <rusty_test_keypad.h>
+
+void setUp()
+{
+    testKeypadSetup(RKP_INTEGER);
+    RustyKeypad::setPasswordMask(true);
+    RustyKeypad::setPasswordReveal(0);
+}
+
+void tearDown()
+{
+}
+
+void test_text_change_sends_the_mask()
+{
+    testType("12");
+    TEST_ASSERT_EQUAL_STRING("down 1;up 1;text *;down 2;up 2;text **;", test_log.c_str());
+    TEST_ASSERT_EQUAL_STRING("**", testText().c_str());
+    TEST_ASSERT_EQUAL_STRING("**", RustyKeypad::getPasswordMask());
+}
+
+void test_enter_sends_the_mask()
+{
+    RustyKeypad::setEnterKey('#');
+    testType("123");
+    test_log.clear();
+    testTap('#', 800);
+    TEST_ASSERT_EQUAL_STRING("down #;enter ***;text ;", test_log.c_str());
+}
+
+void test_reveal_shows_the_last_character()
+{
+    RustyKeypad::setPasswordReveal(300);
+    testType("12");
+    TEST_ASSERT_EQUAL_STRING("down 1;up 1;text 1;down 2;up 2;text *2;", test_log.c_str());
+    test_log.clear();
+    testRun(400);
+    TEST_ASSERT_EQUAL_STRING("text **;", test_log.c_str());
+}
+
+void test_t9_preview_is_masked()
+{
+    testKeypadSetup(RKP_T9);
+    RustyKeypad::setPasswordMask(true);
+    testType("1");
+    testRun(1000);
+    test_log.clear();
+    testSetKey('2', true);
+    testRun(100);
+    TEST_ASSERT_EQUAL_STRING("text *2;down 2;", test_log.c_str());
+    testSetKey('2', false);
+    testRun(1000);
+    TEST_ASSERT_EQUAL_STRING("**", testText().c_str());
+}
+
+void test_text_is_plain_without_the_mask()
+{
+    RustyKeypad::setPasswordMask(false);
+    testType("12");
+    TEST_ASSERT_EQUAL_STRING("down 1;up 1;text 1;down 2;up 2;text 12;", test_log.c_str());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_text_change_sends_the_mask);
+    RUN_TEST(test_enter_sends_the_mask);
+    RUN_TEST(test_reveal_shows_the_last_character);
+    RUN_TEST(test_t9_preview_is_masked);
+    RUN_TEST(test_text_is_plain_without_the_mask);
+    return UNITY_END();
+}
@@ -0,0 +1,237 @@
+#include <unity.h>
+#include <rusty_test_keypad.h>
+#include <rusty_recorder.h>
+#include <rusty_replay.h>
+
+/*
+ * Collects the recording.
+ */
+struct TestPrint : public Print
+{
+    std::string bytes;
+    size_t write(uint8_t b) override
+    {
+        bytes += (char)b;
+        return 1;
+    }
+    using Print::write;
+};
+
+static TestPrint recording;
+
+static const uint8_t *recordingData()
+{
+    return (const uint8_t *)recording.bytes.data();
+}
+
+/*
+ * Writes the entries after the header as hex bytes.
+ */
+static std::string entryBytes()
+{
+    std::string hex;
+    char byte[4];
+    for (size_t i = RUSTY_KEYPAD_RECORDING_HEADER_SIZE; i < recording.bytes.size(); i++)
+    {
+        snprintf(byte, sizeof(byte), "%02x ", (uint8_t)recording.bytes[i]);
+        hex += byte;
+    }
+    return hex;
+}
+
+/*
+ * Writes the four rows of a sample as hex bytes, each row in `sizeof(RustyRowBits)` bytes, lowest first.
+ */
+static std::string sampleBytes(RustyRowBits r0, RustyRowBits r1, RustyRowBits r2, RustyRowBits r3)
+{
+    const RustyRowBits rows[4] = {r0, r1, r2, r3};
+    std::string hex;
+    char byte[4];
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        for (uint8_t b = 0; b < sizeof(RustyRowBits); b++)
+        {
+            snprintf(byte, sizeof(byte), "%02x ", (uint8_t)(rows[i] >> (8 * b)));
+            hex += byte;
+        }
+    }
+    return hex;
+}
+
+/*
+ * Replays the recording into a keypad set up like the recorded one and
+ * returns the number of scans.
+ */
+static uint32_t replayAll(KeypadTypes type)
+{
+    testKeypadSetup(type);
+    if (!RustyReplay::begin(recordingData(), recording.bytes.size()))
+    {
+        return 0;
+    }
+    setClock(RustyReplay::getTime());
+    uint32_t scans = 0;
+    while (RustyReplay::next())
+    {
+        setClock(RustyReplay::getTime());
+        RustyKeypad::scan();
+        scans++;
+    }
+    return scans;
+}
+
+void setUp()
+{
+    testKeypadSetup(RKP_INTEGER);
+    recording.bytes.clear();
+}
+
+void tearDown()
+{
+    RustyRecorder::stop();
+    RustyReplay::end();
+}
+
+void test_header_describes_the_keypad()
+{
+    setClock(0x01020304);
+    RustyRecorder::start(recording);
+    TEST_ASSERT_TRUE(RustyRecorder::isRecording());
+    TEST_ASSERT_EQUAL(RUSTY_KEYPAD_RECORDING_HEADER_SIZE, recording.bytes.size());
+    TEST_ASSERT_EQUAL_STRING("RKR", recording.bytes.substr(0, 3).c_str());
+    TEST_ASSERT_EQUAL(RUSTY_KEYPAD_RECORDING_VERSION, recordingData()[3]);
+    TEST_ASSERT_EQUAL(4, recordingData()[4]);
+    TEST_ASSERT_EQUAL(3, recordingData()[5]);
+    TEST_ASSERT_EQUAL(sizeof(RustyRowBits), recordingData()[6]);
+    TEST_ASSERT_EQUAL_HEX8(0x04, recordingData()[7]);
+    TEST_ASSERT_EQUAL_HEX8(0x03, recordingData()[8]);
+    TEST_ASSERT_EQUAL_HEX8(0x02, recordingData()[9]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, recordingData()[10]);
+    RustyRecorder::stop();
+    TEST_ASSERT_FALSE(RustyRecorder::isRecording());
+    TEST_ASSERT_EQUAL(RUSTY_KEYPAD_RECORDING_HEADER_SIZE, recording.bytes.size());
+}
+
+void test_equal_scans_share_one_entry()
+{
+    RustyRecorder::start(recording);
+    testRun(20);
+    // An entry is written when the next one starts, the last one when the recording stops.
+    TEST_ASSERT_EQUAL_STRING("", entryBytes().c_str());
+    testSetKey('5', true);
+    testRun(5);
+    TEST_ASSERT_EQUAL_STRING("08 05 ", entryBytes().c_str());
+    testSetKey('5', false);
+    testRun(10);
+    RustyRecorder::stop();
+    TEST_ASSERT_EQUAL(7, RustyRecorder::getScanCount());
+    // 4 released scans, '5' in row 1 for one scan, then 2 released scans sharing the new sample.
+    std::string expected = "08 05 03 05 " + sampleBytes(0, 2, 0, 0) + "05 05 " + sampleBytes(0, 0, 0, 0);
+    TEST_ASSERT_EQUAL_STRING(expected.c_str(), entryBytes().c_str());
+}
+
+void test_flush_writes_the_current_entry()
+{
+    RustyRecorder::start(recording);
+    testRun(10);
+    RustyRecorder::flush();
+    TEST_ASSERT_EQUAL_STRING("04 05 ", entryBytes().c_str());
+    testRun(5);
+    RustyRecorder::stop();
+    TEST_ASSERT_EQUAL_STRING("04 05 02 05 ", entryBytes().c_str());
+}
+
+void test_long_run_takes_a_two_byte_varint()
+{
+    RustyRecorder::start(recording);
+    testRun(1000);
+    RustyRecorder::stop();
+    TEST_ASSERT_EQUAL(200, RustyRecorder::getScanCount());
+    // 200 << 1 = 400 = 0x10 | 0x03 << 7.
+    TEST_ASSERT_EQUAL_STRING("90 03 05 ", entryBytes().c_str());
+}
+
+void test_replay_repeats_the_recorded_session()
+{
+    testKeypadSetup(RKP_T9);
+    RustyRecorder::start(recording);
+    testType("22");
+    testTap('5');
+    testTap('*', 800);
+    testTap('7', 2000);
+    testRun(1000, 7);
+    RustyRecorder::stop();
+    std::string recorded_log = test_log;
+    std::string recorded_text = testText();
+    unsigned long recorded_end = millis();
+    uint32_t recorded_scans = RustyRecorder::getScanCount();
+
+    // The pins are ignored while the replay provides the samples.
+    testSetKey('1', true);
+    TEST_ASSERT_EQUAL(recorded_scans, replayAll(RKP_T9));
+    testSetKey('1', false);
+    TEST_ASSERT_EQUAL_STRING(recorded_log.c_str(), test_log.c_str());
+    TEST_ASSERT_EQUAL_STRING(recorded_text.c_str(), testText().c_str());
+    TEST_ASSERT_EQUAL(recorded_end, millis());
+    TEST_ASSERT_EQUAL(recorded_scans, RustyReplay::getScanCount());
+    TEST_ASSERT_EQUAL(4, RustyReplay::getRowCount());
+    TEST_ASSERT_EQUAL(3, RustyReplay::getColCount());
+    TEST_ASSERT_FALSE(RustyReplay::isReplaying());
+}
+
+void test_bad_header_is_rejected()
+{
+    RustyRecorder::start(recording);
+    testRun(10);
+    RustyRecorder::stop();
+    const std::string good = recording.bytes;
+    TEST_ASSERT_TRUE(RustyReplay::begin(recordingData(), recording.bytes.size()));
+    RustyReplay::end();
+
+    const size_t offsets[] = {0, 3, 6, 6};
+    const uint8_t values[] = {'X', RUSTY_KEYPAD_RECORDING_VERSION + 1, 0, 5};
+    for (uint8_t i = 0; i < sizeof(offsets) / sizeof(offsets[0]); i++)
+    {
+        recording.bytes = good;
+        recording.bytes[offsets[i]] = (char)values[i];
+        TEST_ASSERT_FALSE(RustyReplay::begin(recordingData(), recording.bytes.size()));
+        TEST_ASSERT_FALSE(RustyReplay::isReplaying());
+    }
+    recording.bytes = good;
+    TEST_ASSERT_FALSE(RustyReplay::begin(recordingData(), RUSTY_KEYPAD_RECORDING_HEADER_SIZE - 1));
+    TEST_ASSERT_FALSE(RustyReplay::next());
+}
+
+void test_truncated_recording_ends_the_replay()
+{
+    RustyRecorder::start(recording);
+    testRun(20);
+    testSetKey('5', true);
+    testRun(5);
+    testSetKey('5', false);
+    RustyRecorder::stop();
+    // Cut the last row of the sample of the second entry.
+    recording.bytes.resize(recording.bytes.size() - 1);
+    TEST_ASSERT_TRUE(RustyReplay::begin(recordingData(), recording.bytes.size()));
+    TEST_ASSERT_TRUE(RustyReplay::isReplaying());
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        TEST_ASSERT_TRUE(RustyReplay::next());
+    }
+    TEST_ASSERT_FALSE(RustyReplay::next());
+    TEST_ASSERT_EQUAL(4, RustyReplay::getScanCount());
+    TEST_ASSERT_FALSE(RustyReplay::isReplaying());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_header_describes_the_keypad);
+    RUN_TEST(test_equal_scans_share_one_entry);
+    RUN_TEST(test_flush_writes_the_current_entry);
+    RUN_TEST(test_long_run_takes_a_two_byte_varint);
+    RUN_TEST(test_replay_repeats_the_recorded_session);
+    RUN_TEST(test_bad_header_is_rejected);
+    RUN_TEST(test_truncated_recording_ends_the_replay);
+    return UNITY_END();
+}
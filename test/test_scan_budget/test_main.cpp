@@ -0,0 +1,186 @@
+#include <unity.h>
+#include <rusty_test_keypad.h>
+
+static unsigned long pin_reads;
+
+static int countingDigitalRead(uint8_t pin)
+{
+    pin_reads++;
+    return testDigitalRead(pin);
+}
+
+struct TestStep
+{
+    unsigned long time;
+    char key;
+    bool pressed;
+};
+
+/*
+ * A T9 session: "2" tapped twice, "5" once, the delete key held, "7" held
+ * through its long press, and a quiet end.
+ */
+static const TestStep session[] = {
+    {2000, '2', true}, {2100, '2', false}, {2300, '2', true}, {2400, '2', false},
+    {5000, '5', true}, {5100, '5', false}, {9000, '*', true}, {9700, '*', false},
+    {20000, '7', true}, {26000, '7', false}, {40000, '7', false}};
+
+/*
+ * Plays the session from 1000 ms and returns the number of scans. A dense loop
+ * scans every 5 ms; otherwise the loop sleeps as long as getSleepDuration()
+ * allows, arming the rows when nothing is pending, and wakes early for the
+ * next step of the session as a pin change interrupt would.
+ */
+static unsigned long playSession(bool dense)
+{
+    const uint8_t count = sizeof(session) / sizeof(session[0]);
+    unsigned long scans = 0;
+    uint8_t next = 0;
+    while (next < count)
+    {
+        for (; next < count && session[next].time <= millis(); next++)
+        {
+            testSetKey(session[next].key, session[next].pressed);
+        }
+        RustyKeypad::scan();
+        scans++;
+        unsigned long step = 5;
+        if (!dense)
+        {
+            unsigned long budget = RustyKeypad::getSleepDuration();
+            if (budget == RKP_SLEEP_FOREVER)
+            {
+                RustyKeypad::armWakeup();
+            }
+            unsigned long until = (next < count ? session[next].time - millis() : 1);
+            step = (budget < until ? budget : until);
+            step = (step == 0 ? 1 : step);
+        }
+        delay(step);
+    }
+    return scans;
+}
+
+void setUp()
+{
+    testKeypadSetup(RKP_T9);
+    pin_reads = 0;
+}
+
+void tearDown()
+{
+    RustyKeypad::setIdleTimeout(30000);
+}
+
+void test_sleeping_loop_reports_the_same_events()
+{
+    unsigned long dense_scans = playSession(true);
+    std::string dense_log = test_log;
+
+    testKeypadSetup(RKP_T9);
+    unsigned long sleeping_scans = playSession(false);
+
+    TEST_ASSERT_EQUAL_STRING(dense_log.c_str(), test_log.c_str());
+    TEST_ASSERT_EQUAL(7801, dense_scans);
+    TEST_ASSERT_EQUAL(398, sleeping_scans);
+    TEST_ASSERT_FALSE(RustyKeypad::isAnyKeyPressed());
+}
+
+void test_sleep_budget_follows_the_pending_work()
+{
+    testSetKey('5', true);
+    testRun(50);
+    TEST_ASSERT_LESS_OR_EQUAL(RUSTY_KEYPAD_KEY_FILTER_MILLIS, RustyKeypad::getSleepDuration());
+    testSetKey('5', false);
+    testRun(5);
+    TEST_ASSERT_TRUE(RustyKeypad::hasPendingDeadline());
+    TEST_ASSERT_EQUAL(RustyKeypad::getNextDeadline() - millis(), RustyKeypad::getSleepDuration());
+    testRun(100);
+    TEST_ASSERT_FALSE(RustyKeypad::hasPendingDeadline());
+    TEST_ASSERT_UINT_WITHIN(100, 30000, RustyKeypad::getSleepDuration());
+    RustyKeypad::setIdleTimeout(0);
+    TEST_ASSERT_EQUAL(RKP_SLEEP_FOREVER, RustyKeypad::getSleepDuration());
+}
+
+void test_armed_rows_let_a_press_pull_a_column()
+{
+    RustyKeypad::setIdleTimeout(0);
+    testRun(2000);
+    RustyKeypad::armWakeup();
+    TEST_ASSERT_EQUAL(HIGH, digitalRead(test_col_pins[1]));
+    testSetKey('8', true);
+    TEST_ASSERT_EQUAL(LOW, digitalRead(test_col_pins[1]));
+    TEST_ASSERT_EQUAL(HIGH, digitalRead(test_col_pins[0]));
+    delay(5);
+    RustyKeypad::scan();
+    TEST_ASSERT_EQUAL_STRING("text 8;", test_log.c_str());
+}
+
+void test_idle_keypad_skips_scans()
+{
+    RustyKeypad::setIdleTimeout(1000);
+    setDigitalSource(countingDigitalRead);
+    unsigned long calls = 0;
+    unsigned long sampled = 0;
+    for (unsigned long start = millis(); millis() - start < 1000;)
+    {
+        unsigned long reads = pin_reads;
+        delay(1);
+        RustyKeypad::scan();
+        calls++;
+        sampled += (pin_reads != reads);
+    }
+    TEST_ASSERT_FALSE(RustyKeypad::isIdle());
+    TEST_ASSERT_EQUAL(calls, sampled);
+
+    // Idle after 1001 ms: 1 s at 10 ms, 1 s at 20 ms, 1 s at 40 ms and 2 s at 80 ms.
+    calls = 0;
+    sampled = 0;
+    for (unsigned long start = millis(); millis() - start < 5001;)
+    {
+        unsigned long reads = pin_reads;
+        delay(1);
+        RustyKeypad::scan();
+        calls++;
+        sampled += (pin_reads != reads);
+    }
+    TEST_ASSERT_TRUE(RustyKeypad::isIdle());
+    TEST_ASSERT_EQUAL(5001, calls);
+    TEST_ASSERT_UINT_WITHIN(3, 100 + 50 + 25 + 25, sampled);
+    TEST_ASSERT_UINT_WITHIN(3, 5001 - 200, calls - sampled);
+}
+
+void test_press_during_backoff_is_seen_within_the_longest_interval()
+{
+    RustyKeypad::setIdleTimeout(1000);
+    for (unsigned long offset = 0; offset < RUSTY_KEYPAD_IDLE_SCAN_MAX_MILLIS; offset += 7)
+    {
+        testKeypadSetup(RKP_T9);
+        RustyKeypad::setIdleTimeout(1000);
+        testRun(5000 + offset, 1);
+        TEST_ASSERT_TRUE(RustyKeypad::isIdle());
+        test_log.clear();
+        testSetKey('5', true);
+        unsigned long pressed = millis();
+        while (test_log.empty() && millis() - pressed < 1000)
+        {
+            delay(1);
+            RustyKeypad::scan();
+        }
+        TEST_ASSERT_EQUAL_STRING("text 5;", test_log.c_str());
+        TEST_ASSERT_LESS_OR_EQUAL(RUSTY_KEYPAD_IDLE_SCAN_MAX_MILLIS, millis() - pressed);
+        TEST_ASSERT_FALSE(RustyKeypad::isIdle());
+        testSetKey('5', false);
+    }
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_sleeping_loop_reports_the_same_events);
+    RUN_TEST(test_sleep_budget_follows_the_pending_work);
+    RUN_TEST(test_armed_rows_let_a_press_pull_a_column);
+    RUN_TEST(test_idle_keypad_skips_scans);
+    RUN_TEST(test_press_during_backoff_is_seen_within_the_longest_interval);
+    return UNITY_END();
+}
@@ -0,0 +1,120 @@
+#include <unity.h>
+#include <rusty_test_keypad.h>
+#include <rusty_scan_task.h>
+#include <thread>
+#include <chrono>
+
+/*
+ * The scan thread and the test share the keypad, the virtual clock and the
+ * simulated pins, so the test only touches them between lock() and unlock().
+ * Build with -fsanitize=thread (pio test -e native_tsan) to have the data
+ * races reported.
+ */
+
+static std::thread::id test_thread;
+static bool foreign_listener_call;
+
+static void testOnThreadText(RustyText text)
+{
+    foreign_listener_call |= (std::this_thread::get_id() != test_thread);
+    testOnText(text);
+}
+
+void setUp()
+{
+    testKeypadSetup(RKP_INTEGER);
+    RustyKeypad::addTextChangeListener(testOnThreadText);
+    test_thread = std::this_thread::get_id();
+    foreign_listener_call = false;
+}
+
+void tearDown()
+{
+    RustyScanTask::stop();
+    RustyScanTask::dispatch();
+}
+
+/*
+ * Holds a key or releases it for `steps` rounds of 20 ms of virtual time while
+ * the thread scans, and queries the keypad in every round.
+ */
+static void testHoldAndQuery(bool pressed, uint8_t steps, char key = '5')
+{
+    for (uint8_t i = 0; i < steps; i++)
+    {
+        RustyScanTask::lock();
+        testSetKey(key, pressed);
+        delay(20);
+        RustyKeypad::isKeyPressed(key);
+        RustyKeypad::isAnyKeyPressed();
+        RustyKeypad::getIntegerValue();
+        testText();
+        RustyScanTask::unlock();
+        RustyScanTask::dispatch();
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+}
+
+void test_start_is_refused_while_running()
+{
+    TEST_ASSERT_TRUE(RustyScanTask::start(1));
+    TEST_ASSERT_TRUE(RustyScanTask::isRunning());
+    TEST_ASSERT_FALSE(RustyScanTask::start(1));
+    RustyScanTask::stop();
+    TEST_ASSERT_FALSE(RustyScanTask::isRunning());
+}
+
+void test_start_and_stop_while_the_keypad_is_queried()
+{
+    for (uint8_t round = 0; round < 10; round++)
+    {
+        TEST_ASSERT_TRUE(RustyScanTask::start(1));
+        testHoldAndQuery(true, 5);
+        testHoldAndQuery(false, 5);
+        RustyScanTask::stop();
+        TEST_ASSERT_FALSE(RustyScanTask::isRunning());
+        RustyScanTask::dispatch();
+    }
+    TEST_ASSERT_EQUAL_STRING("5555555555", testText().c_str());
+    TEST_ASSERT_EQUAL(0, RustyScanTask::getDroppedNotifications());
+}
+
+void test_listeners_run_in_the_dispatching_thread()
+{
+    TEST_ASSERT_TRUE(RustyScanTask::start(1));
+    testHoldAndQuery(true, 5);
+    testHoldAndQuery(false, 5);
+    RustyScanTask::stop();
+    RustyScanTask::dispatch();
+    TEST_ASSERT_EQUAL_STRING("down 5;up 5;text 5;", test_log.c_str());
+    TEST_ASSERT_FALSE(foreign_listener_call);
+}
+
+void test_queued_text_keeps_the_preview_of_a_full_text()
+{
+    RustyKeypad::setType(RKP_T9);
+    RustyKeypad::setMaxTextLength(RUSTY_KEYPAD_MAX_TEXT_LENGTH);
+    std::string full(RUSTY_KEYPAD_MAX_TEXT_LENGTH, '1');
+    for (uint8_t i = 0; i < RUSTY_KEYPAD_MAX_TEXT_LENGTH; i++)
+    {
+        testTap('1', 100, 700);
+    }
+    TEST_ASSERT_EQUAL_STRING(full.c_str(), testText().c_str());
+    test_log.clear();
+    TEST_ASSERT_TRUE(RustyScanTask::start(1));
+    testHoldAndQuery(true, 5, '2');
+    RustyScanTask::stop();
+    RustyScanTask::dispatch();
+    RustyKeypad::setMaxTextLength(20);
+    TEST_ASSERT_EQUAL_STRING(("text " + full + "2;down 2;").c_str(), test_log.c_str());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_start_is_refused_while_running);
+    RUN_TEST(test_start_and_stop_while_the_keypad_is_queried);
+    RUN_TEST(test_listeners_run_in_the_dispatching_thread);
+    RUN_TEST(test_queued_text_keeps_the_preview_of_a_full_text);
+    return UNITY_END();
+}
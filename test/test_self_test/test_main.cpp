@@ -0,0 +1,75 @@
+#include <unity.h>
+#include <rusty_test_keypad.h>
+#include <rusty_self_test.h>
+
+static bool driven_against_row;
+static bool column_driven;
+
+/*
+ * Reads the pins like the test keypad, and notes a column driven while a
+ * row is driven too.
+ */
+static int watchingDigitalRead(uint8_t pin)
+{
+    for (uint8_t c = 0; c < 3; c++)
+    {
+        if (getPinMode(test_col_pins[c]) != OUTPUT)
+        {
+            continue;
+        }
+        column_driven = true;
+        for (uint8_t r = 0; r < 4; r++)
+        {
+            driven_against_row |= (getPinMode(test_row_pins[r]) == OUTPUT);
+        }
+    }
+    return testDigitalRead(pin);
+}
+
+void setUp()
+{
+    testKeypadSetup(RKP_INTEGER);
+    setDigitalSource(watchingDigitalRead);
+    driven_against_row = false;
+    column_driven = false;
+}
+
+void tearDown()
+{
+    RustySelfTest::end();
+}
+
+void test_rows_are_released_while_a_column_is_driven()
+{
+    RustySelfTest::begin(10);
+    testRun(1000);
+    TEST_ASSERT_GREATER_THAN(0, RustySelfTest::getRoundCount());
+    TEST_ASSERT_TRUE(column_driven);
+    TEST_ASSERT_FALSE(driven_against_row);
+    TEST_ASSERT_EQUAL(0, RustySelfTest::getFaultCount());
+}
+
+void test_rows_are_driven_high_after_the_test()
+{
+    RustySelfTest::begin(10);
+    testRun(1000);
+    for (uint8_t r = 0; r < 4; r++)
+    {
+        TEST_ASSERT_EQUAL(OUTPUT, getPinMode(test_row_pins[r]));
+        TEST_ASSERT_EQUAL(HIGH, getPinLevel(test_row_pins[r]));
+    }
+    for (uint8_t c = 0; c < 3; c++)
+    {
+        TEST_ASSERT_EQUAL(INPUT_PULLUP, getPinMode(test_col_pins[c]));
+    }
+    testType("58");
+    TEST_ASSERT_EQUAL_STRING("58", testText().c_str());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_rows_are_released_while_a_column_is_driven);
+    RUN_TEST(test_rows_are_driven_high_after_the_test);
+    return UNITY_END();
+}
@@ -0,0 +1,116 @@
+#include <unity.h>
+#include <rusty_test_keypad.h>
+
+static std::string bufferText(const RustyTextBuffer &buffer)
+{
+    char text[RUSTY_KEYPAD_MAX_TEXT_LENGTH + 1];
+    buffer.copyTo(text);
+    return std::string(text);
+}
+
+void setUp()
+{
+    testKeypadSetup(RKP_INTEGER);
+}
+
+void tearDown()
+{
+}
+
+void test_insert_and_erase_at_the_cursor()
+{
+    RustyTextBuffer buffer;
+    TEST_ASSERT_TRUE(buffer.insert('a'));
+    TEST_ASSERT_TRUE(buffer.insert('c'));
+    TEST_ASSERT_TRUE(buffer.moveLeft());
+    TEST_ASSERT_TRUE(buffer.insert('b'));
+    TEST_ASSERT_EQUAL_STRING("abc", bufferText(buffer).c_str());
+    TEST_ASSERT_EQUAL(2, buffer.cursor());
+    TEST_ASSERT_TRUE(buffer.erase());
+    TEST_ASSERT_EQUAL_STRING("ac", bufferText(buffer).c_str());
+    TEST_ASSERT_EQUAL(1, buffer.cursor());
+    TEST_ASSERT_EQUAL(2, buffer.length());
+}
+
+void test_cursor_stops_at_both_ends()
+{
+    RustyTextBuffer buffer;
+    TEST_ASSERT_FALSE(buffer.moveLeft());
+    TEST_ASSERT_FALSE(buffer.moveRight());
+    TEST_ASSERT_FALSE(buffer.erase());
+    buffer.insert('x');
+    TEST_ASSERT_FALSE(buffer.moveRight());
+    TEST_ASSERT_TRUE(buffer.moveLeft());
+    TEST_ASSERT_FALSE(buffer.moveLeft());
+    TEST_ASSERT_FALSE(buffer.erase());
+    TEST_ASSERT_EQUAL_STRING("x", bufferText(buffer).c_str());
+}
+
+void test_full_buffer_rejects_characters()
+{
+    RustyTextBuffer buffer;
+    for (uint8_t i = 0; i < RUSTY_KEYPAD_MAX_TEXT_LENGTH; i++)
+    {
+        TEST_ASSERT_TRUE(buffer.insert((char)('a' + i % 26)));
+    }
+    TEST_ASSERT_FALSE(buffer.insert('!'));
+    buffer.moveLeft();
+    TEST_ASSERT_FALSE(buffer.insert('!'));
+    TEST_ASSERT_EQUAL(RUSTY_KEYPAD_MAX_TEXT_LENGTH, buffer.length());
+}
+
+void test_char_at_and_equals_see_through_the_gap()
+{
+    RustyTextBuffer buffer;
+    buffer.insert('1');
+    buffer.insert('2');
+    buffer.insert('3');
+    buffer.moveLeft();
+    buffer.moveLeft();
+    TEST_ASSERT_EQUAL('1', buffer.charAt(0));
+    TEST_ASSERT_EQUAL('2', buffer.charAt(1));
+    TEST_ASSERT_EQUAL('3', buffer.charAt(2));
+    TEST_ASSERT_EQUAL('\0', buffer.charAt(3));
+    TEST_ASSERT_TRUE(buffer.equals("123", 3));
+    TEST_ASSERT_FALSE(buffer.equals("124", 3));
+    TEST_ASSERT_FALSE(buffer.equals("12", 2));
+    buffer.clear();
+    TEST_ASSERT_EQUAL(0, buffer.length());
+    TEST_ASSERT_TRUE(buffer.equals("", 0));
+}
+
+void test_delete_at_the_start_of_the_text_does_nothing()
+{
+    RustyKeypad::setCursorKeys('7', '9');
+    testType("123");
+    testType("777");
+    TEST_ASSERT_EQUAL(0, RustyKeypad::getCursor());
+    test_log.clear();
+    testTap('*', 800);
+    TEST_ASSERT_EQUAL_STRING("123", testText().c_str());
+    TEST_ASSERT_EQUAL(123, RustyKeypad::getIntegerValue());
+    TEST_ASSERT_EQUAL(std::string::npos, test_log.find("text"));
+}
+
+void test_delete_inside_the_text_rebuilds_the_number()
+{
+    RustyKeypad::setCursorKeys('7', '9');
+    testType("123");
+    testType("7");
+    testTap('*', 800);
+    TEST_ASSERT_EQUAL_STRING("13", testText().c_str());
+    TEST_ASSERT_EQUAL(13, RustyKeypad::getIntegerValue());
+    TEST_ASSERT_EQUAL(1, RustyKeypad::getCursor());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_insert_and_erase_at_the_cursor);
+    RUN_TEST(test_cursor_stops_at_both_ends);
+    RUN_TEST(test_full_buffer_rejects_characters);
+    RUN_TEST(test_char_at_and_equals_see_through_the_gap);
+    RUN_TEST(test_delete_at_the_start_of_the_text_does_nothing);
+    RUN_TEST(test_delete_inside_the_text_rebuilds_the_number);
+    return UNITY_END();
+}
@@ -0,0 +1,134 @@
+#include <unity.h>
+#include <rusty_test_keypad.h>
+
+#if !defined(RUSTY_KEYPAD_TRACE)
+#error "test_trace needs -DRUSTY_KEYPAD_TRACE, see the native environment of platformio.example"
+#endif
+
+/*
+ * Collects what RustyTrace::dump() writes.
+ */
+struct TestPrint : public Print
+{
+    std::string bytes;
+    size_t write(uint8_t b) override
+    {
+        bytes += (char)b;
+        return 1;
+    }
+    using Print::write;
+};
+
+static TestPrint dump_out;
+
+static uint32_t dumpNumber(size_t offset, uint8_t size)
+{
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < size; i++)
+    {
+        value |= (uint32_t)(uint8_t)dump_out.bytes[offset + i] << (8 * i);
+    }
+    return value;
+}
+
+/*
+ * Dumps the ring and writes its records as "+delta kind.code@key" words.
+ */
+static std::string dumpRecords()
+{
+    dump_out.bytes.clear();
+    RustyTrace::dump(dump_out);
+    std::string records;
+    char word[32];
+    for (size_t i = 16; i + 4 <= dump_out.bytes.size(); i += 4)
+    {
+        uint8_t type = (uint8_t)dump_out.bytes[i + 2];
+        snprintf(word, sizeof(word), "+%u %u.%u@%u ", (unsigned)dumpNumber(i, 2), type >> 4, type & 0x0F,
+                 (unsigned)(uint8_t)dump_out.bytes[i + 3]);
+        records += word;
+    }
+    return records;
+}
+
+void setUp()
+{
+    testKeypadSetup(RKP_INTEGER);
+    RustyTrace::clear();
+}
+
+void tearDown()
+{
+}
+
+void test_setup_clears_the_ring()
+{
+    RustyTrace::record(RKP_TRACE_EDGE, 1, 0);
+    RustyKeypad::keyboardSetup(test_keys, test_row_pins, test_col_pins, 4, 3);
+    TEST_ASSERT_EQUAL(0, RustyTrace::getCount());
+}
+
+void test_tap_is_traced_from_the_first_edge()
+{
+    testTap('5');
+    // Four filtered samples, the edge and key down after 20 ms, its listener, the wait event, then
+    // the release with key up, its listener, the text change and the idle event.
+    TEST_ASSERT_EQUAL_STRING("+0 3.1@4 +5 3.1@4 +5 3.1@4 +5 3.1@4 +5 2.1@4 +0 1.1@4 +0 4.1@53 +25 1.4@4 "
+                             "+55 2.0@4 +0 1.2@4 +0 4.2@53 +0 4.0@1 +25 1.0@4 ",
+                             dumpRecords().c_str());
+}
+
+void test_full_ring_keeps_the_newest_records()
+{
+    for (uint16_t i = 0; i < RUSTY_KEYPAD_TRACE_SIZE + 10; i++)
+    {
+        RustyTrace::record(RKP_TRACE_EDGE, i & 1, (uint8_t)i);
+        delay(1);
+    }
+    TEST_ASSERT_EQUAL(RUSTY_KEYPAD_TRACE_SIZE, RustyTrace::getCount());
+    TEST_ASSERT_EQUAL(10, RustyTrace::getLostCount());
+
+    std::string records = dumpRecords();
+    TEST_ASSERT_EQUAL(16 + 4 * RUSTY_KEYPAD_TRACE_SIZE, dump_out.bytes.size());
+    TEST_ASSERT_EQUAL_STRING("RKT", dump_out.bytes.substr(0, 3).c_str());
+    TEST_ASSERT_EQUAL(RUSTY_KEYPAD_TRACE_VERSION, dump_out.bytes[3]);
+    TEST_ASSERT_EQUAL(RUSTY_KEYPAD_TRACE_SIZE, dumpNumber(4, 2));
+    TEST_ASSERT_EQUAL(RUSTY_KEYPAD_TRACE_SIZE, dumpNumber(6, 2));
+    TEST_ASSERT_EQUAL(10, dumpNumber(8, 4));
+    TEST_ASSERT_EQUAL(millis() - 1, dumpNumber(12, 4));
+    TEST_ASSERT_EQUAL(0, records.find("+1 2.0@10 +1 2.1@11 "));
+    TEST_ASSERT_EQUAL(records.size() - 10, records.rfind("+1 2.1@73 "));
+}
+
+void test_long_pause_adds_a_gap_record()
+{
+    RustyTrace::record(RKP_TRACE_EDGE, 1, 4);
+    delay(70000);
+    RustyTrace::record(RKP_TRACE_EDGE, 0, 4);
+    TEST_ASSERT_EQUAL(3, RustyTrace::getCount());
+    // 70000 ms = 1 * 65536 + 4464.
+    TEST_ASSERT_EQUAL_STRING("+0 2.1@4 +1 0.0@0 +4464 2.0@4 ", dumpRecords().c_str());
+}
+
+void test_clear_empties_the_ring()
+{
+    for (uint16_t i = 0; i < RUSTY_KEYPAD_TRACE_SIZE + 1; i++)
+    {
+        RustyTrace::record(RKP_TRACE_EVENT, 1, 0);
+    }
+    RustyTrace::clear();
+    TEST_ASSERT_EQUAL(0, RustyTrace::getCount());
+    TEST_ASSERT_EQUAL(0, RustyTrace::getLostCount());
+    TEST_ASSERT_EQUAL_STRING("", dumpRecords().c_str());
+    TEST_ASSERT_EQUAL(16, dump_out.bytes.size());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_setup_clears_the_ring);
+    RUN_TEST(test_tap_is_traced_from_the_first_edge);
+    RUN_TEST(test_full_ring_keeps_the_newest_records);
+    RUN_TEST(test_long_pause_adds_a_gap_record);
+    RUN_TEST(test_clear_empties_the_ring);
+    return UNITY_END();
+}